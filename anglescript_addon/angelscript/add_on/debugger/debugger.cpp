@@ -666,6 +666,10 @@ void CDebugger::ListStatistics(asIScriptContext *ctx)
 	asUINT gcCurrSize, gcTotalDestr, gcTotalDet, gcNewObjects, gcTotalNewDestr;
 	engine->GetGCStatistics(&gcCurrSize, &gcTotalDestr, &gcTotalDet, &gcNewObjects, &gcTotalNewDestr);
 
+	asUINT gcPauses, gcMaxPause;
+	asQWORD gcTotalPause;
+	engine->GetGCPauseStatistics(&gcPauses, &gcTotalPause, &gcMaxPause);
+
 	stringstream s;
 	s << "Garbage collector:" << endl;
 	s << " current size:          " << gcCurrSize << endl;
@@ -673,6 +677,9 @@ void CDebugger::ListStatistics(asIScriptContext *ctx)
 	s << " total detected:        " << gcTotalDet << endl;
 	s << " new objects:           " << gcNewObjects << endl;
 	s << " new objects destroyed: " << gcTotalNewDestr << endl;
+	s << " pauses:                " << gcPauses << endl;
+	s << " total pause time (us): " << gcTotalPause << endl;
+	s << " max pause time (us):   " << gcMaxPause << endl;
 
 	Output(s.str());
 }
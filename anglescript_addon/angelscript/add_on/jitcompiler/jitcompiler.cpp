@@ -0,0 +1,1159 @@
+#include "jitcompiler.h"
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_X64
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+BEGIN_AS_NAMESPACE
+
+#ifdef JIT_X64
+
+// The machine code registers used by the generated code. The stack frame
+// pointer, stack pointer and VM registers are kept in callee saved registers
+// while the native code executes, the rest are scratch registers.
+enum ERegister
+{
+	RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RSI = 6, RDI = 7, R12 = 12, R13 = 13,
+	XMM0 = 0, XMM1 = 1, XMM2 = 2,
+
+	FP   = RBX,
+	SP   = R13,
+	REGS = R12
+};
+
+enum ECondition
+{
+	CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_BE = 0x6, CC_A = 0x7,
+	CC_P = 0xA, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF
+};
+
+static const int VR_OFFSET      = offsetof(asSVMRegisters, valueRegister);
+static const int PP_OFFSET      = offsetof(asSVMRegisters, programPointer);
+static const int SP_OFFSET      = offsetof(asSVMRegisters, stackPointer);
+static const int FP_OFFSET      = offsetof(asSVMRegisters, stackFramePointer);
+static const int SUSPEND_OFFSET = offsetof(asSVMRegisters, doProcessSuspend);
+
+// The size of the mapping is stored in front of the code
+static const size_t CODE_HEADER_SIZE = 16;
+
+// A minimal x86-64 instruction encoder. Memory operands are always encoded
+// as [base+disp32], and opcodes with the 0x0F escape are given as 0x0Fxx
+class CAssembler
+{
+public:
+	void Byte(asBYTE b)
+	{
+		code.push_back(b);
+	}
+
+	void Dword(asDWORD d)
+	{
+		for( int n = 0; n < 4; n++ )
+			Byte(asBYTE(d >> (n*8)));
+	}
+
+	void Qword(asQWORD q)
+	{
+		Dword(asDWORD(q));
+		Dword(asDWORD(q >> 32));
+	}
+
+	int Pos() const
+	{
+		return int(code.size());
+	}
+
+	void Mem(asBYTE prefix, bool w, int opcode, int reg, int base, int disp)
+	{
+		Prefix(prefix, w, opcode, reg, base);
+		Byte(asBYTE(0x80 | ((reg & 7) << 3) | (base & 7)));
+		if( (base & 7) == RSP )
+			Byte(0x24);
+		Dword(asDWORD(disp));
+	}
+
+	void Reg(asBYTE prefix, bool w, int opcode, int reg, int rm)
+	{
+		Prefix(prefix, w, opcode, reg, rm);
+		Byte(asBYTE(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+	}
+
+	void MovImm64(int reg, asQWORD value)
+	{
+		Byte(asBYTE(0x48 | ((reg & 8) ? 1 : 0)));
+		Byte(asBYTE(0xB8 | (reg & 7)));
+		Qword(value);
+	}
+
+	// Jumps return the position of the displacement so it can be patched later
+	int Jmp32()
+	{
+		Byte(0xE9);
+		Dword(0);
+		return Pos() - 4;
+	}
+
+	int Jcc32(int cc)
+	{
+		Byte(0x0F);
+		Byte(asBYTE(0x80 | cc));
+		Dword(0);
+		return Pos() - 4;
+	}
+
+	int Jmp8()
+	{
+		Byte(0xEB);
+		Byte(0);
+		return Pos() - 1;
+	}
+
+	int Jcc8(int cc)
+	{
+		Byte(asBYTE(0x70 | cc));
+		Byte(0);
+		return Pos() - 1;
+	}
+
+	void Bind8(int at)
+	{
+		code[at] = asBYTE(Pos() - (at + 1));
+	}
+
+	void Patch32(int at, int target)
+	{
+		asDWORD rel = asDWORD(target - (at + 4));
+		for( int n = 0; n < 4; n++ )
+			code[at+n] = asBYTE(rel >> (n*8));
+	}
+
+	vector<asBYTE> code;
+
+protected:
+	void Prefix(asBYTE prefix, bool w, int opcode, int reg, int rm)
+	{
+		if( prefix )
+			Byte(prefix);
+		asBYTE rex = asBYTE(0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0));
+		if( rex != 0x40 )
+			Byte(rex);
+		if( opcode > 0xFF )
+			Byte(asBYTE(opcode >> 8));
+		Byte(asBYTE(opcode));
+	}
+};
+
+// Translates the bytecode of one function. Every instruction is given a
+// position in the native code. Instructions that aren't supported jump to an
+// exit stub that stores the program and stack pointers for the VM and returns
+class CFunctionCompiler
+{
+public:
+	CFunctionCompiler(asDWORD *byteCode, asUINT length) :
+		nativeCount(0), fallbackCount(0), bc(byteCode), length(length), badJump(false),
+		nativePos(length, -1), isNative(length, false), isTarget(length, false), exitStub(length, -1)
+	{
+	}
+
+	bool Compile();
+	void SetEntryPoints(asBYTE *nativeCode);
+	bool HasEntryPoints() const;
+
+	CAssembler a;
+	asUINT     nativeCount;
+	asUINT     fallbackCount;
+
+protected:
+	struct SFixup
+	{
+		int    at;
+		asUINT pos;
+		bool   toExit;
+	};
+
+	static int Var(short offset)
+	{
+		// Variables are addressed as dwords below the stack frame pointer
+		return -int(offset) * 4;
+	}
+
+	void FindJumpTargets();
+	bool CompileInstr(asUINT pos, asUINT &size);
+	void JumpTo(int cc, asUINT pos);
+	void ExitIf(int cc, asUINT pos);
+	void AddFixup(int cc, asUINT pos, bool toExit);
+	void StoreCompareResult(bool isUnsigned);
+	void CompareFloat();
+	bool FuseCompareAndJump(asUINT pos, asUINT &size, bool isUnsigned);
+	void DivideInt(asDWORD *instr, asUINT pos, bool w, bool isUnsigned, bool remainder);
+	void DivideFloat(asDWORD *instr, asUINT pos, asBYTE prefix);
+	void Push(int reg, bool w);
+	void FinalizeJumps();
+
+	asDWORD       *bc;
+	asUINT         length;
+	bool           badJump;
+	vector<int>    nativePos;
+	vector<bool>   isNative;
+	vector<bool>   isTarget;
+	vector<int>    exitStub;
+	vector<SFixup> fixups;
+};
+
+void CFunctionCompiler::FindJumpTargets()
+{
+	for( asUINT pos = 0; pos < length; )
+	{
+		asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[pos]);
+		asUINT size = asBCTypeSize[asBCInfo[op].type];
+
+		if( (op >= asBC_JMP && op <= asBC_JNP) || op == asBC_JLowZ || op == asBC_JLowNZ )
+		{
+			asUINT target = pos + size + asBC_INTARG(&bc[pos]);
+			if( target < length )
+				isTarget[target] = true;
+		}
+		else if( op >= asBC_JLTi && op <= asBC_JGEIu )
+		{
+			// The compare and jump instructions have the offset in the last dword
+			asUINT target = pos + size + *(int*)&bc[pos+2];
+			if( target < length )
+				isTarget[target] = true;
+		}
+
+		pos += size;
+	}
+}
+
+void CFunctionCompiler::JumpTo(int cc, asUINT pos)
+{
+	AddFixup(cc, pos, false);
+}
+
+void CFunctionCompiler::ExitIf(int cc, asUINT pos)
+{
+	AddFixup(cc, pos, true);
+}
+
+void CFunctionCompiler::AddFixup(int cc, asUINT pos, bool toExit)
+{
+	// A target outside the bytecode can neither be jumped to nor
+	// handed to the VM, so the whole function is left to the VM
+	if( pos >= length )
+	{
+		badJump = true;
+		return;
+	}
+
+	SFixup f;
+	f.at     = cc < 0 ? a.Jmp32() : a.Jcc32(cc);
+	f.pos    = pos;
+	f.toExit = toExit;
+	fixups.push_back(f);
+}
+
+void CFunctionCompiler::Push(int reg, bool w)
+{
+	// sub r13, 4|8
+	a.Reg(0, true, 0x83, 5, SP);
+	a.Byte(w ? 8 : 4);
+	a.Mem(0, w, 0x89, reg, SP, 0);
+}
+
+void CFunctionCompiler::StoreCompareResult(bool isUnsigned)
+{
+	// valueRegister = (a > b) - (a < b)
+	a.Reg(0, false, 0x0F90 | (isUnsigned ? CC_A : CC_G), 0, RCX);
+	a.Reg(0, false, 0x0F90 | (isUnsigned ? CC_B : CC_L), 0, RAX);
+	a.Reg(0, false, 0x28, RAX, RCX);
+	a.Reg(0, false, 0x0FBE, RAX, RCX);
+	a.Mem(0, false, 0x89, RAX, REGS, VR_OFFSET);
+}
+
+void CFunctionCompiler::CompareFloat()
+{
+	// The flags have been set by ucomiss/ucomisd. Unordered values compare as greater, just as in the VM
+	a.Byte(0xB8); a.Dword(1);
+	int unordered = a.Jcc8(CC_P);
+	int equal     = a.Jcc8(CC_E);
+	int greater   = a.Jcc8(CC_AE);
+	a.Byte(0xB8); a.Dword(asDWORD(-1));
+	int done      = a.Jmp8();
+	a.Bind8(equal);
+	a.Reg(0, false, 0x31, RAX, RAX);
+	a.Bind8(unordered);
+	a.Bind8(greater);
+	a.Bind8(done);
+	a.Mem(0, false, 0x89, RAX, REGS, VR_OFFSET);
+}
+
+bool CFunctionCompiler::FuseCompareAndJump(asUINT pos, asUINT &size, bool isUnsigned)
+{
+	// When the comparison is directly followed by a conditional jump, and
+	// nothing jumps to the conditional jump, the flags are used directly.
+	// The value register is dead after the conditional jump so it isn't set.
+	asUINT next = pos + size;
+	if( next >= length || isTarget[next] )
+		return false;
+
+	asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[next]);
+	int cc;
+	switch( op )
+	{
+	case asBC_JZ:  cc = CC_E;  break;
+	case asBC_JNZ: cc = CC_NE; break;
+	case asBC_JS:  cc = isUnsigned ? CC_B  : CC_L;  break;
+	case asBC_JNS: cc = isUnsigned ? CC_AE : CC_GE; break;
+	case asBC_JP:  cc = isUnsigned ? CC_A  : CC_G;  break;
+	case asBC_JNP: cc = isUnsigned ? CC_BE : CC_LE; break;
+	default:
+		return false;
+	}
+
+	asUINT jmpSize = asBCTypeSize[asBCInfo[op].type];
+	nativePos[next] = nativePos[pos];
+	isNative[next] = true;
+	JumpTo(cc, next + jmpSize + asBC_INTARG(&bc[next]));
+	size += jmpSize;
+	nativeCount++;
+	return true;
+}
+
+void CFunctionCompiler::DivideInt(asDWORD *instr, asUINT pos, bool w, bool isUnsigned, bool remainder)
+{
+	// The VM raises the exceptions for division by zero and overflow, so
+	// the instruction is handed back to it in those cases
+	a.Mem(0, w, 0x8B, RCX, FP, Var(asBC_SWORDARG2(instr)));
+	a.Reg(0, w, 0x85, RCX, RCX);
+	ExitIf(CC_E, pos);
+	a.Mem(0, w, 0x8B, RAX, FP, Var(asBC_SWORDARG1(instr)));
+
+	if( isUnsigned )
+	{
+		a.Reg(0, false, 0x31, RDX, RDX);
+		a.Reg(0, w, 0xF7, 6, RCX);
+	}
+	else
+	{
+		a.Reg(0, w, 0x83, 7, RCX); a.Byte(0xFF);
+		int notMinusOne = a.Jcc8(CC_NE);
+		if( w )
+		{
+			a.MovImm64(RDX, asQWORD(1) << 63);
+			a.Reg(0, true, 0x3B, RAX, RDX);
+		}
+		else
+		{
+			a.Reg(0, false, 0x81, 7, RAX); a.Dword(0x80000000);
+		}
+		ExitIf(CC_E, pos);
+		a.Bind8(notMinusOne);
+		if( w ) a.Byte(0x48);
+		a.Byte(0x99);
+		a.Reg(0, w, 0xF7, 7, RCX);
+	}
+
+	a.Mem(0, w, 0x89, remainder ? RDX : RAX, FP, Var(asBC_SWORDARG0(instr)));
+}
+
+void CFunctionCompiler::DivideFloat(asDWORD *instr, asUINT pos, asBYTE prefix)
+{
+	asBYTE compare = prefix == 0xF2 ? 0x66 : 0;
+	a.Mem(prefix, false, 0x0F10, XMM1, FP, Var(asBC_SWORDARG2(instr)));
+	a.Reg(0, false, 0x0F57, XMM2, XMM2);
+	a.Reg(compare, false, 0x0F2E, XMM1, XMM2);
+	int unordered = a.Jcc8(CC_P);
+	ExitIf(CC_E, pos);
+	a.Bind8(unordered);
+	a.Mem(prefix, false, 0x0F10, XMM0, FP, Var(asBC_SWORDARG1(instr)));
+	a.Reg(prefix, false, 0x0F5E, XMM0, XMM1);
+	a.Mem(prefix, false, 0x0F11, XMM0, FP, Var(asBC_SWORDARG0(instr)));
+}
+
+bool CFunctionCompiler::CompileInstr(asUINT pos, asUINT &size)
+{
+	asDWORD   *instr = &bc[pos];
+	asEBCInstr op    = asEBCInstr(*(asBYTE*)instr);
+
+	// Shorthands for the operands. Only the first one fits in a single
+	// dword, and the last instruction of the bytecode may be that short
+	const int v0 = Var(asBC_SWORDARG0(instr));
+	const int v1 = size > 1 ? Var(asBC_SWORDARG1(instr)) : 0;
+	const int v2 = size > 1 ? Var(asBC_SWORDARG2(instr)) : 0;
+
+	switch( op )
+	{
+	case asBC_JitEntry:
+		// The VM enters the native code here, so nothing needs to be done
+		return true;
+
+	case asBC_SUSPEND:
+		// Leave it to the VM if the line callback or a breakpoint must be processed
+		a.Mem(0, false, 0x80, 7, REGS, SUSPEND_OFFSET); a.Byte(0);
+		ExitIf(CC_NE, pos);
+		a.MovImm64(RAX, asQWORD(asPWORD(instr)));
+		a.Mem(0, false, 0x80, 7, RAX, 1); a.Byte(0);
+		ExitIf(CC_NE, pos);
+		return true;
+
+	//------------------------
+	// Stack
+	case asBC_PopPtr:
+		a.Reg(0, true, 0x83, 0, SP); a.Byte(AS_PTR_SIZE*4);
+		return true;
+
+	case asBC_PshC4:
+		a.Reg(0, true, 0x83, 5, SP); a.Byte(4);
+		a.Mem(0, false, 0xC7, 0, SP, 0); a.Dword(asBC_DWORDARG(instr));
+		return true;
+
+	case asBC_PshC8:
+		a.MovImm64(RAX, asBC_QWORDARG(instr));
+		Push(RAX, true);
+		return true;
+
+	case asBC_PshV4:
+		a.Mem(0, false, 0x8B, RAX, FP, v0);
+		Push(RAX, false);
+		return true;
+
+	case asBC_PshV8:
+	case asBC_PshVPtr:
+		a.Mem(0, true, 0x8B, RAX, FP, v0);
+		Push(RAX, true);
+		return true;
+
+	case asBC_PSF:
+		a.Mem(0, true, 0x8D, RAX, FP, v0);
+		Push(RAX, true);
+		return true;
+
+	case asBC_PshNull:
+		a.Reg(0, true, 0x83, 5, SP); a.Byte(8);
+		a.Mem(0, true, 0xC7, 0, SP, 0); a.Dword(0);
+		return true;
+
+	case asBC_PshRPtr:
+		a.Mem(0, true, 0x8B, RAX, REGS, VR_OFFSET);
+		Push(RAX, true);
+		return true;
+
+	case asBC_PopRPtr:
+		a.Mem(0, true, 0x8B, RAX, SP, 0);
+		a.Mem(0, true, 0x89, RAX, REGS, VR_OFFSET);
+		a.Reg(0, true, 0x83, 0, SP); a.Byte(8);
+		return true;
+
+	case asBC_SwapPtr:
+		a.Mem(0, true, 0x8B, RAX, SP, 0);
+		a.Mem(0, true, 0x8B, RCX, SP, 8);
+		a.Mem(0, true, 0x89, RCX, SP, 0);
+		a.Mem(0, true, 0x89, RAX, SP, 8);
+		return true;
+
+	//------------------------
+	// Variables and the value register
+	case asBC_SetV1:
+	case asBC_SetV2:
+	case asBC_SetV4:
+		a.Mem(0, false, 0xC7, 0, FP, v0); a.Dword(asBC_DWORDARG(instr));
+		return true;
+
+	case asBC_SetV8:
+		a.MovImm64(RAX, asBC_QWORDARG(instr));
+		a.Mem(0, true, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_ClrVPtr:
+		a.Mem(0, true, 0xC7, 0, FP, v0); a.Dword(0);
+		return true;
+
+	case asBC_CpyVtoV4:
+	case asBC_CpyVtoV8:
+		a.Mem(0, op == asBC_CpyVtoV8, 0x8B, RAX, FP, v1);
+		a.Mem(0, op == asBC_CpyVtoV8, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_CpyVtoR4:
+	case asBC_CpyVtoR8:
+		a.Mem(0, op == asBC_CpyVtoR8, 0x8B, RAX, FP, v0);
+		a.Mem(0, op == asBC_CpyVtoR8, 0x89, RAX, REGS, VR_OFFSET);
+		return true;
+
+	case asBC_CpyRtoV4:
+	case asBC_CpyRtoV8:
+		a.Mem(0, op == asBC_CpyRtoV8, 0x8B, RAX, REGS, VR_OFFSET);
+		a.Mem(0, op == asBC_CpyRtoV8, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_RDR1:
+	case asBC_RDR2:
+	case asBC_RDR4:
+	case asBC_RDR8:
+		// The value register holds the address to read from. Bytes and words are zero extended
+		a.Mem(0, true, 0x8B, RAX, REGS, VR_OFFSET);
+		if( op == asBC_RDR1 )      a.Mem(0, false, 0x0FB6, RCX, RAX, 0);
+		else if( op == asBC_RDR2 ) a.Mem(0, false, 0x0FB7, RCX, RAX, 0);
+		else                       a.Mem(0, op == asBC_RDR8, 0x8B, RCX, RAX, 0);
+		a.Mem(0, op == asBC_RDR8, 0x89, RCX, FP, v0);
+		return true;
+
+	case asBC_WRTV1:
+	case asBC_WRTV2:
+	case asBC_WRTV4:
+	case asBC_WRTV8:
+		a.Mem(0, true, 0x8B, RAX, REGS, VR_OFFSET);
+		a.Mem(0, op == asBC_WRTV8, 0x8B, RCX, FP, v0);
+		if( op == asBC_WRTV1 )      a.Mem(0, false, 0x88, RCX, RAX, 0);
+		else if( op == asBC_WRTV2 ) a.Mem(0x66, false, 0x89, RCX, RAX, 0);
+		else                        a.Mem(0, op == asBC_WRTV8, 0x89, RCX, RAX, 0);
+		return true;
+
+	//------------------------
+	// Tests on the value register. Booleans are one byte with the rest of the register cleared
+	case asBC_TZ:
+	case asBC_TNZ:
+	case asBC_TS:
+	case asBC_TNS:
+	case asBC_TP:
+	case asBC_TNP:
+		{
+			static const int cc[] = {CC_E, CC_NE, CC_L, CC_GE, CC_G, CC_LE};
+			a.Mem(0, false, 0x8B, RAX, REGS, VR_OFFSET);
+			a.Reg(0, false, 0x85, RAX, RAX);
+			a.Reg(0, false, 0x0F90 | cc[op - asBC_TZ], 0, RAX);
+			a.Reg(0, false, 0x0FB6, RAX, RAX);
+			a.Mem(0, true, 0x89, RAX, REGS, VR_OFFSET);
+		}
+		return true;
+
+	case asBC_NOT:
+		a.Mem(0, false, 0x80, 7, FP, v0); a.Byte(0);
+		a.Reg(0, false, 0x0F90 | CC_E, 0, RAX);
+		a.Reg(0, false, 0x0FB6, RAX, RAX);
+		a.Mem(0, false, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_ClrHi:
+		a.Mem(0, false, 0x81, 4, REGS, VR_OFFSET); a.Dword(0xFF);
+		return true;
+
+	//------------------------
+	// Jumps
+	case asBC_JMP:
+		JumpTo(-1, pos + size + asBC_INTARG(instr));
+		return true;
+
+	case asBC_JZ:
+	case asBC_JNZ:
+	case asBC_JS:
+	case asBC_JNS:
+	case asBC_JP:
+	case asBC_JNP:
+		{
+			static const int cc[] = {CC_E, CC_NE, CC_L, CC_GE, CC_G, CC_LE};
+			a.Mem(0, false, 0x83, 7, REGS, VR_OFFSET); a.Byte(0);
+			JumpTo(cc[op - asBC_JZ], pos + size + asBC_INTARG(instr));
+		}
+		return true;
+
+	case asBC_JLowZ:
+	case asBC_JLowNZ:
+		a.Mem(0, false, 0x80, 7, REGS, VR_OFFSET); a.Byte(0);
+		JumpTo(op == asBC_JLowZ ? CC_E : CC_NE, pos + size + asBC_INTARG(instr));
+		return true;
+
+	//------------------------
+	// Comparisons
+	case asBC_CMPi:
+	case asBC_CMPu:
+	case asBC_CMPi64:
+	case asBC_CMPu64:
+		{
+			bool w = op == asBC_CMPi64 || op == asBC_CMPu64;
+			bool isUnsigned = op == asBC_CMPu || op == asBC_CMPu64;
+			a.Mem(0, w, 0x8B, RAX, FP, v0);
+			a.Mem(0, w, 0x3B, RAX, FP, v1);
+			if( !FuseCompareAndJump(pos, size, isUnsigned) )
+				StoreCompareResult(isUnsigned);
+		}
+		return true;
+
+	case asBC_CMPIi:
+	case asBC_CMPIu:
+		a.Mem(0, false, 0x8B, RAX, FP, v0);
+		a.Reg(0, false, 0x81, 7, RAX); a.Dword(asBC_DWORDARG(instr));
+		if( !FuseCompareAndJump(pos, size, op == asBC_CMPIu) )
+			StoreCompareResult(op == asBC_CMPIu);
+		return true;
+
+	case asBC_CMPf:
+		a.Mem(0xF3, false, 0x0F10, XMM0, FP, v0);
+		a.Mem(0, false, 0x0F2E, XMM0, FP, v1);
+		CompareFloat();
+		return true;
+
+	case asBC_CMPd:
+		a.Mem(0xF2, false, 0x0F10, XMM0, FP, v0);
+		a.Mem(0x66, false, 0x0F2E, XMM0, FP, v1);
+		CompareFloat();
+		return true;
+
+	case asBC_CMPIf:
+		a.Mem(0xF3, false, 0x0F10, XMM0, FP, v0);
+		a.Byte(0xB8); a.Dword(asBC_DWORDARG(instr));
+		a.Reg(0x66, false, 0x0F6E, XMM1, RAX);
+		a.Reg(0, false, 0x0F2E, XMM0, XMM1);
+		CompareFloat();
+		return true;
+
+	//------------------------
+	// Integer math
+	case asBC_IncVi:
+		a.Mem(0, false, 0xFF, 0, FP, v0);
+		return true;
+
+	case asBC_DecVi:
+		a.Mem(0, false, 0xFF, 1, FP, v0);
+		return true;
+
+	case asBC_NEGi:
+	case asBC_NEGi64:
+		a.Mem(0, op == asBC_NEGi64, 0xF7, 3, FP, v0);
+		return true;
+
+	case asBC_BNOT:
+	case asBC_BNOT64:
+		a.Mem(0, op == asBC_BNOT64, 0xF7, 2, FP, v0);
+		return true;
+
+	case asBC_ADDi: case asBC_ADDi64:
+	case asBC_SUBi: case asBC_SUBi64:
+	case asBC_MULi: case asBC_MULi64:
+	case asBC_BAND: case asBC_BAND64:
+	case asBC_BOR:  case asBC_BOR64:
+	case asBC_BXOR: case asBC_BXOR64:
+		{
+			bool w = op == asBC_ADDi64 || op == asBC_SUBi64 || op == asBC_MULi64 ||
+			         op == asBC_BAND64 || op == asBC_BOR64  || op == asBC_BXOR64;
+			int opcode;
+			if( op == asBC_ADDi || op == asBC_ADDi64 )      opcode = 0x03;
+			else if( op == asBC_SUBi || op == asBC_SUBi64 ) opcode = 0x2B;
+			else if( op == asBC_MULi || op == asBC_MULi64 ) opcode = 0x0FAF;
+			else if( op == asBC_BAND || op == asBC_BAND64 ) opcode = 0x23;
+			else if( op == asBC_BOR  || op == asBC_BOR64 )  opcode = 0x0B;
+			else                                            opcode = 0x33;
+			a.Mem(0, w, 0x8B, RAX, FP, v1);
+			a.Mem(0, w, opcode, RAX, FP, v2);
+			a.Mem(0, w, 0x89, RAX, FP, v0);
+		}
+		return true;
+
+	case asBC_ADDIi:
+	case asBC_SUBIi:
+		a.Mem(0, false, 0x8B, RAX, FP, v1);
+		a.Reg(0, false, 0x81, op == asBC_ADDIi ? 0 : 5, RAX); a.Dword(asBC_DWORDARG(instr+1));
+		a.Mem(0, false, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_MULIi:
+		a.Mem(0, false, 0x69, RAX, FP, v1); a.Dword(asBC_DWORDARG(instr+1));
+		a.Mem(0, false, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_BSLL: case asBC_BSLL64:
+	case asBC_BSRL: case asBC_BSRL64:
+	case asBC_BSRA: case asBC_BSRA64:
+		{
+			// The shift count is always a 32 bit variable
+			bool w = op == asBC_BSLL64 || op == asBC_BSRL64 || op == asBC_BSRA64;
+			int ext;
+			if( op == asBC_BSLL || op == asBC_BSLL64 )      ext = 4;
+			else if( op == asBC_BSRL || op == asBC_BSRL64 ) ext = 5;
+			else                                            ext = 7;
+			a.Mem(0, false, 0x8B, RCX, FP, v2);
+			a.Mem(0, w, 0x8B, RAX, FP, v1);
+			a.Reg(0, w, 0xD3, ext, RAX);
+			a.Mem(0, w, 0x89, RAX, FP, v0);
+		}
+		return true;
+
+	case asBC_DIVi:   DivideInt(instr, pos, false, false, false); return true;
+	case asBC_MODi:   DivideInt(instr, pos, false, false, true);  return true;
+	case asBC_DIVu:   DivideInt(instr, pos, false, true,  false); return true;
+	case asBC_MODu:   DivideInt(instr, pos, false, true,  true);  return true;
+	case asBC_DIVi64: DivideInt(instr, pos, true,  false, false); return true;
+	case asBC_MODi64: DivideInt(instr, pos, true,  false, true);  return true;
+	case asBC_DIVu64: DivideInt(instr, pos, true,  true,  false); return true;
+	case asBC_MODu64: DivideInt(instr, pos, true,  true,  true);  return true;
+
+	//------------------------
+	// Floating point math
+	case asBC_NEGf:
+	case asBC_NEGd:
+		// Flip the sign bit
+		a.Mem(0, false, 0x80, 6, FP, v0 + (op == asBC_NEGd ? 7 : 3)); a.Byte(0x80);
+		return true;
+
+	case asBC_ADDf: case asBC_ADDd:
+	case asBC_SUBf: case asBC_SUBd:
+	case asBC_MULf: case asBC_MULd:
+		{
+			asBYTE prefix = (op == asBC_ADDd || op == asBC_SUBd || op == asBC_MULd) ? 0xF2 : 0xF3;
+			int opcode;
+			if( op == asBC_ADDf || op == asBC_ADDd )      opcode = 0x0F58;
+			else if( op == asBC_SUBf || op == asBC_SUBd ) opcode = 0x0F5C;
+			else                                          opcode = 0x0F59;
+			a.Mem(prefix, false, 0x0F10, XMM0, FP, v1);
+			a.Mem(prefix, false, opcode, XMM0, FP, v2);
+			a.Mem(prefix, false, 0x0F11, XMM0, FP, v0);
+		}
+		return true;
+
+	case asBC_ADDIf:
+	case asBC_SUBIf:
+	case asBC_MULIf:
+		{
+			int opcode;
+			if( op == asBC_ADDIf )      opcode = 0x0F58;
+			else if( op == asBC_SUBIf ) opcode = 0x0F5C;
+			else                        opcode = 0x0F59;
+			a.Byte(0xB8); a.Dword(asBC_DWORDARG(instr+1));
+			a.Reg(0x66, false, 0x0F6E, XMM1, RAX);
+			a.Mem(0xF3, false, 0x0F10, XMM0, FP, v1);
+			a.Reg(0xF3, false, opcode, XMM0, XMM1);
+			a.Mem(0xF3, false, 0x0F11, XMM0, FP, v0);
+		}
+		return true;
+
+	case asBC_DIVf: DivideFloat(instr, pos, 0xF3); return true;
+	case asBC_DIVd: DivideFloat(instr, pos, 0xF2); return true;
+
+	//------------------------
+	// Conversions
+	case asBC_iTOf:
+		a.Mem(0xF3, false, 0x0F2A, XMM0, FP, v0);
+		a.Mem(0xF3, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_uTOf:
+		// The zero extended value is converted as a 64 bit integer
+		a.Mem(0, false, 0x8B, RAX, FP, v0);
+		a.Reg(0xF3, true, 0x0F2A, XMM0, RAX);
+		a.Mem(0xF3, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_fTOi:
+	case asBC_fTOu:
+		// The VM converts to int first for uint too
+		a.Mem(0xF3, false, 0x0F2C, RAX, FP, v0);
+		a.Mem(0, false, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_sbTOi:
+	case asBC_swTOi:
+	case asBC_ubTOi:
+	case asBC_uwTOi:
+	case asBC_iTOb:
+	case asBC_iTOw:
+		{
+			int opcode;
+			if( op == asBC_sbTOi )      opcode = 0x0FBE;
+			else if( op == asBC_swTOi ) opcode = 0x0FBF;
+			else if( op == asBC_ubTOi || op == asBC_iTOb ) opcode = 0x0FB6;
+			else                        opcode = 0x0FB7;
+			a.Mem(0, false, opcode, RAX, FP, v0);
+			a.Mem(0, false, 0x89, RAX, FP, v0);
+		}
+		return true;
+
+	case asBC_dTOi:
+	case asBC_dTOu:
+		a.Mem(0xF2, false, 0x0F2C, RAX, FP, v1);
+		a.Mem(0, false, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_dTOf:
+		a.Mem(0xF2, false, 0x0F5A, XMM0, FP, v1);
+		a.Mem(0xF3, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_fTOd:
+		a.Mem(0xF3, false, 0x0F5A, XMM0, FP, v1);
+		a.Mem(0xF2, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_iTOd:
+		a.Mem(0xF2, false, 0x0F2A, XMM0, FP, v1);
+		a.Mem(0xF2, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_uTOd:
+		a.Mem(0, false, 0x8B, RAX, FP, v1);
+		a.Reg(0xF2, true, 0x0F2A, XMM0, RAX);
+		a.Mem(0xF2, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_i64TOi:
+		a.Mem(0, false, 0x8B, RAX, FP, v1);
+		a.Mem(0, false, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_uTOi64:
+		a.Mem(0, false, 0x8B, RAX, FP, v1);
+		a.Mem(0, true, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_iTOi64:
+		a.Mem(0, true, 0x63, RAX, FP, v1);
+		a.Mem(0, true, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_i64TOd:
+		a.Mem(0xF2, true, 0x0F2A, XMM0, FP, v0);
+		a.Mem(0xF2, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_i64TOf:
+		a.Mem(0xF3, true, 0x0F2A, XMM0, FP, v1);
+		a.Mem(0xF3, false, 0x0F11, XMM0, FP, v0);
+		return true;
+
+	case asBC_dTOi64:
+		a.Mem(0xF2, true, 0x0F2C, RAX, FP, v0);
+		a.Mem(0, true, 0x89, RAX, FP, v0);
+		return true;
+
+	case asBC_fTOi64:
+		a.Mem(0xF3, true, 0x0F2C, RAX, FP, v1);
+		a.Mem(0, true, 0x89, RAX, FP, v0);
+		return true;
+
+	default:
+		// Calls, returns, object handling, globals, and the remaining
+		// instructions are left for the VM
+		return false;
+	}
+}
+
+bool CFunctionCompiler::Compile()
+{
+	FindJumpTargets();
+
+	// Prologue shared by all entry points. The entry point is passed in the jitArg
+	a.Byte(0x53);                          // push rbx
+	a.Byte(0x41); a.Byte(0x54);            // push r12
+	a.Byte(0x41); a.Byte(0x55);            // push r13
+	a.Reg(0, true, 0x89, RDI, REGS);       // mov r12, rdi
+	a.Mem(0, true, 0x8B, FP, RDI, FP_OFFSET);
+	a.Mem(0, true, 0x8B, SP, RDI, SP_OFFSET);
+	a.Reg(0, false, 0xFF, 4, RSI);         // jmp rsi
+
+	for( asUINT pos = 0; pos < length; )
+	{
+		asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[pos]);
+		asUINT size = asBCTypeSize[asBCInfo[op].type];
+
+		nativePos[pos] = a.Pos();
+		if( CompileInstr(pos, size) )
+		{
+			isNative[pos] = true;
+			if( op != asBC_JitEntry )
+				nativeCount++;
+		}
+		else
+		{
+			ExitIf(-1, pos);
+			fallbackCount++;
+		}
+
+		pos += size;
+	}
+
+	if( badJump )
+		return false;
+
+	FinalizeJumps();
+	return true;
+}
+
+void CFunctionCompiler::FinalizeJumps()
+{
+	// Exit stubs for the VM. The program pointer is passed in rax
+	vector<int> stubs;
+	for( size_t n = 0; n < fixups.size(); n++ )
+	{
+		SFixup &f = fixups[n];
+		// A target that didn't get native code, e.g. one in the middle
+		// of an instruction, is left for the VM to deal with
+		if( !f.toExit && nativePos[f.pos] >= 0 )
+		{
+			a.Patch32(f.at, nativePos[f.pos]);
+			continue;
+		}
+
+		if( exitStub[f.pos] < 0 )
+		{
+			exitStub[f.pos] = a.Pos();
+			a.MovImm64(RAX, asQWORD(asPWORD(&bc[f.pos])));
+			stubs.push_back(a.Jmp32());
+		}
+		a.Patch32(f.at, exitStub[f.pos]);
+	}
+
+	int exitPos = a.Pos();
+	a.Mem(0, true, 0x89, RAX, REGS, PP_OFFSET);
+	a.Mem(0, true, 0x89, SP, REGS, SP_OFFSET);
+	a.Byte(0x41); a.Byte(0x5D);            // pop r13
+	a.Byte(0x41); a.Byte(0x5C);            // pop r12
+	a.Byte(0x5B);                          // pop rbx
+	a.Byte(0xC3);                          // ret
+
+	for( size_t n = 0; n < stubs.size(); n++ )
+		a.Patch32(stubs[n], exitPos);
+}
+
+bool CFunctionCompiler::HasEntryPoints() const
+{
+	for( asUINT pos = 0; pos < length; pos += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[pos]].type] )
+	{
+		if( *(asBYTE*)&bc[pos] != asBC_JitEntry )
+			continue;
+
+		// There is no point in entering the native code just to exit at the next instruction
+		asUINT next = pos;
+		while( next < length && *(asBYTE*)&bc[next] == asBC_JitEntry )
+			next += asBCTypeSize[asBCInfo[asBC_JitEntry].type];
+		if( next < length && isNative[next] )
+			return true;
+	}
+	return false;
+}
+
+void CFunctionCompiler::SetEntryPoints(asBYTE *nativeCode)
+{
+	for( asUINT pos = 0; pos < length; pos += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[pos]].type] )
+	{
+		if( *(asBYTE*)&bc[pos] != asBC_JitEntry )
+			continue;
+
+		asUINT next = pos;
+		while( next < length && *(asBYTE*)&bc[next] == asBC_JitEntry )
+			next += asBCTypeSize[asBCInfo[asBC_JitEntry].type];
+
+		// A zero argument tells the VM to ignore the JitEntry
+		asPWORD arg = 0;
+		if( next < length && isNative[next] )
+			arg = asPWORD(nativeCode + nativePos[pos]);
+		*(asPWORD*)&bc[pos+1] = arg;
+	}
+}
+
+#endif // JIT_X64
+
+CJITCompiler::CJITCompiler()
+{
+	enabled              = true;
+	nativeInstructions   = 0;
+	fallbackInstructions = 0;
+}
+
+CJITCompiler::~CJITCompiler()
+{
+}
+
+int CJITCompiler::CompileFunction(asIScriptFunction *function, asJITFunction *output)
+{
+#ifdef JIT_X64
+	if( !enabled )
+		return asNOT_SUPPORTED;
+
+	asUINT length;
+	asDWORD *byteCode = function->GetByteCode(&length);
+	if( byteCode == 0 )
+		return asNOT_SUPPORTED;
+
+	CFunctionCompiler compiler(byteCode, length);
+	if( !compiler.Compile() || !compiler.HasEntryPoints() )
+		return asNOT_SUPPORTED;
+
+	// Copy the code to executable memory
+	size_t size = CODE_HEADER_SIZE + compiler.a.code.size();
+	void *mem = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if( mem == MAP_FAILED )
+		return asOUT_OF_MEMORY;
+
+	*(size_t*)mem = size;
+	asBYTE *code = (asBYTE*)mem + CODE_HEADER_SIZE;
+	memcpy(code, &compiler.a.code[0], compiler.a.code.size());
+	if( mprotect(mem, size, PROT_READ | PROT_EXEC) != 0 )
+	{
+		munmap(mem, size);
+		return asERROR;
+	}
+
+	compiler.SetEntryPoints(code);
+	nativeInstructions   += compiler.nativeCount;
+	fallbackInstructions += compiler.fallbackCount;
+
+	*output = (asJITFunction)code;
+	return asSUCCESS;
+#else
+	(void)function;
+	(void)output;
+	return asNOT_SUPPORTED;
+#endif
+}
+
+void CJITCompiler::ReleaseJITFunction(asJITFunction func)
+{
+#ifdef JIT_X64
+	if( func == 0 )
+		return;
+
+	asBYTE *mem = (asBYTE*)func - CODE_HEADER_SIZE;
+	munmap(mem, *(size_t*)mem);
+#else
+	(void)func;
+#endif
+}
+
+asUINT CJITCompiler::GetNativeInstructionCount() const
+{
+	return nativeInstructions;
+}
+
+asUINT CJITCompiler::GetFallbackInstructionCount() const
+{
+	return fallbackInstructions;
+}
+
+// The outcome of executing the entry function in one of the modules
+struct SExecution
+{
+	int          state;
+	std::string  exception;
+	int          exceptionLine;
+	vector<asBYTE> returnValue;
+};
+
+static int Execute(asIScriptEngine *engine, asIScriptModule *mod, const char *entryDecl, SExecution &exec)
+{
+	asIScriptFunction *func = mod->GetFunctionByDecl(entryDecl);
+	if( func == 0 )
+		return asNO_FUNCTION;
+
+	asIScriptContext *ctx = engine->CreateContext();
+	if( ctx == 0 )
+		return asERROR;
+
+	int r = ctx->Prepare(func);
+	if( r < 0 )
+	{
+		ctx->Release();
+		return r;
+	}
+
+	exec.state = ctx->Execute();
+	exec.exceptionLine = 0;
+	if( exec.state == asEXECUTION_EXCEPTION )
+	{
+		exec.exception     = ctx->GetExceptionString();
+		exec.exceptionLine = ctx->GetExceptionLineNumber();
+	}
+	else if( exec.state == asEXECUTION_FINISHED )
+	{
+		// Only primitive return values are compared
+		int size = engine->GetSizeOfPrimitiveType(func->GetReturnTypeId());
+		if( size > 0 )
+		{
+			asBYTE *value = (asBYTE*)ctx->GetAddressOfReturnValue();
+			exec.returnValue.assign(value, value + size);
+		}
+	}
+
+	ctx->Release();
+	return 0;
+}
+
+int CJITCompiler::CompareWithInterpreter(asIScriptEngine *engine, const char *sectionName, const char *script, const char *entryDecl, std::string *report)
+{
+	if( engine == 0 || engine->GetJITCompiler() != this ||
+		!engine->GetEngineProperty(asEP_INCLUDE_JIT_INSTRUCTIONS) )
+		return asINVALID_CONFIGURATION;
+
+	// Both modules are compiled with the JitEntry instructions so the VM
+	// executes exactly the same bytecode in the interpreted module
+	static const char *names[2] = {"jitcompiler:interpreted", "jitcompiler:native"};
+	asIScriptModule *mods[2] = {0, 0};
+	SExecution exec[2];
+	int r = 0;
+	for( int n = 0; n < 2 && r >= 0; n++ )
+	{
+		enabled = (n == 1);
+		mods[n] = engine->GetModule(names[n], asGM_ALWAYS_CREATE);
+		r = mods[n]->AddScriptSection(sectionName, script);
+		if( r >= 0 )
+			r = mods[n]->Build();
+		if( r >= 0 )
+			r = Execute(engine, mods[n], entryDecl, exec[n]);
+	}
+	enabled = true;
+
+	std::string differences;
+	if( r >= 0 )
+	{
+		char buf[256];
+		if( exec[0].state != exec[1].state )
+		{
+			snprintf(buf, sizeof(buf), "execution state differs: interpreted %d, native %d\n", exec[0].state, exec[1].state);
+			differences += buf;
+		}
+		if( exec[0].exception != exec[1].exception || exec[0].exceptionLine != exec[1].exceptionLine )
+		{
+			snprintf(buf, sizeof(buf), "exception differs: interpreted '%s' (line %d), native '%s' (line %d)\n",
+				exec[0].exception.c_str(), exec[0].exceptionLine, exec[1].exception.c_str(), exec[1].exceptionLine);
+			differences += buf;
+		}
+		if( exec[0].returnValue != exec[1].returnValue )
+			differences += "return value differs\n";
+
+		// The modules are built from the same script so the globals are declared in the same order
+		for( asUINT n = 0; n < mods[0]->GetGlobalVarCount(); n++ )
+		{
+			const char *name;
+			int typeId;
+			mods[0]->GetGlobalVar(n, &name, 0, &typeId);
+			int size = engine->GetSizeOfPrimitiveType(typeId);
+			if( size <= 0 )
+				continue;
+
+			if( memcmp(mods[0]->GetAddressOfGlobalVar(n), mods[1]->GetAddressOfGlobalVar(n), size) != 0 )
+			{
+				snprintf(buf, sizeof(buf), "global variable '%s' differs\n", name);
+				differences += buf;
+			}
+		}
+
+		if( report )
+			*report = differences;
+	}
+
+	for( int n = 0; n < 2; n++ )
+		if( mods[n] )
+			mods[n]->Discard();
+
+	if( r < 0 )
+		return r;
+
+	return differences.empty() ? 0 : 1;
+}
+
+END_AS_NAMESPACE
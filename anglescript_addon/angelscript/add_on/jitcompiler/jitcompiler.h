@@ -0,0 +1,60 @@
+#ifndef JITCOMPILER_H
+#define JITCOMPILER_H
+
+// A native code JIT compiler for x86-64 Linux.
+//
+// The arithmetic, comparison, branch, conversion, local variable, and
+// argument passing instructions are translated to machine code. Anything
+// else, including the call and return instructions, is handed back to the
+// VM, which re-enters the native code at the next JitEntry instruction. As
+// the VM executes the calls, the called script functions run their own
+// native code.
+//
+// The engine property asEP_INCLUDE_JIT_INSTRUCTIONS must be set before the
+// scripts are compiled, and the compiler must be registered with
+// SetJITCompiler. On other platforms CompileFunction fails and the scripts
+// are executed by the VM as usual.
+
+#ifndef ANGELSCRIPT_H
+// Avoid having to inform include path if header is already include before
+#include <angelscript.h>
+#endif
+
+#include <string>
+
+BEGIN_AS_NAMESPACE
+
+class CJITCompiler : public asIJITCompiler
+{
+public:
+	CJITCompiler();
+	virtual ~CJITCompiler();
+
+	// asIJITCompiler
+	virtual int  CompileFunction(asIScriptFunction *function, asJITFunction *output);
+	virtual void ReleaseJITFunction(asJITFunction func);
+
+	// Differential test mode. The script is built into two modules, one that
+	// is only executed by the VM and one that is JIT compiled, and the entry
+	// function is executed in both. The execution state, exception, return
+	// value, and primitive global variables are then compared.
+	//
+	// Returns 0 if the results are the same, 1 if they differ (the differences
+	// are written to the report), or a negative value if the script couldn't
+	// be built or the engine isn't set up to use this compiler.
+	int CompareWithInterpreter(asIScriptEngine *engine, const char *sectionName, const char *script, const char *entryDecl, std::string *report = 0);
+
+	// Number of bytecode instructions that have been compiled to native
+	// code, and the number that are left for the VM to execute
+	asUINT GetNativeInstructionCount() const;
+	asUINT GetFallbackInstructionCount() const;
+
+protected:
+	bool   enabled;
+	asUINT nativeInstructions;
+	asUINT fallbackInstructions;
+};
+
+END_AS_NAMESPACE
+
+#endif
@@ -3,9 +3,25 @@
 #include <string.h>
 #include <assert.h>
 #include <stdio.h> // sprintf
+#include <algorithm> // sort, stable_sort
+#include <functional> // less, greater
 
 #include "scriptarray.h"
 
+// The find, compare, reverse and fill of primitive arrays use SSE2 (and AVX2 if
+// the compiler targets it). Define AS_ARRAY_NO_SIMD to use plain C++ loops only
+#if !defined(AS_ARRAY_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define AS_ARRAY_SSE2
+	#include <emmintrin.h>
+	#if defined(__AVX2__)
+		#define AS_ARRAY_AVX2
+		#include <immintrin.h>
+	#endif
+	#if defined(_MSC_VER)
+		#include <intrin.h> // _BitScanForward
+	#endif
+#endif
+
 using namespace std;
 
 BEGIN_AS_NAMESPACE
@@ -323,6 +339,240 @@ static void RegisterScriptArray_Native(asIScriptEngine *engine)
 #endif
 }
 
+// internal
+// SIMD kernels for arrays of primitives. All vectors are kept as integer
+// vectors and the element type decides how they are compared and shuffled.
+// The compare sets all bytes of an equal element, so the movemask has one
+// bit per byte and LaneMask picks the first byte of each element.
+#ifdef AS_ARRAY_SSE2
+static inline asUINT LowestBit(asUINT mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+template<class T>
+struct SArraySimd;
+
+template<>
+struct SArraySimd<asBYTE>
+{
+	enum { LaneMask = 0xFFFFFFFF };
+	static __m128i Splat(asBYTE v) { return _mm_set1_epi8((char)v); }
+	static __m128i CmpEq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+	static __m128i Reverse(__m128i v)
+	{
+		// Swap the bytes in each word and then reverse the words
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		return _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2));
+	}
+#ifdef AS_ARRAY_AVX2
+	static __m256i Splat256(asBYTE v) { return _mm256_set1_epi8((char)v); }
+	static __m256i CmpEq256(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+#endif
+};
+
+template<>
+struct SArraySimd<asWORD>
+{
+	enum { LaneMask = 0x55555555 };
+	static __m128i Splat(asWORD v) { return _mm_set1_epi16((short)v); }
+	static __m128i CmpEq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+	static __m128i Reverse(__m128i v)
+	{
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		return _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2));
+	}
+#ifdef AS_ARRAY_AVX2
+	static __m256i Splat256(asWORD v) { return _mm256_set1_epi16((short)v); }
+	static __m256i CmpEq256(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+#endif
+};
+
+template<>
+struct SArraySimd<asDWORD>
+{
+	enum { LaneMask = 0x11111111 };
+	static __m128i Splat(asDWORD v) { return _mm_set1_epi32((int)v); }
+	static __m128i CmpEq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+	static __m128i Reverse(__m128i v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0,1,2,3)); }
+#ifdef AS_ARRAY_AVX2
+	static __m256i Splat256(asDWORD v) { return _mm256_set1_epi32((int)v); }
+	static __m256i CmpEq256(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+#endif
+};
+
+template<>
+struct SArraySimd<asQWORD>
+{
+	enum { LaneMask = 0x01010101 };
+	static __m128i Splat(asQWORD v) { return _mm_set_epi32((int)(v >> 32), (int)v, (int)(v >> 32), (int)v); }
+	static __m128i CmpEq(__m128i a, __m128i b)
+	{
+		// SSE2 has no 64bit compare so both halves must match
+		__m128i eq = _mm_cmpeq_epi32(a, b);
+		return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2,3,0,1)));
+	}
+	static __m128i Reverse(__m128i v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2)); }
+#ifdef AS_ARRAY_AVX2
+	static __m256i Splat256(asQWORD v) { return _mm256_set1_epi64x((long long)v); }
+	static __m256i CmpEq256(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+#endif
+};
+
+// Floats are compared with the IEEE rules, i.e. NaN != NaN and -0 == +0
+template<>
+struct SArraySimd<float>
+{
+	enum { LaneMask = 0x11111111 };
+	static __m128i Splat(float v) { return _mm_castps_si128(_mm_set1_ps(v)); }
+	static __m128i CmpEq(__m128i a, __m128i b) { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+#ifdef AS_ARRAY_AVX2
+	static __m256i Splat256(float v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+	static __m256i CmpEq256(__m256i a, __m256i b) { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ)); }
+#endif
+};
+
+template<>
+struct SArraySimd<double>
+{
+	enum { LaneMask = 0x01010101 };
+	static __m128i Splat(double v) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+	static __m128i CmpEq(__m128i a, __m128i b) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+#ifdef AS_ARRAY_AVX2
+	static __m256i Splat256(double v) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+	static __m256i CmpEq256(__m256i a, __m256i b) { return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ)); }
+#endif
+};
+#endif
+
+// internal
+template<class T>
+static int FindValue(const void *data, asUINT start, asUINT size, const void *value)
+{
+	const T *elements = reinterpret_cast<const T*>(data);
+	const T v = *reinterpret_cast<const T*>(value);
+	asUINT i = start;
+
+#ifdef AS_ARRAY_AVX2
+	const __m256i needle256 = SArraySimd<T>::Splat256(v);
+	for( ; size - i >= 32/sizeof(T); i += 32/sizeof(T) )
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(elements + i));
+		asUINT mask = (asUINT)_mm256_movemask_epi8(SArraySimd<T>::CmpEq256(block, needle256)) & (asUINT)SArraySimd<T>::LaneMask;
+		if( mask )
+			return int(i + LowestBit(mask)/sizeof(T));
+	}
+#endif
+#ifdef AS_ARRAY_SSE2
+	const __m128i needle = SArraySimd<T>::Splat(v);
+	for( ; size - i >= 16/sizeof(T); i += 16/sizeof(T) )
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(elements + i));
+		asUINT mask = (asUINT)_mm_movemask_epi8(SArraySimd<T>::CmpEq(block, needle)) & (asUINT)SArraySimd<T>::LaneMask;
+		if( mask )
+			return int(i + LowestBit(mask)/sizeof(T));
+	}
+#endif
+
+	for( ; i < size; i++ )
+		if( elements[i] == v )
+			return int(i);
+
+	return -1;
+}
+
+// internal
+template<class T>
+static bool EqualValues(const void *a, const void *b, asUINT size)
+{
+	const T *x = reinterpret_cast<const T*>(a);
+	const T *y = reinterpret_cast<const T*>(b);
+	asUINT i = 0;
+
+#ifdef AS_ARRAY_AVX2
+	for( ; size - i >= 32/sizeof(T); i += 32/sizeof(T) )
+	{
+		__m256i eq = SArraySimd<T>::CmpEq256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+		                                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+		if( _mm256_movemask_epi8(eq) != -1 )
+			return false;
+	}
+#endif
+#ifdef AS_ARRAY_SSE2
+	for( ; size - i >= 16/sizeof(T); i += 16/sizeof(T) )
+	{
+		__m128i eq = SArraySimd<T>::CmpEq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)),
+		                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+		if( _mm_movemask_epi8(eq) != 0xFFFF )
+			return false;
+	}
+#endif
+
+	for( ; i < size; i++ )
+		if( !(x[i] == y[i]) )
+			return false;
+
+	return true;
+}
+
+// internal
+// Only used with the unsigned integer types as the values are just moved
+template<class T>
+static void ReverseValues(void *data, asUINT size)
+{
+	T *lo = reinterpret_cast<T*>(data);
+	T *hi = lo + size;
+
+#ifdef AS_ARRAY_SSE2
+	// Swap whole blocks from both ends and leave the middle to std::reverse
+	const asUINT perBlock = 16/sizeof(T);
+	while( asUINT(hi - lo) >= 2*perBlock )
+	{
+		hi -= perBlock;
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lo), SArraySimd<T>::Reverse(b));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(hi), SArraySimd<T>::Reverse(a));
+		lo += perBlock;
+	}
+#endif
+
+	std::reverse(lo, hi);
+}
+
+// internal
+// Only used with the unsigned integer types as the values are just copied
+template<class T>
+static void FillValues(void *data, asUINT start, asUINT end, const void *value)
+{
+	T *elements = reinterpret_cast<T*>(data);
+	const T v = *reinterpret_cast<const T*>(value);
+	asUINT i = start;
+
+#ifdef AS_ARRAY_AVX2
+	const __m256i splat256 = SArraySimd<T>::Splat256(v);
+	for( ; end - i >= 32/sizeof(T); i += 32/sizeof(T) )
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(elements + i), splat256);
+#endif
+#ifdef AS_ARRAY_SSE2
+	const __m128i splat = SArraySimd<T>::Splat(v);
+	for( ; end - i >= 16/sizeof(T); i += 16/sizeof(T) )
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(elements + i), splat);
+#endif
+
+	for( ; i < end; i++ )
+		elements[i] = v;
+}
+
 CScriptArray &CScriptArray::operator=(const CScriptArray &other)
 {
 	// Only perform the copy if the array types are the same
@@ -510,8 +760,21 @@ CScriptArray::CScriptArray(asUINT length, void *defVal, asIObjectType *ot)
 		objType->GetEngine()->NotifyGarbageCollectorOfNewObject(this, objType);
 
 	// Initialize the elements with the default value
-	for( asUINT n = 0; n < GetSize(); n++ )
-		SetValue(n, defVal);
+	if( !(subTypeId & ~asTYPEID_MASK_SEQNBR) )
+	{
+		switch( elementSize )
+		{
+		case 1: FillValues<asBYTE>(buffer->data, 0, GetSize(), defVal); break;
+		case 2: FillValues<asWORD>(buffer->data, 0, GetSize(), defVal); break;
+		case 4: FillValues<asDWORD>(buffer->data, 0, GetSize(), defVal); break;
+		case 8: FillValues<asQWORD>(buffer->data, 0, GetSize(), defVal); break;
+		}
+	}
+	else
+	{
+		for( asUINT n = 0; n < GetSize(); n++ )
+			SetValue(n, defVal);
+	}
 }
 
 void CScriptArray::SetValue(asUINT index, void *value)
@@ -898,6 +1161,8 @@ bool CScriptArray::Less(const void *a, const void *b, bool asc, asIScriptContext
 			case asTYPEID_UINT16: return COMPARE(unsigned short);
 			case asTYPEID_INT32: return COMPARE(signed int);
 			case asTYPEID_UINT32: return COMPARE(unsigned int);
+			case asTYPEID_INT64: return COMPARE(asINT64);
+			case asTYPEID_UINT64: return COMPARE(asQWORD);
 			case asTYPEID_FLOAT: return COMPARE(float);
 			case asTYPEID_DOUBLE: return COMPARE(double);
 			default: return COMPARE(signed int); // All enums fall in this case
@@ -950,13 +1215,25 @@ void CScriptArray::Reverse()
 
 	if( size >= 2 )
 	{
-		asBYTE TEMP[16];
-
-		for( asUINT i = 0; i < size / 2; i++ )
+		// Objects and handles are stored as pointers so
+		// all arrays can be reversed by the element size
+		switch( elementSize )
 		{
-			Copy(TEMP, GetArrayItemPointer(i));
-			Copy(GetArrayItemPointer(i), GetArrayItemPointer(size - i - 1));
-			Copy(GetArrayItemPointer(size - i - 1), TEMP);
+		case 1: ReverseValues<asBYTE>(buffer->data, size); break;
+		case 2: ReverseValues<asWORD>(buffer->data, size); break;
+		case 4: ReverseValues<asDWORD>(buffer->data, size); break;
+		case 8: ReverseValues<asQWORD>(buffer->data, size); break;
+		default:
+			{
+				asBYTE TEMP[16];
+
+				for( asUINT i = 0; i < size / 2; i++ )
+				{
+					Copy(TEMP, GetArrayItemPointer(i));
+					Copy(GetArrayItemPointer(i), GetArrayItemPointer(size - i - 1));
+					Copy(GetArrayItemPointer(size - i - 1), TEMP);
+				}
+			}
 		}
 	}
 }
@@ -969,6 +1246,24 @@ bool CScriptArray::operator==(const CScriptArray &other) const
 	if( GetSize() != other.GetSize() )
 		return false;
 
+	// Primitives are compared without a script context
+	if( !(subTypeId & ~asTYPEID_MASK_SEQNBR) )
+	{
+		switch( subTypeId )
+		{
+		case asTYPEID_FLOAT:  return EqualValues<float>(buffer->data, other.buffer->data, GetSize());
+		case asTYPEID_DOUBLE: return EqualValues<double>(buffer->data, other.buffer->data, GetSize());
+		}
+
+		switch( elementSize )
+		{
+		case 1:  return EqualValues<asBYTE>(buffer->data, other.buffer->data, GetSize());
+		case 2:  return EqualValues<asWORD>(buffer->data, other.buffer->data, GetSize());
+		case 4:  return EqualValues<asDWORD>(buffer->data, other.buffer->data, GetSize());
+		default: return EqualValues<asQWORD>(buffer->data, other.buffer->data, GetSize());
+		}
+	}
+
 	asIScriptContext *cmpContext = 0;
 	bool isNested = false;
 
@@ -985,10 +1280,8 @@ bool CScriptArray::operator==(const CScriptArray &other) const
 		}
 		if( cmpContext == 0 )
 		{
-			// TODO: Ideally this context would be retrieved from a pool, so we don't have to
-			//       create a new one everytime. We could keep a context with the array object
-			//       but that would consume a lot of resources as each context is quite heavy.
-			cmpContext = objType->GetEngine()->CreateContext();
+			// Take a context from the engine's pool so one isn't created for every call
+			cmpContext = objType->GetEngine()->RequestContext();
 		}
 	}
 
@@ -1012,7 +1305,7 @@ bool CScriptArray::operator==(const CScriptArray &other) const
 				cmpContext->Abort();
 		}
 		else
-			cmpContext->Release();
+			objType->GetEngine()->ReturnContext(cmpContext);
 	}
 
 	return isEqual;
@@ -1143,6 +1436,28 @@ int CScriptArray::Find(void *value) const
 
 int CScriptArray::Find(asUINT startAt, void *value) const
 {
+	// Primitives are searched without a script context
+	if( !(subTypeId & ~asTYPEID_MASK_SEQNBR) )
+	{
+		asUINT size = GetSize();
+		if( startAt >= size )
+			return -1;
+
+		switch( subTypeId )
+		{
+		case asTYPEID_FLOAT:  return FindValue<float>(buffer->data, startAt, size, value);
+		case asTYPEID_DOUBLE: return FindValue<double>(buffer->data, startAt, size, value);
+		}
+
+		switch( elementSize )
+		{
+		case 1:  return FindValue<asBYTE>(buffer->data, startAt, size, value);
+		case 2:  return FindValue<asWORD>(buffer->data, startAt, size, value);
+		case 4:  return FindValue<asDWORD>(buffer->data, startAt, size, value);
+		default: return FindValue<asQWORD>(buffer->data, startAt, size, value);
+		}
+	}
+
 	// Check if the subtype really supports find()
 	// TODO: Can't this be done at compile time too by the template callback
 	SArrayCache *cache = 0;
@@ -1194,10 +1509,8 @@ int CScriptArray::Find(asUINT startAt, void *value) const
 		}
 		if( cmpContext == 0 )
 		{
-			// TODO: Ideally this context would be retrieved from a pool, so we don't have to
-			//       create a new one everytime. We could keep a context with the array object
-			//       but that would consume a lot of resources as each context is quite heavy.
-			cmpContext = objType->GetEngine()->CreateContext();
+			// Take a context from the engine's pool so one isn't created for every call
+			cmpContext = objType->GetEngine()->RequestContext();
 		}
 	}
 
@@ -1225,7 +1538,7 @@ int CScriptArray::Find(asUINT startAt, void *value) const
 				cmpContext->Abort();
 		}
 		else
-			cmpContext->Release();
+			objType->GetEngine()->ReturnContext(cmpContext);
 	}
 
 	return ret;
@@ -1265,6 +1578,60 @@ void *CScriptArray::GetDataPointer(void *buffer)
 }
 
 
+// Comparators used by Sort. Floats order NaN after all other
+// values to keep a strict weak ordering which std::sort requires
+template<class T>
+struct SArrayFloatLess
+{
+	bool operator()(T a, T b) const { return a < b || (b != b && a == a); }
+};
+
+template<class T>
+struct SArrayFloatGreater
+{
+	bool operator()(T a, T b) const { return b < a || (a != a && b == b); }
+};
+
+template<class T, class Less, class Greater>
+static void SortPrimitives(void *data, int start, int end, bool asc)
+{
+	T *first = reinterpret_cast<T*>(data) + start;
+	T *last = reinterpret_cast<T*>(data) + end;
+
+	if( asc )
+		std::sort(first, last, Less());
+	else
+		std::sort(first, last, Greater());
+}
+
+template<class T>
+static void SortPrimitives(void *data, int start, int end, bool asc)
+{
+	SortPrimitives<T, std::less<T>, std::greater<T> >(data, start, end, asc);
+}
+
+// Objects and handles are stored as pointers in the buffer so
+// only the pointers are moved. opCmp is called through Less()
+struct SArrayLess
+{
+	SArrayLess(CScriptArray *array, bool asc, asIScriptContext *ctx, SArrayCache *cache)
+		: array(array), asc(asc), ctx(ctx), cache(cache), isHandle((array->subTypeId & asTYPEID_OBJHANDLE) != 0) {}
+
+	bool operator()(void *a, void *b) const
+	{
+		// Less() takes the address of the handle, but the object itself
+		if( isHandle )
+			return array->Less(&a, &b, asc, ctx, cache);
+		return array->Less(a, b, asc, ctx, cache);
+	}
+
+	CScriptArray      *array;
+	bool               asc;
+	asIScriptContext  *ctx;
+	SArrayCache       *cache;
+	bool               isHandle;
+};
+
 // Sort ascending
 void CScriptArray::SortAsc()
 {
@@ -1350,45 +1717,50 @@ void CScriptArray::Sort(asUINT startAt, asUINT count, bool asc)
 		return;
 	}
 
-	asBYTE tmp[16];
-	asIScriptContext *cmpContext = 0;
-	bool isNested = false;
-
-	if( subTypeId & ~asTYPEID_MASK_SEQNBR )
+	// Primitives are sorted directly with a comparator for the type
+	if( !(subTypeId & ~asTYPEID_MASK_SEQNBR) )
 	{
-		// Try to reuse the active context
-		cmpContext = asGetActiveContext();
-		if( cmpContext )
-		{
-			if( cmpContext->GetEngine() == objType->GetEngine() && cmpContext->PushState() >= 0 )
-				isNested = true;
-			else
-				cmpContext = 0;
-		}
-		if( cmpContext == 0 )
+		switch( subTypeId )
 		{
-			// TODO: Ideally this context would be retrieved from a pool, so we don't have to
-			//       create a new one everytime. We could keep a context with the array object
-			//       but that would consume a lot of resources as each context is quite heavy.
-			cmpContext = objType->GetEngine()->CreateContext();
+		case asTYPEID_BOOL:   SortPrimitives<bool>(buffer->data, start, end, asc); break;
+		case asTYPEID_INT8:   SortPrimitives<signed char>(buffer->data, start, end, asc); break;
+		case asTYPEID_UINT8:  SortPrimitives<unsigned char>(buffer->data, start, end, asc); break;
+		case asTYPEID_INT16:  SortPrimitives<signed short>(buffer->data, start, end, asc); break;
+		case asTYPEID_UINT16: SortPrimitives<unsigned short>(buffer->data, start, end, asc); break;
+		case asTYPEID_INT32:  SortPrimitives<signed int>(buffer->data, start, end, asc); break;
+		case asTYPEID_UINT32: SortPrimitives<unsigned int>(buffer->data, start, end, asc); break;
+		case asTYPEID_INT64:  SortPrimitives<asINT64>(buffer->data, start, end, asc); break;
+		case asTYPEID_UINT64: SortPrimitives<asQWORD>(buffer->data, start, end, asc); break;
+		case asTYPEID_FLOAT:  SortPrimitives<float, SArrayFloatLess<float>, SArrayFloatGreater<float> >(buffer->data, start, end, asc); break;
+		case asTYPEID_DOUBLE: SortPrimitives<double, SArrayFloatLess<double>, SArrayFloatGreater<double> >(buffer->data, start, end, asc); break;
+		default:              SortPrimitives<signed int>(buffer->data, start, end, asc); break; // All enums fall in this case
 		}
-	}
-
-	// Insertion sort
-	for( int i = start + 1; i < end; i++ )
-	{
-		Copy(tmp, GetArrayItemPointer(i));
 
-		int j = i - 1;
+		return;
+	}
 
-		while( j >= start && Less(GetDataPointer(tmp), At(j), asc, cmpContext, cache) )
-		{
-			Copy(GetArrayItemPointer(j + 1), GetArrayItemPointer(j));
-			j--;
-		}
+	asIScriptContext *cmpContext = 0;
+	bool isNested = false;
 
-		Copy(GetArrayItemPointer(j + 1), tmp);
+	// Try to reuse the active context
+	cmpContext = asGetActiveContext();
+	if( cmpContext )
+	{
+		if( cmpContext->GetEngine() == objType->GetEngine() && cmpContext->PushState() >= 0 )
+			isNested = true;
+		else
+			cmpContext = 0;
 	}
+	if( cmpContext == 0 )
+	{
+		// Take a context from the engine's pool so one isn't created for every call
+		cmpContext = objType->GetEngine()->RequestContext();
+	}
+
+	// A merge sort keeps the order of equal elements as the earlier insertion sort did,
+	// and it can't go out of bounds even if the script's opCmp isn't consistent
+	void **data = reinterpret_cast<void**>(buffer->data);
+	std::stable_sort(data + start, data + end, SArrayLess(this, asc, cmpContext, cache));
 
 	if( cmpContext )
 	{
@@ -1400,7 +1772,7 @@ void CScriptArray::Sort(asUINT startAt, asUINT count, bool asc)
 				cmpContext->Abort();
 		}
 		else
-			cmpContext->Release();
+			objType->GetEngine()->ReturnContext(cmpContext);
 	}
 }
 
@@ -1,12 +1,34 @@
 #include <assert.h>
 #include <string.h>
+#include <new>
 #include "scriptdictionary.h"
 #include "../scriptarray/scriptarray.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h> // _BitScanReverse
+#endif
+
 BEGIN_AS_NAMESPACE
 
 using namespace std;
 
+// Returns the index of the highest set bit. value must not be 0
+static inline asUINT HighestBit(asUINT value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return index;
+#elif defined(__GNUC__)
+	return 31 - __builtin_clz(value);
+#else
+	asUINT bit = 0;
+	while( value >>= 1 )
+		bit++;
+	return bit;
+#endif
+}
+
 //--------------------------------------------------------------------------
 // CScriptDictionary implementation
 
@@ -32,6 +54,14 @@ CScriptDictionary::CScriptDictionary(asIScriptEngine *engine)
 	refCount = 1;
 	gcFlag = false;
 
+	blocks = 0;
+	numBlocks = 0;
+	numEntries = 0;
+	numKeys = 0;
+	freeEntries = 0;
+	slots = 0;
+	numSlots = 0;
+
 	// Keep a reference to the engine for as long as we live
 	// We don't increment the reference counter, because the 
 	// engine will hold a pointer to the object. 
@@ -48,6 +78,14 @@ CScriptDictionary::CScriptDictionary(asBYTE *buffer)
 	refCount = 1;
 	gcFlag = false;
 
+	blocks = 0;
+	numBlocks = 0;
+	numEntries = 0;
+	numKeys = 0;
+	freeEntries = 0;
+	slots = 0;
+	numSlots = 0;
+
 	// This constructor will always be called from a script
 	// so we can get the engine from the active context
 	asIScriptContext *ctx = asGetActiveContext();
@@ -143,6 +181,159 @@ CScriptDictionary::~CScriptDictionary()
 	DeleteAll();
 }
 
+// internal
+asUINT CScriptDictionary::HashKey(const string &key)
+{
+	// FNV-1a with a final mix so the low bits used for the slot depend on all characters
+	asUINT h = 2166136261u;
+	const char *c = key.c_str();
+	for( size_t n = key.length(); n > 0; n--, c++ )
+		h = (h ^ (asBYTE)*c) * 16777619u;
+
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+// internal
+CScriptDictionary::SEntry *CScriptDictionary::GetEntry(asUINT index) const
+{
+	// Block n starts at index FIRST_BLOCK_SIZE*(2^n - 1), so the
+	// block is given by the highest bit of index + FIRST_BLOCK_SIZE
+	asUINT i = index + FIRST_BLOCK_SIZE;
+	asUINT bit = HighestBit(i);
+
+	return &blocks[bit - FIRST_BLOCK_SHIFT][i - (1u << bit)];
+}
+
+// internal
+CScriptDictionary::SEntry *CScriptDictionary::Find(const string &key) const
+{
+	if( numKeys == 0 )
+		return 0;
+
+	asUINT hash = HashKey(key);
+	asUINT mask = numSlots - 1;
+	for( asUINT n = hash & mask; slots[n].entry; n = (n + 1) & mask )
+	{
+		if( slots[n].hash == hash && slots[n].entry->key == key )
+			return slots[n].entry;
+	}
+
+	return 0;
+}
+
+// internal
+// Returns the entry for the key, adding an empty value if it doesn't exist
+CScriptDictionary::SEntry *CScriptDictionary::Insert(const string &key)
+{
+	// Keep the table at most 3/4 full
+	if( (numKeys + 1) * 4 > numSlots * 3 )
+		Rehash(numSlots ? numSlots * 2 : (asUINT)MIN_SLOTS);
+
+	asUINT hash = HashKey(key);
+	asUINT mask = numSlots - 1;
+	asUINT n = hash & mask;
+	for( ; slots[n].entry; n = (n + 1) & mask )
+	{
+		if( slots[n].hash == hash && slots[n].entry->key == key )
+			return slots[n].entry;
+	}
+
+	SEntry *entry = freeEntries;
+	if( entry )
+		freeEntries = entry->nextFree;
+	else
+	{
+		// Add a new block when the last one is full
+		if( numEntries == FIRST_BLOCK_SIZE * ((1u << numBlocks) - 1) )
+		{
+			SEntry **newBlocks = (SEntry**)asAllocMem(sizeof(SEntry*) * (numBlocks + 1));
+			if( blocks )
+			{
+				memcpy(newBlocks, blocks, sizeof(SEntry*) * numBlocks);
+				asFreeMem(blocks);
+			}
+			blocks = newBlocks;
+			blocks[numBlocks] = (SEntry*)asAllocMem(sizeof(SEntry) * (FIRST_BLOCK_SIZE << numBlocks));
+			numBlocks++;
+		}
+
+		entry = new(GetEntry(numEntries++)) SEntry();
+	}
+
+	entry->key = key;
+	entry->hash = hash;
+	entry->inUse = true;
+	entry->nextFree = 0;
+
+	slots[n].hash = hash;
+	slots[n].entry = entry;
+	numKeys++;
+
+	return entry;
+}
+
+// internal
+void CScriptDictionary::Rehash(asUINT newNumSlots)
+{
+	SSlot *newSlots = (SSlot*)asAllocMem(sizeof(SSlot) * newNumSlots);
+	memset(newSlots, 0, sizeof(SSlot) * newNumSlots);
+
+	asUINT mask = newNumSlots - 1;
+	for( asUINT o = 0; o < numSlots; o++ )
+	{
+		if( slots[o].entry == 0 )
+			continue;
+
+		asUINT n = slots[o].hash & mask;
+		while( newSlots[n].entry )
+			n = (n + 1) & mask;
+		newSlots[n] = slots[o];
+	}
+
+	if( slots )
+		asFreeMem(slots);
+	slots = newSlots;
+	numSlots = newNumSlots;
+}
+
+// internal
+void CScriptDictionary::FreeStorage()
+{
+	// The values must already have been freed
+	for( asUINT n = 0; n < numEntries; n++ )
+		GetEntry(n)->~SEntry();
+
+	for( asUINT b = 0; b < numBlocks; b++ )
+		asFreeMem(blocks[b]);
+	if( blocks )
+		asFreeMem(blocks);
+	if( slots )
+		asFreeMem(slots);
+
+	blocks = 0;
+	numBlocks = 0;
+	numEntries = 0;
+	numKeys = 0;
+	freeEntries = 0;
+	slots = 0;
+	numSlots = 0;
+}
+
+void CScriptDictionary::Reserve(asUINT keys)
+{
+	asUINT newNumSlots = numSlots ? numSlots : (asUINT)MIN_SLOTS;
+	while( keys * 4 > newNumSlots * 3 )
+		newNumSlots *= 2;
+
+	if( newNumSlots != numSlots )
+		Rehash(newNumSlots);
+}
+
 void CScriptDictionary::AddRef() const
 {
 	// We need to clear the GC flag
@@ -179,11 +370,11 @@ bool CScriptDictionary::GetGCFlag()
 void CScriptDictionary::EnumReferences(asIScriptEngine *engine)
 {
 	// Call the gc enum callback for each of the objects
-	map<string, CScriptDictValue>::iterator it;
-	for( it = dict.begin(); it != dict.end(); it++ )
+	for( asUINT n = 0; n < numEntries; n++ )
 	{
-		if( it->second.m_typeId & asTYPEID_MASK_OBJECT )
-			engine->GCEnumCallback(it->second.m_valueObj);
+		SEntry *entry = GetEntry(n);
+		if( entry->inUse && (entry->value.m_typeId & asTYPEID_MASK_OBJECT) )
+			engine->GCEnumCallback(entry->value.m_valueObj);
 	}
 }
 
@@ -200,15 +391,19 @@ CScriptDictionary &CScriptDictionary::operator =(const CScriptDictionary &other)
 	DeleteAll();
 
 	// Do a shallow copy of the dictionary
-	map<string, CScriptDictValue>::const_iterator it;
-	for( it = other.dict.begin(); it != other.dict.end(); it++ )
+	Reserve(other.numKeys);
+	for( asUINT n = 0; n < other.numEntries; n++ )
 	{
-		if( it->second.m_typeId & asTYPEID_OBJHANDLE )
-			Set(it->first, (void*)&it->second.m_valueObj, it->second.m_typeId);
-		else if( it->second.m_typeId & asTYPEID_MASK_OBJECT )
-			Set(it->first, (void*)it->second.m_valueObj, it->second.m_typeId);
+		const SEntry *entry = other.GetEntry(n);
+		if( !entry->inUse )
+			continue;
+
+		if( entry->value.m_typeId & asTYPEID_OBJHANDLE )
+			Set(entry->key, (void*)&entry->value.m_valueObj, entry->value.m_typeId);
+		else if( entry->value.m_typeId & asTYPEID_MASK_OBJECT )
+			Set(entry->key, (void*)entry->value.m_valueObj, entry->value.m_typeId);
 		else
-			Set(it->first, (void*)&it->second.m_valueInt, it->second.m_typeId);
+			Set(entry->key, (void*)&entry->value.m_valueInt, entry->value.m_typeId);
 	}
 
 	return *this;
@@ -217,21 +412,15 @@ CScriptDictionary &CScriptDictionary::operator =(const CScriptDictionary &other)
 CScriptDictValue *CScriptDictionary::operator[](const string &key)
 {
 	// Return the existing value if it exists, else insert an empty value
-	map<string, CScriptDictValue>::iterator it;
-	it = dict.find(key);
-	if( it == dict.end() )
-		it = dict.insert(map<string, CScriptDictValue>::value_type(key, CScriptDictValue())).first;
-	
-	return &it->second;
+	return &Insert(key)->value;
 }
 
 const CScriptDictValue *CScriptDictionary::operator[](const string &key) const
 {
 	// Return the existing value if it exists
-	map<string, CScriptDictValue>::const_iterator it;
-	it = dict.find(key);
-	if( it != dict.end() )
-		return &it->second;
+	SEntry *entry = Find(key);
+	if( entry )
+		return &entry->value;
 
 	// Else raise an exception
 	asIScriptContext *ctx = asGetActiveContext();
@@ -243,12 +432,7 @@ const CScriptDictValue *CScriptDictionary::operator[](const string &key) const
 
 void CScriptDictionary::Set(const string &key, void *value, int typeId)
 {
-	map<string, CScriptDictValue>::iterator it;
-	it = dict.find(key);
-	if( it == dict.end() )
-		it = dict.insert(map<string, CScriptDictValue>::value_type(key, CScriptDictValue())).first;
-
-	it->second.Set(engine, value, typeId);
+	Insert(key)->value.Set(engine, value, typeId);
 }
 
 // This overloaded method is implemented so that all integer and
@@ -273,10 +457,9 @@ void CScriptDictionary::Set(const string &key, const double &value)
 // Returns true if the value was successfully retrieved
 bool CScriptDictionary::Get(const string &key, void *value, int typeId) const
 {
-	map<string, CScriptDictValue>::const_iterator it;
-	it = dict.find(key);
-	if( it != dict.end() )
-		return it->second.Get(engine, value, typeId);
+	SEntry *entry = Find(key);
+	if( entry )
+		return entry->value.Get(engine, value, typeId);
 
 	// AngelScript has already initialized the value with a default value,
 	// so we don't have to do anything if we don't find the element, or if 
@@ -288,10 +471,9 @@ bool CScriptDictionary::Get(const string &key, void *value, int typeId) const
 // Returns the type id of the stored value
 int CScriptDictionary::GetTypeId(const string &key) const
 {
-	map<string, CScriptDictValue>::const_iterator it;
-	it = dict.find(key);
-	if( it != dict.end() )
-		return it->second.m_typeId;
+	SEntry *entry = Find(key);
+	if( entry )
+		return entry->value.m_typeId;
 
 	return -1;
 }
@@ -308,17 +490,12 @@ bool CScriptDictionary::Get(const string &key, double &value) const
 
 bool CScriptDictionary::Exists(const string &key) const
 {
-	map<string, CScriptDictValue>::const_iterator it;
-	it = dict.find(key);
-	if( it != dict.end() )
-		return true;
-
-	return false;
+	return Find(key) != 0;
 }
 
 bool CScriptDictionary::IsEmpty() const
 {
-	if( dict.size() == 0 )
+	if( numKeys == 0 )
 		return true;
 
 	return false;
@@ -326,27 +503,63 @@ bool CScriptDictionary::IsEmpty() const
 
 asUINT CScriptDictionary::GetSize() const
 {
-	return asUINT(dict.size());
+	return numKeys;
 }
 
 void CScriptDictionary::Delete(const string &key)
 {
-	map<string, CScriptDictValue>::iterator it;
-	it = dict.find(key);
-	if( it != dict.end() )
+	if( numKeys == 0 )
+		return;
+
+	asUINT hash = HashKey(key);
+	asUINT mask = numSlots - 1;
+	asUINT n = hash & mask;
+	for( ; slots[n].entry; n = (n + 1) & mask )
 	{
-		it->second.FreeValue(engine);
-		dict.erase(it);
+		if( slots[n].hash == hash && slots[n].entry->key == key )
+			break;
 	}
+
+	SEntry *entry = slots[n].entry;
+	if( entry == 0 )
+		return;
+
+	// Shift the following slots of the probe sequence back so no tombstone is needed
+	asUINT free = n;
+	for( asUINT i = (n + 1) & mask; slots[i].entry; i = (i + 1) & mask )
+	{
+		// Move the slot unless its home slot lies cyclically in (free, i]
+		asUINT home = slots[i].hash & mask;
+		if( free <= i ? (home <= free || home > i) : (home <= free && home > i) )
+		{
+			slots[free] = slots[i];
+			free = i;
+		}
+	}
+	slots[free].entry = 0;
+
+	// Put the entry on the free list so it is reused by the next insert
+	entry->value.FreeValue(engine);
+	entry->value.m_typeId = 0;
+	entry->key.clear();
+	entry->inUse = false;
+	entry->nextFree = freeEntries;
+	freeEntries = entry;
+	numKeys--;
 }
 
 void CScriptDictionary::DeleteAll()
 {
-	map<string, CScriptDictValue>::iterator it;
-	for( it = dict.begin(); it != dict.end(); it++ )
-		it->second.FreeValue(engine);
+	// Values may release objects that access the dictionary, so all
+	// values are freed before the storage is released
+	for( asUINT n = 0; n < numEntries; n++ )
+	{
+		SEntry *entry = GetEntry(n);
+		if( entry->inUse )
+			entry->value.FreeValue(engine);
+	}
 
-	dict.clear();
+	FreeStorage();
 }
 
 CScriptArray* CScriptDictionary::GetKeys() const
@@ -359,13 +572,13 @@ CScriptArray* CScriptDictionary::GetKeys() const
 	asIObjectType *ot = engine->GetObjectTypeByDecl("array<string>");
 
 	// Create the array object
-	CScriptArray *array = CScriptArray::Create(ot, asUINT(dict.size()));
-	long current = -1;
-	std::map<string, CScriptDictValue>::const_iterator it;
-	for( it = dict.begin(); it != dict.end(); it++ )
+	CScriptArray *array = CScriptArray::Create(ot, numKeys);
+	asUINT current = 0;
+	for( asUINT n = 0; n < numEntries; n++ )
 	{
-		current++;
-		*(string*)array->At(current) = it->first;
+		const SEntry *entry = GetEntry(n);
+		if( entry->inUse )
+			*(string*)array->At(current++) = entry->key;
 	}
 
 	return array;
@@ -477,6 +690,13 @@ void ScriptDictionaryGetSize_Generic(asIScriptGeneric *gen)
 	*(asUINT*)gen->GetAddressOfReturnLocation() = ret;
 }
 
+void ScriptDictionaryReserve_Generic(asIScriptGeneric *gen)
+{
+	CScriptDictionary *dict = (CScriptDictionary*)gen->GetObject();
+	asUINT numKeys = gen->GetArgDWord(0);
+	dict->Reserve(numKeys);
+}
+
 void ScriptDictionaryDelete_Generic(asIScriptGeneric *gen)
 {
 	CScriptDictionary *dict = (CScriptDictionary*)gen->GetObject();
@@ -901,6 +1121,7 @@ void RegisterScriptDictionary_Native(asIScriptEngine *engine)
 	r = engine->RegisterObjectMethod("dictionary", "bool exists(const string &in) const", asMETHOD(CScriptDictionary,Exists), asCALL_THISCALL); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "bool isEmpty() const", asMETHOD(CScriptDictionary, IsEmpty), asCALL_THISCALL); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "uint getSize() const", asMETHOD(CScriptDictionary, GetSize), asCALL_THISCALL); assert( r >= 0 );
+	r = engine->RegisterObjectMethod("dictionary", "void reserve(uint)", asMETHOD(CScriptDictionary, Reserve), asCALL_THISCALL); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "void delete(const string &in)", asMETHOD(CScriptDictionary,Delete), asCALL_THISCALL); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "void deleteAll()", asMETHOD(CScriptDictionary,DeleteAll), asCALL_THISCALL); assert( r >= 0 );
 
@@ -964,6 +1185,7 @@ void RegisterScriptDictionary_Generic(asIScriptEngine *engine)
 	r = engine->RegisterObjectMethod("dictionary", "bool exists(const string &in) const", asFUNCTION(ScriptDictionaryExists_Generic), asCALL_GENERIC); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "bool isEmpty() const", asFUNCTION(ScriptDictionaryIsEmpty_Generic), asCALL_GENERIC); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "uint getSize() const", asFUNCTION(ScriptDictionaryGetSize_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterObjectMethod("dictionary", "void reserve(uint)", asFUNCTION(ScriptDictionaryReserve_Generic), asCALL_GENERIC); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "void delete(const string &in)", asFUNCTION(ScriptDictionaryDelete_Generic), asCALL_GENERIC); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("dictionary", "void deleteAll()", asFUNCTION(ScriptDictionaryDeleteAll_Generic), asCALL_GENERIC); assert( r >= 0 );
 
@@ -985,28 +1207,35 @@ void RegisterScriptDictionary_Generic(asIScriptEngine *engine)
 
 CScriptDictionary::CIterator CScriptDictionary::begin() const
 {
-	return CIterator(*this, dict.begin());
+	asUINT n = 0;
+	while( n < numEntries && !GetEntry(n)->inUse )
+		n++;
+
+	return CIterator(*this, n);
 }
 
 CScriptDictionary::CIterator CScriptDictionary::end() const
 {
-	return CIterator(*this, dict.end());
+	return CIterator(*this, numEntries);
 }
 
 CScriptDictionary::CIterator::CIterator(
 		const CScriptDictionary &dict,
-		std::map<std::string, CScriptDictValue>::const_iterator it)
-	: m_it(it), m_dict(dict)
+		asUINT index)
+	: m_index(index), m_dict(dict)
 {}
 
 void CScriptDictionary::CIterator::operator++() 
 { 
-	++m_it; 
+	// Skip the entries that have been freed
+	do
+		m_index++;
+	while( m_index < m_dict.numEntries && !m_dict.GetEntry(m_index)->inUse );
 }
 
 void CScriptDictionary::CIterator::operator++(int) 
 { 
-	++m_it;
+	++(*this);
 
 	// Normally the post increment would return a copy of the object with the original state,
 	// but it is rarely used so we skip this extra copy to avoid unnecessary overhead
@@ -1019,37 +1248,37 @@ CScriptDictionary::CIterator &CScriptDictionary::CIterator::operator*()
 
 bool CScriptDictionary::CIterator::operator==(const CIterator &other) const 
 { 
-	return m_it == other.m_it;
+	return m_index == other.m_index;
 }
 
 bool CScriptDictionary::CIterator::operator!=(const CIterator &other) const 
 { 
-	return m_it != other.m_it; 
+	return m_index != other.m_index; 
 }
 
 const std::string &CScriptDictionary::CIterator::GetKey() const 
 { 
-	return m_it->first; 
+	return m_dict.GetEntry(m_index)->key; 
 }
 
 int CScriptDictionary::CIterator::GetTypeId() const
 { 
-	return m_it->second.m_typeId; 
+	return m_dict.GetEntry(m_index)->value.m_typeId; 
 }
 
 bool CScriptDictionary::CIterator::GetValue(asINT64 &value) const
 { 
-	return m_it->second.Get(m_dict.engine, &value, asTYPEID_INT64); 
+	return m_dict.GetEntry(m_index)->value.Get(m_dict.engine, &value, asTYPEID_INT64); 
 }
 
 bool CScriptDictionary::CIterator::GetValue(double &value) const
 { 
-	return m_it->second.Get(m_dict.engine, &value, asTYPEID_DOUBLE); 
+	return m_dict.GetEntry(m_index)->value.Get(m_dict.engine, &value, asTYPEID_DOUBLE); 
 }
 
 bool CScriptDictionary::CIterator::GetValue(void *value, int typeId) const
 { 
-	return m_it->second.Get(m_dict.engine, value, typeId); 
+	return m_dict.GetEntry(m_index)->value.Get(m_dict.engine, value, typeId); 
 }
 
 END_AS_NAMESPACE
@@ -17,8 +17,6 @@
 #pragma warning (disable:4786)
 #endif
 
-#include <map>
-
 // Sometimes it may be desired to use the same method names as used by C++ STL.
 // This may for example reduce time when converting code from script to C++ or
 // back.
@@ -119,6 +117,9 @@ public:
 	// Returns the number of key/value pairs in the dictionary
 	asUINT GetSize() const;
 
+	// Allocates room for the given number of keys so they can be added without rehashing
+	void Reserve(asUINT numKeys);
+
 	// Deletes the key
 	void Delete(const std::string &key);
 
@@ -153,12 +154,11 @@ public:
 		friend class CScriptDictionary;
 
 		CIterator();
-		CIterator(const CScriptDictionary &dict,
-		          std::map<std::string, CScriptDictValue>::const_iterator it);
+		CIterator(const CScriptDictionary &dict, asUINT index);
 
 		CIterator &operator=(const CIterator &) {return *this;} // Not used
 
-		std::map<std::string, CScriptDictValue>::const_iterator m_it;
+		asUINT m_index;
 		const CScriptDictionary &m_dict;
 	};
 
@@ -182,14 +182,49 @@ protected:
 	// We don't want anyone to call the destructor directly, it should be called through the Release method
 	virtual ~CScriptDictionary();
 	
+	// The key/value pairs are stored in blocks that are never moved, so the
+	// pointer returned by operator[] stays valid until that key is deleted. The
+	// blocks double in size, block n holds FIRST_BLOCK_SIZE << n entries.
+	// Entries are iterated in the order they were added, except that entries
+	// freed by Delete are reused by the following inserts
+	struct SEntry
+	{
+		std::string       key;
+		CScriptDictValue  value;
+		asUINT            hash;
+		bool              inUse;
+		SEntry           *nextFree;
+	};
+
+	// Open addressing hash table with linear probing. The hash is kept
+	// in the slot so most mismatches never touch the entry
+	struct SSlot
+	{
+		asUINT  hash;
+		SEntry *entry; // 0 if the slot is empty
+	};
+
+	enum { FIRST_BLOCK_SHIFT = 3, FIRST_BLOCK_SIZE = 1 << FIRST_BLOCK_SHIFT, MIN_SLOTS = 16 };
+
+	static asUINT HashKey(const std::string &key);
+	SEntry *GetEntry(asUINT index) const;
+	SEntry *Find(const std::string &key) const;
+	SEntry *Insert(const std::string &key);
+	void    Rehash(asUINT numSlots);
+	void    FreeStorage();
+
 	// Our properties
 	asIScriptEngine *engine;
 	mutable int refCount;
 	mutable bool gcFlag;
 
-	// TODO: memory: The allocator should use the asAllocMem and asFreeMem
-	// TODO: optimize: Use C++11 std::unordered_map instead
-	std::map<std::string, CScriptDictValue> dict;
+	SEntry **blocks;
+	asUINT   numBlocks;
+	asUINT   numEntries; // Entries that have been constructed, in use or not
+	asUINT   numKeys;
+	SEntry  *freeEntries;
+	SSlot   *slots;
+	asUINT   numSlots;   // Always 0 or a power of 2
 };
 
 // This function will determine the configuration of the engine
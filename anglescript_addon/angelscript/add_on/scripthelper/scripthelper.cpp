@@ -12,7 +12,7 @@ BEGIN_AS_NAMESPACE
 int CompareRelation(asIScriptEngine *engine, void *lobj, void *robj, int typeId, int &result)
 {
     // TODO: If a lot of script objects are going to be compared, e.g. when sorting an array,
-    //       then the method id and context should be cached between calls.
+    //       then the method id should be cached between calls.
 
 	int retval = -1;
 	asIScriptFunction *func = 0;
@@ -48,7 +48,7 @@ int CompareRelation(asIScriptEngine *engine, void *lobj, void *robj, int typeId,
 	if( func )
 	{
 		// Call the method
-		asIScriptContext *ctx = engine->CreateContext();
+		asIScriptContext *ctx = engine->RequestContext();
 		ctx->Prepare(func);
 		ctx->SetObject(lobj);
 		ctx->SetArgAddress(0, robj);
@@ -60,7 +60,7 @@ int CompareRelation(asIScriptEngine *engine, void *lobj, void *robj, int typeId,
 			// The comparison was successful
 			retval = 0;
 		}
-		ctx->Release();
+		engine->ReturnContext(ctx);
 	}
 
 	return retval;
@@ -69,7 +69,7 @@ int CompareRelation(asIScriptEngine *engine, void *lobj, void *robj, int typeId,
 int CompareEquality(asIScriptEngine *engine, void *lobj, void *robj, int typeId, bool &result)
 {
     // TODO: If a lot of script objects are going to be compared, e.g. when searching for an
-	//       entry in a set, then the method and context should be cached between calls.
+	//       entry in a set, then the method should be cached between calls.
 
 	int retval = -1;
 	asIScriptFunction *func = 0;
@@ -105,7 +105,7 @@ int CompareEquality(asIScriptEngine *engine, void *lobj, void *robj, int typeId,
 	if( func )
 	{
 		// Call the method
-		asIScriptContext *ctx = engine->CreateContext();
+		asIScriptContext *ctx = engine->RequestContext();
 		ctx->Prepare(func);
 		ctx->SetObject(lobj);
 		ctx->SetArgAddress(0, robj);
@@ -117,7 +117,7 @@ int CompareEquality(asIScriptEngine *engine, void *lobj, void *robj, int typeId,
 			// The comparison was successful
 			retval = 0;
 		}
-		ctx->Release();
+		engine->ReturnContext(ctx);
 	}
 	else
 	{
@@ -169,12 +169,12 @@ int ExecuteString(asIScriptEngine *engine, const char *code, void *ref, int refT
 		return r;
 
 	// If no context was provided, request a new one from the engine
-	asIScriptContext *execCtx = ctx ? ctx : engine->CreateContext();
+	asIScriptContext *execCtx = ctx ? ctx : engine->RequestContext();
 	r = execCtx->Prepare(func);
 	if( r < 0 )
 	{
 		func->Release();
-		if( !ctx ) execCtx->Release();
+		if( !ctx ) engine->ReturnContext(execCtx);
 		return r;
 	}
 
@@ -206,7 +206,7 @@ int ExecuteString(asIScriptEngine *engine, const char *code, void *ref, int refT
 
 	// Clean up
 	func->Release();
-	if( !ctx ) execCtx->Release();
+	if( !ctx ) engine->ReturnContext(execCtx);
 
 	return r;
 }
@@ -627,6 +627,8 @@ int ConfigEngineFromStream(asIScriptEngine *engine, istream &strm, const char *c
 			case asEP_INIT_GLOBAL_VARS_AFTER_BUILD:
 			case asEP_EXPAND_DEF_ARRAY_TO_TMPL:
 			case asEP_AUTO_GARBAGE_COLLECT:
+			case asEP_GC_WORKER_THREADS:
+			case asEP_GC_PROMOTION_THRESHOLD:
 				// These don't affect the compiler, so there is no need to export them
 				break;
 			}
@@ -915,4 +917,49 @@ string GetExceptionInfo(asIScriptContext *ctx, bool showStack)
 	return text.str();
 }
 
+int WriteGCStatisticsToStream(asIScriptEngine *engine, ostream &strm)
+{
+	if( engine == 0 )
+		return asINVALID_ARG;
+
+	asUINT currentSize, totalDestroyed, totalDetected, newObjects, totalNewDestroyed;
+	engine->GetGCStatistics(&currentSize, &totalDestroyed, &totalDetected, &newObjects, &totalNewDestroyed);
+
+	strm << "// Garbage collector\n";
+	strm << "current size " << currentSize << " (new objects " << newObjects << ")\n";
+	strm << "destroyed " << totalDestroyed << " (new objects " << totalNewDestroyed << ")\n";
+	strm << "detected " << totalDetected << "\n";
+	strm << "promotion threshold " << engine->GetEngineProperty(asEP_GC_PROMOTION_THRESHOLD) << "\n";
+
+	// The types are only listed if they have had objects in the garbage collector
+	strm << "// Object types\n";
+	for( asUINT n = 0; ; n++ )
+	{
+		asIObjectType *ot = engine->GetGCObjectTypeByIndex(n);
+		if( ot == 0 )
+			break;
+
+		asUINT created, destroyedYoung, promoted, destroyedOld, detected;
+		ot->GetGCStatistics(&created, &destroyedYoung, &promoted, &destroyedOld, &detected);
+
+		// The declaration is used for the template instances so the subtypes are shown
+		if( ot->GetFlags() & asOBJ_TEMPLATE )
+			strm << engine->GetTypeDeclaration(ot->GetTypeId()) << ":";
+		else if( ot->GetNamespace()[0] )
+			strm << ot->GetNamespace() << "::" << ot->GetName() << ":";
+		else
+			strm << ot->GetName() << ":";
+		strm << " created " << created;
+		strm << ", destroyed young " << destroyedYoung;
+		strm << ", promoted " << promoted;
+		strm << ", destroyed old " << destroyedOld;
+		strm << ", detected " << detected;
+		if( ot->GetGCPromotionThreshold() >= 0 )
+			strm << ", promotion threshold " << ot->GetGCPromotionThreshold();
+		strm << "\n";
+	}
+
+	return asSUCCESS;
+}
+
 END_AS_NAMESPACE
@@ -43,6 +43,11 @@ int ConfigEngineFromStream(asIScriptEngine *engine, std::istream &strm, const ch
 // Format the details of the script exception into a human readable text
 std::string GetExceptionInfo(asIScriptContext *ctx, bool showStack = false);
 
+// Write the garbage collector's statistics, and the counters for each object type that 
+// has had objects in the garbage collector, to a text stream. This can be used to see 
+// which types churn the garbage collector when tuning the promotion thresholds.
+int WriteGCStatisticsToStream(asIScriptEngine *engine, std::ostream &strm);
+
 END_AS_NAMESPACE
 
 #endif
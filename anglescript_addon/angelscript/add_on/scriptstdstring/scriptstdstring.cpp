@@ -5,7 +5,10 @@
 #include <stdio.h>	// sprintf()
 #include <stdlib.h> // strtod()
 #include <locale.h> // setlocale()
-#include <map>      // std::map
+#include <vector>   // std::vector
+#if defined(_MSC_VER)
+#include <intrin.h> // _ReadWriteBarrier()
+#endif
 
 using namespace std;
 
@@ -31,79 +34,193 @@ const asPWORD STRING_POOL = 1001;
 // IwGxInit() and finished with IwGxTerminate().
 static const string emptyString;
 
-static const string &StringFactory(asUINT length, const char *s)
+// Makes sure all earlier writes are visible before the following ones. The
+// pool only needs this when publishing, the readers rely on data dependency
+static inline void PublishBarrier()
 {
-	// Each engine instance has its own string pool
-	asIScriptContext *ctx = asGetActiveContext();
-	if( ctx == 0 )
+#if defined(_MSC_VER)
+	// MSVC only targets x86/x64 here, which doesn't reorder stores
+	_ReadWriteBarrier();
+#elif defined(__GNUC__)
+	__sync_synchronize();
+#endif
+}
+
+// The engine passes its own copy of the string constant to the factory. That
+// copy is unique for each constant and never moves while the engine lives, so
+// the pool is keyed on the pointer only. Lookups take no lock: an entry is
+// only put in a slot after it is fully constructed and a grown table is only
+// published after all entries were copied. Replaced tables are kept until the
+// pool is destroyed, since a reader may still be probing them.
+class CStdStringPool
+{
+public:
+	CStdStringPool() : table(0) {}
+
+	~CStdStringPool()
 	{
-		// The string factory can only be called from a script
-		assert( ctx );
-		return emptyString;
+		if( table )
+		{
+			for( asUINT n = 0; n <= table->mask; n++ )
+				if( table->slots[n] )
+					delete table->slots[n];
+			FreeTable(table);
+		}
+		for( asUINT n = 0; n < retired.size(); n++ )
+			FreeTable(retired[n]);
+	}
+
+	const string &Get(asUINT length, const char *s)
+	{
+		STable *t = table;
+		if( t )
+		{
+			for( asUINT n = Hash(s) & t->mask; ; n = (n + 1) & t->mask )
+			{
+				SEntry *entry = t->slots[n];
+				if( entry == 0 )
+					break;
+				if( entry->key == s )
+					return entry->str;
+			}
+		}
+
+		return Add(length, s);
+	}
+
+protected:
+	struct SEntry
+	{
+		SEntry(const char *s, asUINT length) : key(s), str(s, length) {}
+
+		const char *key;
+		string      str;
+	};
+
+	struct STable
+	{
+		asUINT           mask;
+		asUINT           count;
+		SEntry *volatile slots[1];
+	};
+
+	static asUINT Hash(const char *s)
+	{
+		asPWORD p = reinterpret_cast<asPWORD>(s);
+		return asUINT((p ^ (p >> 16)) * 0x9E3779B1u);
+	}
+
+	static STable *AllocTable(asUINT size)
+	{
+		STable *t = reinterpret_cast<STable*>(asAllocMem(sizeof(STable) + sizeof(SEntry*) * (size - 1)));
+		if( t )
+		{
+			t->mask = size - 1;
+			t->count = 0;
+			memset((void*)t->slots, 0, sizeof(SEntry*) * size);
+		}
+		return t;
 	}
-	asIScriptEngine *engine = ctx->GetEngine();
 
-	// TODO: runtime optimize: Use unordered_map if C++11 is supported, i.e. MSVC10+, gcc 4.?+
-	map<const char *, string> *pool = reinterpret_cast< map<const char *, string>* >(engine->GetUserData(STRING_POOL));
+	static void FreeTable(STable *t)
+	{
+		asFreeMem(t);
+	}
+
+	static void Place(STable *t, SEntry *entry)
+	{
+		asUINT n = Hash(entry->key) & t->mask;
+		while( t->slots[n] )
+			n = (n + 1) & t->mask;
+
+		// The entry must be complete before other threads can find it
+		PublishBarrier();
+		t->slots[n] = entry;
+		t->count++;
+	}
 
-	if( !pool )
+	const string &Add(asUINT length, const char *s)
 	{
-		// The string pool hasn't been created yet, so we'll create it now
+		// Adding is only done the first time each constant is used
 		asAcquireExclusiveLock();
 
-		// Make sure the string pool wasn't created while we were waiting for the lock
-		pool = reinterpret_cast< map<const char *, string>* >(engine->GetUserData(STRING_POOL));
-		if( !pool )
+		// Make sure the string wasn't added while we were waiting for the lock
+		STable *t = table;
+		if( t )
 		{
-			#if defined(__S3E__)
-			pool = new map<const char *, string>;
-			#else
-			pool = new (nothrow) map<const char *, string>;
-			#endif
-			if( pool == 0 )
+			for( asUINT n = Hash(s) & t->mask; t->slots[n]; n = (n + 1) & t->mask )
 			{
-				ctx->SetException("Out of memory");
-				asReleaseExclusiveLock();
-				return emptyString;
+				if( t->slots[n]->key == s )
+				{
+					asReleaseExclusiveLock();
+					return t->slots[n]->str;
+				}
 			}
-			engine->SetUserData(pool, STRING_POOL);
 		}
 
+		// Keep the table at most half full
+		if( t == 0 || (t->count + 1) * 2 > t->mask + 1 )
+		{
+			STable *grown = AllocTable(t ? (t->mask + 1) * 2 : 64);
+			if( grown == 0 )
+				return OutOfMemory();
+
+			if( t )
+			{
+				for( asUINT n = 0; n <= t->mask; n++ )
+					if( t->slots[n] )
+						Place(grown, t->slots[n]);
+				retired.push_back(t);
+			}
+
+			PublishBarrier();
+			table = t = grown;
+		}
+
+		#if defined(__S3E__)
+		SEntry *entry = new SEntry(s, length);
+		#else
+		SEntry *entry = new (nothrow) SEntry(s, length);
+		#endif
+		if( entry == 0 )
+			return OutOfMemory();
+
+		Place(t, entry);
+
 		asReleaseExclusiveLock();
+		return entry->str;
 	}
 
-	// We can't let other threads modify the pool while we query it
-	asAcquireSharedLock();
-
-	// First check if a string object hasn't been created already
-	map<const char *, string>::iterator it;
-	it = pool->find(s);
-	if( it != pool->end() )
+	const string &OutOfMemory()
 	{
-		asReleaseSharedLock();
-		return it->second;
-	}
+		asReleaseExclusiveLock();
 
-	asReleaseSharedLock();
+		asIScriptContext *ctx = asGetActiveContext();
+		if( ctx )
+			ctx->SetException("Out of memory");
+		return emptyString;
+	}
 
-	// Acquire an exclusive lock so we can add the new string to the pool
-	asAcquireExclusiveLock();
+	STable *volatile table;
+	vector<STable*>  retired;
+};
 
-	// Make sure the string wasn't created while we were waiting for the exclusive lock
-	it = pool->find(s);
-	if( it == pool->end() )
+static CStdStringPool *CreateEngineStringPool(asIScriptEngine *engine)
+{
+	// The pool is created when registering the string type, so
+	// it is not possible for scripts to run at the same time
+	CStdStringPool *pool = reinterpret_cast<CStdStringPool*>(engine->GetUserData(STRING_POOL));
+	if( pool == 0 )
 	{
-		// Create a new string object
-		it = pool->insert(map<const char *, string>::value_type(s, string(s, length))).first;
+		pool = new CStdStringPool;
+		engine->SetUserData(pool, STRING_POOL);
 	}
-
-	asReleaseExclusiveLock();
-	return it->second;
+	return pool;
 }
 
 static void CleanupEngineStringPool(asIScriptEngine *engine)
 {
-	map<const char *, string> *pool = reinterpret_cast< map<const char *, string>* >(engine->GetUserData(STRING_POOL));
+	CStdStringPool *pool = reinterpret_cast<CStdStringPool*>(engine->GetUserData(STRING_POOL));
 	if( pool )
 		delete pool;
 }
@@ -537,8 +654,8 @@ void RegisterStdString_Native(asIScriptEngine *engine)
 	r = engine->RegisterObjectType("string", sizeof(string), asOBJ_VALUE | asOBJ_APP_CLASS_CDAK); assert( r >= 0 );
 
 #if AS_USE_STRINGPOOL == 1
-	// Register the string factory
-	r = engine->RegisterStringFactory("const string &", asFUNCTION(StringFactory), asCALL_CDECL); assert( r >= 0 );
+	// Register the string factory as a method on the engine's string pool
+	r = engine->RegisterStringFactory("const string &", asMETHOD(CStdStringPool, Get), asCALL_THISCALL_ASGLOBAL, CreateEngineStringPool(engine)); assert( r >= 0 );
 
 	// Register the cleanup callback for the string pool
 	engine->SetEngineUserDataCleanupCallback(CleanupEngineStringPool, STRING_POOL);
@@ -634,8 +751,20 @@ static void StringFactoryGeneric(asIScriptGeneric *gen)
   asUINT length = gen->GetArgDWord(0);
   const char *s = (const char*)gen->GetArgAddress(1);
 
+  // The generic calling convention has no object for the factory, so the
+  // pool is found through the engine of the calling script
+  asIScriptContext *ctx = asGetActiveContext();
+  if( ctx == 0 )
+  {
+    // The string factory can only be called from a script
+    assert( ctx );
+    gen->SetReturnAddress(const_cast<string*>(&emptyString));
+    return;
+  }
+  CStdStringPool *pool = reinterpret_cast<CStdStringPool*>(ctx->GetEngine()->GetUserData(STRING_POOL));
+
   // Return a reference to a string
-  gen->SetReturnAddress(const_cast<string*>(&StringFactory(length, s)));
+  gen->SetReturnAddress(const_cast<string*>(&pool->Get(length, s)));
 }
 #else
 static void StringFactoryGeneric(asIScriptGeneric *gen)
@@ -973,6 +1102,7 @@ void RegisterStdString_Generic(asIScriptEngine *engine)
 
 #if AS_USE_STRINGPOOL == 1
 	// Register the string factory
+	CreateEngineStringPool(engine);
 	r = engine->RegisterStringFactory("const string &", asFUNCTION(StringFactoryGeneric), asCALL_GENERIC); assert( r >= 0 );
 
 	// Register the cleanup callback for the string pool
@@ -135,6 +135,8 @@ enum asEEngineProp
 	asEP_DISALLOW_VALUE_ASSIGN_FOR_REF_TYPE = 20,
 	asEP_ALTER_SYNTAX_NAMED_ARGS            = 21,
 	asEP_DISABLE_INTEGER_DIVISION           = 22,
+	asEP_GC_WORKER_THREADS                  = 23,
+	asEP_GC_PROMOTION_THRESHOLD             = 24,
 
 	asEP_LAST_PROPERTY
 };
@@ -267,7 +269,8 @@ enum asEGCFlags
 	asGC_FULL_CYCLE      = 1,
 	asGC_ONE_STEP        = 2,
 	asGC_DESTROY_GARBAGE = 4,
-	asGC_DETECT_GARBAGE  = 8
+	asGC_DETECT_GARBAGE  = 8,
+	asGC_TIME_BUDGET     = 16  // numIterations is the maximum time in microseconds
 };
 
 // Token classes
@@ -560,6 +563,12 @@ extern "C"
 	AS_API void *asAllocMem(size_t size);
 	AS_API void  asFreeMem(void *mem);
 
+	// Pooled allocator with size classes and per-thread caches. Register
+	// it with asSetGlobalMemoryFunctions before the engine is created
+	AS_API void *asSlabAlloc(size_t size);
+	AS_API void  asSlabFree(void *mem);
+	AS_API int   asGetSlabStatistics(asUINT sizeClass, asUINT *blockSize, asUINT *reservedBytes, asUINT *freeBlocks);
+
 	// Auxiliary
 	AS_API asILockableSharedBool *asCreateLockableSharedBool();
 }
@@ -753,8 +762,10 @@ public:
 	// Garbage collection
 	virtual int  GarbageCollect(asDWORD flags = asGC_FULL_CYCLE, asUINT numIterations = 1) = 0;
 	virtual void GetGCStatistics(asUINT *currentSize, asUINT *totalDestroyed = 0, asUINT *totalDetected = 0, asUINT *newObjects = 0, asUINT *totalNewDestroyed = 0) const = 0;
+	virtual void GetGCPauseStatistics(asUINT *pauseCount, asQWORD *totalMicroseconds = 0, asUINT *maxMicroseconds = 0, asUINT *histogram = 0, asUINT histogramSize = 0) const = 0;
 	virtual int  NotifyGarbageCollectorOfNewObject(void *obj, asIObjectType *type) = 0;
 	virtual int  GetObjectInGC(asUINT idx, asUINT *seqNbr = 0, void **obj = 0, asIObjectType **type = 0) = 0;
+	virtual asIObjectType *GetGCObjectTypeByIndex(asUINT index) const = 0;
 	virtual void GCEnumCallback(void *reference) = 0;
 
 	// User data
@@ -840,6 +851,10 @@ public:
 	// Byte code saving and loading
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped = 0) = 0;
+	// The image loads faster, e.g. from a memory mapped file, but only with the same library version and
+	// pointer size and byte order. The buffer may also hold the SaveByteCode format, and isn't kept after loading
+	virtual int SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
+	virtual int LoadByteCodeImage(const void *image, asUINT size, bool *wasDebugInfoStripped = 0) = 0;
 
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type = 0) = 0;
@@ -906,6 +921,8 @@ public:
 	// Debugging
 	virtual int                SetLineCallback(asSFuncPtr callback, void *obj, int callConv) = 0;
 	virtual void               ClearLineCallback() = 0;
+	virtual int                SetBreakpointCallback(asSFuncPtr callback, void *obj, int callConv) = 0;
+	virtual void               ClearBreakpointCallback() = 0;
 	virtual asUINT             GetCallstackSize() const = 0;
 	virtual asIScriptFunction *GetFunction(asUINT stackLevel = 0) = 0;
 	virtual int                GetLineNumber(asUINT stackLevel = 0, int *column = 0, const char **sectionName = 0) = 0;
@@ -1040,6 +1057,16 @@ public:
 	virtual asUINT             GetBehaviourCount() const = 0;
 	virtual asIScriptFunction *GetBehaviourByIndex(asUINT index, asEBehaviours *outBehaviour) const = 0;
 
+	// Memory statistics, only counted while asSlabAlloc is the allocator
+	virtual void             GetMemoryStatistics(asUINT *allocCount, asUINT *liveCount) const = 0;
+
+	// Garbage collector statistics. The promotion threshold is the number of sweeps over the new objects 
+	// that an object must survive before it is moved to the old objects. A negative value uses the engine 
+	// property asEP_GC_PROMOTION_THRESHOLD
+	virtual void             GetGCStatistics(asUINT *created, asUINT *destroyedYoung = 0, asUINT *promoted = 0, asUINT *destroyedOld = 0, asUINT *detected = 0) const = 0;
+	virtual void             SetGCPromotionThreshold(int sweeps) = 0;
+	virtual int              GetGCPromotionThreshold() const = 0;
+
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type = 0) = 0;
 	virtual void *GetUserData(asPWORD type = 0) const = 0;
@@ -1099,6 +1126,7 @@ public:
 	virtual int              GetVar(asUINT index, const char **name, int *typeId = 0) const = 0;
 	virtual const char      *GetVarDecl(asUINT index, bool includeNamespace = false) const = 0;
 	virtual int              FindNextLineWithCode(int line) const = 0;
+	virtual int              SetBreakpoint(int line, bool enable) = 0;
 
 	// For JIT compilation
 	virtual asDWORD         *GetByteCode(asUINT *length = 0) = 0;
@@ -1534,7 +1562,31 @@ enum asEBCInstr
 	asBC_POWi64			= 198,
 	asBC_POWu64			= 199,
 
-	asBC_MAXBYTECODE	= 200,
+	// Compare and jump. These are only produced by the
+	// bytecode optimizer and replace a compare instruction
+	// followed by a conditional jump
+	asBC_JLTi			= 200,
+	asBC_JLEi			= 201,
+	asBC_JGTi			= 202,
+	asBC_JGEi			= 203,
+	asBC_JEQi			= 204,
+	asBC_JNEi			= 205,
+	asBC_JLTu			= 206,
+	asBC_JLEu			= 207,
+	asBC_JGTu			= 208,
+	asBC_JGEu			= 209,
+	asBC_JLTIi			= 210,
+	asBC_JLEIi			= 211,
+	asBC_JGTIi			= 212,
+	asBC_JGEIi			= 213,
+	asBC_JEQIi			= 214,
+	asBC_JNEIi			= 215,
+	asBC_JLTIu			= 216,
+	asBC_JLEIu			= 217,
+	asBC_JGTIu			= 218,
+	asBC_JGEIu			= 219,
+
+	asBC_MAXBYTECODE	= 220,
 
 	// Temporary tokens. Can't be output to the final program
 	asBC_VarDecl		= 251,
@@ -1567,11 +1619,12 @@ enum asEBCType
 	asBCTYPE_rW_QW_ARG    = 17,
 	asBCTYPE_W_DW_ARG     = 18,
 	asBCTYPE_rW_W_DW_ARG  = 19,
-	asBCTYPE_rW_DW_DW_ARG = 20
+	asBCTYPE_rW_DW_DW_ARG = 20,
+	asBCTYPE_rW_rW_DW_ARG = 21
 };
 
 // Instruction type sizes
-const int asBCTypeSize[21] =
+const int asBCTypeSize[22] =
 {
 	0, // asBCTYPE_INFO
 	1, // asBCTYPE_NO_ARG
@@ -1593,7 +1646,8 @@ const int asBCTypeSize[21] =
 	3, // asBCTYPE_rW_QW_ARG
 	2, // asBCTYPE_W_DW_ARG
 	3, // asBCTYPE_rW_W_DW_ARG
-	3  // asBCTYPE_rW_DW_DW_ARG
+	3, // asBCTYPE_rW_DW_DW_ARG
+	3  // asBCTYPE_rW_rW_DW_ARG
 };
 
 // Instruction info
@@ -1829,26 +1883,27 @@ const asSBCInfo asBCInfo[256] =
 	asBCINFO(POWi64,	wW_rW_rW_ARG,	0),
 	asBCINFO(POWu64,	wW_rW_rW_ARG,	0),
 
-	asBCINFO_DUMMY(200),
-	asBCINFO_DUMMY(201),
-	asBCINFO_DUMMY(202),
-	asBCINFO_DUMMY(203),
-	asBCINFO_DUMMY(204),
-	asBCINFO_DUMMY(205),
-	asBCINFO_DUMMY(206),
-	asBCINFO_DUMMY(207),
-	asBCINFO_DUMMY(208),
-	asBCINFO_DUMMY(209),
-	asBCINFO_DUMMY(210),
-	asBCINFO_DUMMY(211),
-	asBCINFO_DUMMY(212),
-	asBCINFO_DUMMY(213),
-	asBCINFO_DUMMY(214),
-	asBCINFO_DUMMY(215),
-	asBCINFO_DUMMY(216),
-	asBCINFO_DUMMY(217),
-	asBCINFO_DUMMY(218),
-	asBCINFO_DUMMY(219),
+	asBCINFO(JLTi,		rW_rW_DW_ARG,	0),
+	asBCINFO(JLEi,		rW_rW_DW_ARG,	0),
+	asBCINFO(JGTi,		rW_rW_DW_ARG,	0),
+	asBCINFO(JGEi,		rW_rW_DW_ARG,	0),
+	asBCINFO(JEQi,		rW_rW_DW_ARG,	0),
+	asBCINFO(JNEi,		rW_rW_DW_ARG,	0),
+	asBCINFO(JLTu,		rW_rW_DW_ARG,	0),
+	asBCINFO(JLEu,		rW_rW_DW_ARG,	0),
+	asBCINFO(JGTu,		rW_rW_DW_ARG,	0),
+	asBCINFO(JGEu,		rW_rW_DW_ARG,	0),
+	asBCINFO(JLTIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLEIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGTIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGEIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JEQIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JNEIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLTIu,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLEIu,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGTIu,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGEIu,		rW_DW_DW_ARG,	0),
+
 	asBCINFO_DUMMY(220),
 	asBCINFO_DUMMY(221),
 	asBCINFO_DUMMY(222),
@@ -1900,6 +1955,10 @@ const asSBCInfo asBCInfo[256] =
 #define asBC_SWORDARG1(x) (*(((short*)x)+2))
 #define asBC_SWORDARG2(x) (*(((short*)x)+3))
 
+// The SUSPEND instruction doesn't use its argument bytes so the
+// second byte is used to mark the positions that has a breakpoint
+#define asBC_BREAKPOINT_FLAG(x) (*(((asBYTE*)x)+1))
+
 
 END_AS_NAMESPACE
 
@@ -133,7 +133,8 @@ void asCByteCode::GetVarsUsed(asCArray<int> &vars)
 		}
 		else if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
-				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG )
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_DW_ARG )
 		{
 			InsertIfNotExists(vars, curr->wArg[0]);
 			InsertIfNotExists(vars, curr->wArg[1]);
@@ -174,7 +175,8 @@ bool asCByteCode::IsVarUsed(int offset)
 		}
 		else if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
-				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG )
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_DW_ARG )
 		{
 			if( curr->wArg[0] == offset || curr->wArg[1] == offset )
 				return true;
@@ -221,7 +223,8 @@ void asCByteCode::ExchangeVar(int oldOffset, int newOffset)
 				curr->wArg[0] = (short)newOffset;
 		}
 		else if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
-				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG )
+				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_DW_ARG )
 		{
 			if( curr->wArg[0] == oldOffset )
 				curr->wArg[0] = (short)newOffset;
@@ -1167,6 +1170,67 @@ void asCByteCode::Optimize()
 				instr = GoBack(DeleteInstruction(curr));
 		}
 	}
+
+	// This must be the last optimization, as the others don't know about the combined instructions.
+	// JIT compilers may not know about them either so they are not used when JIT instructions are included
+	if( !engine->ep.includeJitInstructions )
+		CombineCompareAndJump();
+}
+
+void asCByteCode::CombineCompareAndJump()
+{
+	TimeIt("asCByteCode::CombineCompareAndJump");
+
+	// Loop conditions and if statements compile to a compare followed by a conditional
+	// jump that tests the result of the compare in the value register. Both are replaced
+	// with a single instruction that compares and jumps, so only one instruction needs
+	// to be dispatched. The value register is not updated, as nothing reads the result
+	// of the compare after the conditional jump
+	asCByteInstruction *curr = first;
+	while( curr )
+	{
+		asCByteInstruction *jmp = curr->next;
+		if( jmp == 0 )
+			break;
+
+		if( (curr->op == asBC_CMPi || curr->op == asBC_CMPu ||
+			 curr->op == asBC_CMPIi || curr->op == asBC_CMPIu) &&
+			(jmp->op == asBC_JZ || jmp->op == asBC_JNZ ||
+			 jmp->op == asBC_JS || jmp->op == asBC_JNS ||
+			 jmp->op == asBC_JP || jmp->op == asBC_JNP) )
+		{
+			// Equality doesn't depend on the sign, so the int instructions are used for uint too
+			asEBCInstr op = asBC_MAXBYTECODE;
+			bool withConst = (curr->op == asBC_CMPIi || curr->op == asBC_CMPIu);
+			bool isUnsigned = (curr->op == asBC_CMPu || curr->op == asBC_CMPIu);
+			switch( jmp->op )
+			{
+			case asBC_JS:  op = withConst ? (isUnsigned ? asBC_JLTIu : asBC_JLTIi) : (isUnsigned ? asBC_JLTu : asBC_JLTi); break;
+			case asBC_JNP: op = withConst ? (isUnsigned ? asBC_JLEIu : asBC_JLEIi) : (isUnsigned ? asBC_JLEu : asBC_JLEi); break;
+			case asBC_JP:  op = withConst ? (isUnsigned ? asBC_JGTIu : asBC_JGTIi) : (isUnsigned ? asBC_JGTu : asBC_JGTi); break;
+			case asBC_JNS: op = withConst ? (isUnsigned ? asBC_JGEIu : asBC_JGEIi) : (isUnsigned ? asBC_JGEu : asBC_JGEi); break;
+			case asBC_JZ:  op = withConst ? asBC_JEQIi : asBC_JEQi; break;
+			case asBC_JNZ: op = withConst ? asBC_JNEIi : asBC_JNEi; break;
+			default: asASSERT(false);
+			}
+
+			// The variables and the constant stay where they are. The label
+			// of the jump is stored after them
+			int label = *((int*)ARG_DW(jmp->arg));
+			if( withConst )
+				*((int*)ARG_DW(curr->arg)+1) = label;
+			else
+				*((int*)ARG_DW(curr->arg)) = label;
+
+			curr->op       = op;
+			curr->size     = asBCTypeSize[asBCInfo[op].type];
+			curr->stackInc = asBCInfo[op].stackInc;
+
+			DeleteInstruction(jmp);
+		}
+
+		curr = curr->next;
+	}
 }
 
 bool asCByteCode::IsTempVarReadByInstr(asCByteInstruction *curr, int offset)
@@ -1187,7 +1251,8 @@ bool asCByteCode::IsTempVarReadByInstr(asCByteInstruction *curr, int offset)
 			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG) &&
 			 int(curr->wArg[1]) == offset )
 		return true;
-	else if( asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG &&
+	else if( (asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_rW_rW_DW_ARG) &&
 			 (int(curr->wArg[0]) == offset || int(curr->wArg[1]) == offset) )
 		return true;
 	else if( curr->op == asBC_LoadThisR && offset == 0 )
@@ -1837,6 +1902,20 @@ int asCByteCode::ResolveJumpAddresses()
 			else
 				return -1;
 		}
+		else if( instr->op >= asBC_JLTi && instr->op <= asBC_JGEIu )
+		{
+			// The label is in the last argument
+			int *label = (int*)ARG_DW(instr->arg);
+			if( asBCInfo[instr->op].type == asBCTYPE_rW_DW_DW_ARG )
+				label++;
+
+			int labelPosOffset;
+			int r = FindLabel(*label, instr, 0, &labelPosOffset);
+			if( r == 0 )
+				*label = labelPosOffset;
+			else
+				return -1;
+		}
 
 		instr = instr->next;
 	}
@@ -1891,6 +1970,7 @@ void asCByteCode::Output(asDWORD *array)
 				break;
 			case asBCTYPE_wW_rW_DW_ARG:
 			case asBCTYPE_rW_W_DW_ARG:
+			case asBCTYPE_rW_rW_DW_ARG:
 				*(((asWORD*)ap)+1) = instr->wArg[0];
 				*(((asWORD*)ap)+2) = instr->wArg[1];
 				*(ap+2) = *(asDWORD*)&instr->arg;
@@ -2279,7 +2359,14 @@ void asCByteCode::DebugOutput(const char *name, asCScriptEngine *engine, asCScri
 			break;
 
 		case asBCTYPE_rW_DW_DW_ARG:
-			fprintf(file, "   %-8s v%d, %u, %u\n", asBCInfo[instr->op].name, instr->wArg[0], *(int*)ARG_DW(instr->arg), *(int*)(ARG_DW(instr->arg)+1));
+			if( instr->op >= asBC_JLTIi && instr->op <= asBC_JGEIu )
+				fprintf(file, "   %-8s v%d, %d, %+d         (d:%d)\n", asBCInfo[instr->op].name, instr->wArg[0], *(int*)ARG_DW(instr->arg), *(int*)(ARG_DW(instr->arg)+1), pos+*(int*)(ARG_DW(instr->arg)+1));
+			else
+				fprintf(file, "   %-8s v%d, %u, %u\n", asBCInfo[instr->op].name, instr->wArg[0], *(int*)ARG_DW(instr->arg), *(int*)(ARG_DW(instr->arg)+1));
+			break;
+
+		case asBCTYPE_rW_rW_DW_ARG:
+			fprintf(file, "   %-8s v%d, v%d, %+d         (d:%d)\n", asBCInfo[instr->op].name, instr->wArg[0], instr->wArg[1], *((int*) ARG_DW(instr->arg)), pos+*((int*) ARG_DW(instr->arg)));
 			break;
 
 		case asBCTYPE_QW_DW_ARG:
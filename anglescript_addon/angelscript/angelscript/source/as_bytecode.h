@@ -155,6 +155,7 @@ protected:
 	bool IsTempVarReadByInstr(asCByteInstruction *curr, int var);
 	bool IsTempVarOverwrittenByInstr(asCByteInstruction *curr, int var);
 	bool IsInstrJmpOrLabel(asCByteInstruction *curr);
+	void CombineCompareAndJump();
 
 	int AddInstruction();
 	int AddInstructionFirst();
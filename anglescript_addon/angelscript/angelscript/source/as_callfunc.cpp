@@ -400,6 +400,10 @@ int PrepareSystemFunction(asCScriptFunction *func, asSSystemFunctionInterface *i
 			break;
 		}
 	}
+
+#ifdef AS_CALL_THUNKS
+	PrepareSystemFunctionThunk(func, internal);
+#endif
 #endif // !defined(AS_MAX_PORTABILITY)
 	return 0;
 }
@@ -56,6 +56,13 @@ int PrepareSystemFunction(asCScriptFunction *func, asSSystemFunctionInterface *i
 
 int CallSystemFunction(int id, asCContext *context, void *objectPointer);
 
+#if defined(AS_X64_GCC) && !defined(AS_MAX_PORTABILITY)
+// Functions with simple signatures get a precomputed argument list
+// so the call doesn't have to inspect the parameter types each time
+#define AS_CALL_THUNKS
+void PrepareSystemFunctionThunk(asCScriptFunction *func, asSSystemFunctionInterface *internal);
+#endif
+
 inline asPWORD FuncPtrToUInt(asFUNCTION_t func)
 {
 	// A little trickery as the C++ standard doesn't allow direct 
@@ -94,6 +101,24 @@ enum internalCallConv
 	ICC_VIRTUAL_THISCALL_OBJFIRST_RETURNINMEM
 };
 
+// Where a call thunk takes the value for an argument register
+enum asECallThunkSource
+{
+	asTHUNK_RETURN_POINTER = 0xFFFD,
+	asTHUNK_OBJECT         = 0xFFFE,
+	asTHUNK_SECOND_OBJECT  = 0xFFFF
+};
+
+// Large enough for all the integer and floating point argument registers
+#define asMAX_THUNK_ARGS 14
+
+struct asSCallThunkArg
+{
+	asWORD source;  // Offset in dwords on the context stack, or asECallThunkSource
+	asBYTE reg;     // Index of the argument register
+	asBYTE isQWord;
+};
+
 struct asSSystemFunctionInterface
 {
 	asFUNCTION_t         func;
@@ -109,6 +134,10 @@ struct asSSystemFunctionInterface
 	bool                 returnAutoHandle;
 	bool                 hasAutoHandles;
 	void                *objForThiscall;
+	bool                 hasCallThunk;
+	bool                 thunkIsVirtual;
+	int                  thunkArgCount;
+	asSCallThunkArg      thunkArgs[asMAX_THUNK_ARGS];
 
 	asSSystemFunctionInterface() {}
 
@@ -132,6 +161,10 @@ struct asSSystemFunctionInterface
 		returnAutoHandle   = in.returnAutoHandle;
 		hasAutoHandles     = in.hasAutoHandles;
 		objForThiscall     = in.objForThiscall;
+		hasCallThunk       = in.hasCallThunk;
+		thunkIsVirtual     = in.thunkIsVirtual;
+		thunkArgCount      = in.thunkArgCount;
+		memcpy(thunkArgs, in.thunkArgs, sizeof(thunkArgs));
 		return *this;
 	}
 };
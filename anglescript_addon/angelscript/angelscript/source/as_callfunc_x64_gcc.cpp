@@ -162,10 +162,161 @@ static inline bool IsVariableArgument( asCDataType type )
 	return ( type.GetTokenType() == ttQuestion ) ? true : false;
 }
 
+// The called function only reads the registers it has parameters for,
+// so all functions with a thunk can be called through the same prototype
+typedef asQWORD (*thunkIntFunc_t)(asQWORD, asQWORD, asQWORD, asQWORD, asQWORD, asQWORD, double, double, double, double, double, double, double, double);
+typedef double (*thunkFloatFunc_t)(asQWORD, asQWORD, asQWORD, asQWORD, asQWORD, asQWORD, double, double, double, double, double, double, double, double);
+
+static bool AddThunkArg(asSSystemFunctionInterface *internal, int &intRegs, int &sseRegs, asWORD source, bool isFloat, bool isQWord)
+{
+	if( isFloat ? sseRegs == MAX_CALL_SSE_REGISTERS : intRegs == MAX_CALL_INT_REGISTERS )
+		return false;
+
+	asSCallThunkArg &arg = internal->thunkArgs[internal->thunkArgCount++];
+	arg.source  = source;
+	arg.reg     = asBYTE(isFloat ? MAX_CALL_INT_REGISTERS + sseRegs++ : intRegs++);
+	arg.isQWord = isQWord ? 1 : 0;
+	return true;
+}
+
+void PrepareSystemFunctionThunk(asCScriptFunction *func, asSSystemFunctionInterface *internal)
+{
+	internal->hasCallThunk   = false;
+	internal->thunkIsVirtual = false;
+	internal->thunkArgCount  = 0;
+
+	// Objects passed by value and values returned in more than one
+	// register are left for the generic argument marshalling
+	if( internal->takesObjByVal || internal->hostReturnSize > 2 )
+		return;
+
+	int    intRegs    = 0;
+	int    sseRegs    = 0;
+	asWORD postObject = 0;
+
+	if( internal->hostReturnInMemory )
+		AddThunkArg(internal, intRegs, sseRegs, asTHUNK_RETURN_POINTER, false, true);
+
+	switch( internal->callConv )
+	{
+	case ICC_CDECL:
+	case ICC_STDCALL:
+		break;
+	case ICC_VIRTUAL_THISCALL:
+		internal->thunkIsVirtual = true;
+		// fall through
+	case ICC_THISCALL:
+	case ICC_CDECL_OBJFIRST:
+		AddThunkArg(internal, intRegs, sseRegs, asTHUNK_OBJECT, false, true);
+		break;
+	case ICC_CDECL_OBJLAST:
+		postObject = asTHUNK_OBJECT;
+		break;
+#ifndef AS_NO_THISCALL_FUNCTOR_METHOD
+	case ICC_VIRTUAL_THISCALL_OBJLAST:
+		internal->thunkIsVirtual = true;
+		// fall through
+	case ICC_THISCALL_OBJLAST:
+		AddThunkArg(internal, intRegs, sseRegs, asTHUNK_OBJECT, false, true);
+		postObject = asTHUNK_SECOND_OBJECT;
+		break;
+	case ICC_VIRTUAL_THISCALL_OBJFIRST:
+		internal->thunkIsVirtual = true;
+		// fall through
+	case ICC_THISCALL_OBJFIRST:
+		AddThunkArg(internal, intRegs, sseRegs, asTHUNK_OBJECT, false, true);
+		AddThunkArg(internal, intRegs, sseRegs, asTHUNK_SECOND_OBJECT, false, true);
+		break;
+#endif
+	default:
+		return;
+	}
+
+	asUINT offset = 0;
+	for( asUINT n = 0; n < func->parameterTypes.GetLength(); n++ )
+	{
+		const asCDataType &type = func->parameterTypes[n];
+		bool added;
+		if( IsVariableArgument(type) )
+			added = false;
+		else if( (type.IsFloatType() || type.IsDoubleType()) && !type.IsReference() )
+			added = AddThunkArg(internal, intRegs, sseRegs, asWORD(offset), true, type.IsDoubleType());
+		else if( type.IsPrimitive() || type.IsReference() || type.IsObjectHandle() )
+			added = AddThunkArg(internal, intRegs, sseRegs, asWORD(offset), false, type.GetSizeOnStackDWords() == 2);
+		else
+			added = false;
+
+		// Arguments that would have to go on the stack are also left for the generic marshalling
+		if( !added )
+		{
+			internal->thunkIsVirtual = false;
+			internal->thunkArgCount  = 0;
+			return;
+		}
+
+		offset += type.GetSizeOnStackDWords();
+	}
+
+	if( postObject && !AddThunkArg(internal, intRegs, sseRegs, postObject, false, true) )
+	{
+		internal->thunkIsVirtual = false;
+		internal->thunkArgCount  = 0;
+		return;
+	}
+
+	internal->hasCallThunk = true;
+}
+
+static asQWORD CallSystemFunctionThunk(asSSystemFunctionInterface *sysFunc, void *obj, void *secondObject, asDWORD *args, void *retPointer)
+{
+	union { asQWORD q; double d; } regs[MAX_CALL_INT_REGISTERS + MAX_CALL_SSE_REGISTERS] = { { 0 } };
+
+	for( int n = 0; n < sysFunc->thunkArgCount; n++ )
+	{
+		const asSCallThunkArg &arg = sysFunc->thunkArgs[n];
+		switch( arg.source )
+		{
+		case asTHUNK_RETURN_POINTER: regs[arg.reg].q = (asPWORD)retPointer;   break;
+		case asTHUNK_OBJECT:         regs[arg.reg].q = (asPWORD)obj;          break;
+		case asTHUNK_SECOND_OBJECT:  regs[arg.reg].q = (asPWORD)secondObject; break;
+		default:
+			regs[arg.reg].q = arg.isQWord ? *(asQWORD*)(args + arg.source) : args[arg.source];
+		}
+	}
+
+	funcptr_t func = (funcptr_t)sysFunc->func;
+	if( obj && sysFunc->thunkIsVirtual )
+	{
+		funcptr_t *vftable = *((funcptr_t**)obj);
+		func = vftable[FuncPtrToUInt(asFUNCTION_t(func)) >> 3];
+	}
+
+	if( sysFunc->hostReturnFloat )
+	{
+		// Only the bits are of interest, the value is not converted
+		union { double d; asQWORD q; } ret;
+		ret.d = ((thunkFloatFunc_t)asFUNCTION_t(func))(regs[0].q, regs[1].q, regs[2].q, regs[3].q, regs[4].q, regs[5].q,
+		                                               regs[6].d, regs[7].d, regs[8].d, regs[9].d, regs[10].d, regs[11].d, regs[12].d, regs[13].d);
+		return ret.q;
+	}
+
+	return ((thunkIntFunc_t)asFUNCTION_t(func))(regs[0].q, regs[1].q, regs[2].q, regs[3].q, regs[4].q, regs[5].q,
+	                                            regs[6].d, regs[7].d, regs[8].d, regs[9].d, regs[10].d, regs[11].d, regs[12].d, regs[13].d);
+}
+
 asQWORD CallSystemFunctionNative(asCContext *context, asCScriptFunction *descr, void *obj, asDWORD *args, void *retPointer, asQWORD &retQW2)
 {
+	asSSystemFunctionInterface *sysFunc = descr->sysFuncIntf;
+	if( sysFunc->hasCallThunk )
+	{
+#ifdef AS_NO_THISCALL_FUNCTOR_METHOD
+		return CallSystemFunctionThunk(sysFunc, obj, 0, args, retPointer);
+#else
+		return CallSystemFunctionThunk(sysFunc, ((void**)obj)[0], ((void**)obj)[1], args, retPointer);
+#endif
+	}
+
 	asCScriptEngine            *engine             = context->m_engine;
-	asSSystemFunctionInterface *sysFunc            = descr->sysFuncIntf;
 	int                         callConv           = sysFunc->callConv;
 	asQWORD                     retQW              = 0;
 	asDWORD                    *stack_pointer      = args;
@@ -104,6 +104,11 @@
 // AS_USE_NAMESPACE
 // Adds the AngelScript namespace on the declarations.
 
+// AS_NO_COMPUTED_GOTO
+// Turns off the computed goto dispatch of bytecode instructions in the
+// virtual machine on compilers that support labels as values (gnuc and
+// clang). The portable switch will then be used instead.
+
 
 
 //
@@ -1124,6 +1129,13 @@
 	#define AS_NO_THREADS
 #endif
 
+// Use computed goto to dispatch the bytecode instructions if the compiler
+// supports it. Debug builds use the switch, as they gather statistics and
+// validate the size of each executed instruction in the loop
+#if defined(__GNUC__) && !defined(AS_NO_COMPUTED_GOTO) && !defined(AS_DEBUG)
+	#define AS_USE_COMPUTED_GOTO
+#endif
+
 
 // The assert macro
 #if defined(ANDROID)
@@ -117,6 +117,9 @@ void asCConfigGroup::RemoveConfiguration(asCScriptEngine *engine, bool notUsed)
 	}
 	globalProps.SetLength(0);
 
+	// Types cached by the engine may be from this group
+	engine->ClearTypeLookupCaches();
+
 	// Remove global functions
 	for( n = 0; n < scriptFunctions.GetLength(); n++ )
 	{
@@ -169,6 +169,7 @@ asCContext::asCContext(asCScriptEngine *engine, bool holdRef)
 	m_regs.objectRegister       = 0;
 	m_initialFunction           = 0;
 	m_lineCallback              = false;
+	m_breakpointCallback        = false;
 	m_exceptionCallback         = false;
 	m_regs.doProcessSuspend     = false;
 	m_doSuspend                 = false;
@@ -264,6 +265,17 @@ void asCContext::DetachEngine()
 	m_stackBlockSize = 0;
 
 	// Clean the user data
+	CleanUserData();
+
+	// Clear engine pointer
+	if( m_holdEngineRef )
+		m_engine->Release();
+	m_engine = 0;
+}
+
+// internal
+void asCContext::CleanUserData()
+{
 	for( asUINT n = 0; n < m_userData.GetLength(); n += 2 )
 	{
 		if( m_userData[n+1] )
@@ -274,11 +286,6 @@ void asCContext::DetachEngine()
 		}
 	}
 	m_userData.SetLength(0);
-
-	// Clear engine pointer
-	if( m_holdEngineRef )
-		m_engine->Release();
-	m_engine = 0;
 }
 
 // interface
@@ -452,10 +459,13 @@ int asCContext::Prepare(asIScriptFunction *func)
 		m_exceptionLine           = -1;
 		m_exceptionFunction       = 0;
 		m_doAbort                 = false;
-		m_doSuspend               = false;
-		m_regs.doProcessSuspend   = m_lineCallback;
-		m_externalSuspendRequest  = false;
 	}
+
+	// A Suspend from another thread can arrive after Execute has
+	// returned, and it must not stop the next execution at once
+	m_doSuspend               = false;
+	m_regs.doProcessSuspend   = m_lineCallback;
+	m_externalSuspendRequest  = false;
 	m_status = asEXECUTION_PREPARED;
 	m_regs.programPointer = 0;
 
@@ -1743,12 +1753,95 @@ void asCContext::CallInterfaceMethod(asCScriptFunction *func)
 	CallScriptFunction(realFunc);
 }
 
+#ifdef AS_USE_COMPUTED_GOTO
+// Each instruction handler jumps directly to the handler of the next
+// instruction through a table of label addresses, instead of going back
+// to the top of the loop. This gives the processor one indirect jump per
+// handler to predict, rather than a single shared jump for all of them
+#define asBC_CASE(op) case op: op##_label
+#define asBC_NEXT     goto *dispatchTable[*(asBYTE*)l_bc]
+#else
+#define asBC_CASE(op) case op
+#define asBC_NEXT     break
+#endif
+
 void asCContext::ExecuteNext()
 {
 	asDWORD *l_bc = m_regs.programPointer;
 	asDWORD *l_sp = m_regs.stackPointer;
 	asDWORD *l_fp = m_regs.stackFramePointer;
 
+#ifdef AS_USE_COMPUTED_GOTO
+	// The table must be kept in the same order as the asEBCInstr enum
+	static const void *const dispatchTable[256] =
+	{
+		&&asBC_PopPtr_label, &&asBC_PshGPtr_label, &&asBC_PshC4_label, &&asBC_PshV4_label,
+		&&asBC_PSF_label, &&asBC_SwapPtr_label, &&asBC_NOT_label, &&asBC_PshG4_label,
+		&&asBC_LdGRdR4_label, &&asBC_CALL_label, &&asBC_RET_label, &&asBC_JMP_label,
+		&&asBC_JZ_label, &&asBC_JNZ_label, &&asBC_JS_label, &&asBC_JNS_label,
+		&&asBC_JP_label, &&asBC_JNP_label, &&asBC_TZ_label, &&asBC_TNZ_label,
+		&&asBC_TS_label, &&asBC_TNS_label, &&asBC_TP_label, &&asBC_TNP_label,
+		&&asBC_NEGi_label, &&asBC_NEGf_label, &&asBC_NEGd_label, &&asBC_INCi16_label,
+		&&asBC_INCi8_label, &&asBC_DECi16_label, &&asBC_DECi8_label, &&asBC_INCi_label,
+		&&asBC_DECi_label, &&asBC_INCf_label, &&asBC_DECf_label, &&asBC_INCd_label,
+		&&asBC_DECd_label, &&asBC_IncVi_label, &&asBC_DecVi_label, &&asBC_BNOT_label,
+		&&asBC_BAND_label, &&asBC_BOR_label, &&asBC_BXOR_label, &&asBC_BSLL_label,
+		&&asBC_BSRL_label, &&asBC_BSRA_label, &&asBC_COPY_label, &&asBC_PshC8_label,
+		&&asBC_PshVPtr_label, &&asBC_RDSPtr_label, &&asBC_CMPd_label, &&asBC_CMPu_label,
+		&&asBC_CMPf_label, &&asBC_CMPi_label, &&asBC_CMPIi_label, &&asBC_CMPIf_label,
+		&&asBC_CMPIu_label, &&asBC_JMPP_label, &&asBC_PopRPtr_label, &&asBC_PshRPtr_label,
+		&&asBC_STR_label, &&asBC_CALLSYS_label, &&asBC_CALLBND_label, &&asBC_SUSPEND_label,
+		&&asBC_ALLOC_label, &&asBC_FREE_label, &&asBC_LOADOBJ_label, &&asBC_STOREOBJ_label,
+		&&asBC_GETOBJ_label, &&asBC_REFCPY_label, &&asBC_CHKREF_label, &&asBC_GETOBJREF_label,
+		&&asBC_GETREF_label, &&asBC_PshNull_label, &&asBC_ClrVPtr_label, &&asBC_OBJTYPE_label,
+		&&asBC_TYPEID_label, &&asBC_SetV4_label, &&asBC_SetV8_label, &&asBC_ADDSi_label,
+		&&asBC_CpyVtoV4_label, &&asBC_CpyVtoV8_label, &&asBC_CpyVtoR4_label, &&asBC_CpyVtoR8_label,
+		&&asBC_CpyVtoG4_label, &&asBC_CpyRtoV4_label, &&asBC_CpyRtoV8_label, &&asBC_CpyGtoV4_label,
+		&&asBC_WRTV1_label, &&asBC_WRTV2_label, &&asBC_WRTV4_label, &&asBC_WRTV8_label,
+		&&asBC_RDR1_label, &&asBC_RDR2_label, &&asBC_RDR4_label, &&asBC_RDR8_label,
+		&&asBC_LDG_label, &&asBC_LDV_label, &&asBC_PGA_label, &&asBC_CmpPtr_label,
+		&&asBC_VAR_label, &&asBC_iTOf_label, &&asBC_fTOi_label, &&asBC_uTOf_label,
+		&&asBC_fTOu_label, &&asBC_sbTOi_label, &&asBC_swTOi_label, &&asBC_ubTOi_label,
+		&&asBC_uwTOi_label, &&asBC_dTOi_label, &&asBC_dTOu_label, &&asBC_dTOf_label,
+		&&asBC_iTOd_label, &&asBC_uTOd_label, &&asBC_fTOd_label, &&asBC_ADDi_label,
+		&&asBC_SUBi_label, &&asBC_MULi_label, &&asBC_DIVi_label, &&asBC_MODi_label,
+		&&asBC_ADDf_label, &&asBC_SUBf_label, &&asBC_MULf_label, &&asBC_DIVf_label,
+		&&asBC_MODf_label, &&asBC_ADDd_label, &&asBC_SUBd_label, &&asBC_MULd_label,
+		&&asBC_DIVd_label, &&asBC_MODd_label, &&asBC_ADDIi_label, &&asBC_SUBIi_label,
+		&&asBC_MULIi_label, &&asBC_ADDIf_label, &&asBC_SUBIf_label, &&asBC_MULIf_label,
+		&&asBC_SetG4_label, &&asBC_ChkRefS_label, &&asBC_ChkNullV_label, &&asBC_CALLINTF_label,
+		&&asBC_iTOb_label, &&asBC_iTOw_label, &&asBC_SetV1_label, &&asBC_SetV2_label,
+		&&asBC_Cast_label, &&asBC_i64TOi_label, &&asBC_uTOi64_label, &&asBC_iTOi64_label,
+		&&asBC_fTOi64_label, &&asBC_dTOi64_label, &&asBC_fTOu64_label, &&asBC_dTOu64_label,
+		&&asBC_i64TOf_label, &&asBC_u64TOf_label, &&asBC_i64TOd_label, &&asBC_u64TOd_label,
+		&&asBC_NEGi64_label, &&asBC_INCi64_label, &&asBC_DECi64_label, &&asBC_BNOT64_label,
+		&&asBC_ADDi64_label, &&asBC_SUBi64_label, &&asBC_MULi64_label, &&asBC_DIVi64_label,
+		&&asBC_MODi64_label, &&asBC_BAND64_label, &&asBC_BOR64_label, &&asBC_BXOR64_label,
+		&&asBC_BSLL64_label, &&asBC_BSRL64_label, &&asBC_BSRA64_label, &&asBC_CMPi64_label,
+		&&asBC_CMPu64_label, &&asBC_ChkNullS_label, &&asBC_ClrHi_label, &&asBC_JitEntry_label,
+		&&asBC_CallPtr_label, &&asBC_FuncPtr_label, &&asBC_LoadThisR_label, &&asBC_PshV8_label,
+		&&asBC_DIVu_label, &&asBC_MODu_label, &&asBC_DIVu64_label, &&asBC_MODu64_label,
+		&&asBC_LoadRObjR_label, &&asBC_LoadVObjR_label, &&asBC_RefCpyV_label, &&asBC_JLowZ_label,
+		&&asBC_JLowNZ_label, &&asBC_AllocMem_label, &&asBC_SetListSize_label, &&asBC_PshListElmnt_label,
+		&&asBC_SetListType_label, &&asBC_POWi_label, &&asBC_POWu_label, &&asBC_POWf_label,
+		&&asBC_POWd_label, &&asBC_POWdi_label, &&asBC_POWi64_label, &&asBC_POWu64_label,
+		&&asBC_JLTi_label, &&asBC_JLEi_label, &&asBC_JGTi_label, &&asBC_JGEi_label,
+		&&asBC_JEQi_label, &&asBC_JNEi_label, &&asBC_JLTu_label, &&asBC_JLEu_label,
+		&&asBC_JGTu_label, &&asBC_JGEu_label, &&asBC_JLTIi_label, &&asBC_JLEIi_label,
+		&&asBC_JGTIi_label, &&asBC_JGEIi_label, &&asBC_JEQIi_label, &&asBC_JNEIi_label,
+		&&asBC_JLTIu_label, &&asBC_JLEIu_label, &&asBC_JGTIu_label, &&asBC_JGEIu_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label,
+		&&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label, &&asBC_invalid_label
+	};
+#endif
+
 	for(;;)
 	{
 
@@ -1766,57 +1859,60 @@ void asCContext::ExecuteNext()
 	// It will be faster since only one lookup will be
 	// made to find the correct jump destination. If not
 	// in order, the switch will make two lookups.
+	// With AS_USE_COMPUTED_GOTO the switch is only used
+	// to dispatch the first instruction, after that each
+	// handler dispatches the next one with asBC_NEXT.
 	switch( *(asBYTE*)l_bc )
 	{
 //--------------
 // memory access functions
 
-	case asBC_PopPtr:
+	asBC_CASE(asBC_PopPtr):
 		// Pop a pointer from the stack
 		l_sp += AS_PTR_SIZE;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_PshGPtr:
+	asBC_CASE(asBC_PshGPtr):
 		// Replaces PGA + RDSPtr
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = *(asPWORD*)asBC_PTRARG(l_bc);
 		l_bc += 1 + AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
 	// Push a dword value on the stack
-	case asBC_PshC4:
+	asBC_CASE(asBC_PshC4):
 		--l_sp;
 		*l_sp = asBC_DWORDARG(l_bc);
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Push the dword value of a variable on the stack
-	case asBC_PshV4:
+	asBC_CASE(asBC_PshV4):
 		--l_sp;
 		*l_sp = *(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Push the address of a variable on the stack
-	case asBC_PSF:
+	asBC_CASE(asBC_PSF):
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = asPWORD(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Swap the top 2 pointers on the stack
-	case asBC_SwapPtr:
+	asBC_CASE(asBC_SwapPtr):
 		{
 			asPWORD p = *(asPWORD*)l_sp;
 			*(asPWORD*)l_sp = *(asPWORD*)(l_sp+AS_PTR_SIZE);
 			*(asPWORD*)(l_sp+AS_PTR_SIZE) = p;
 			l_bc++;
 		}
-		break;
+		asBC_NEXT;
 
 	// Do a boolean not operation, modifying the value of the variable
-	case asBC_NOT:
+	asBC_CASE(asBC_NOT):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is equal to 0
@@ -1835,28 +1931,28 @@ void asCContext::ExecuteNext()
 		*(l_fp - asBC_SWORDARG0(l_bc)) = (*(l_fp - asBC_SWORDARG0(l_bc)) == 0 ? VALUE_OF_BOOLEAN_TRUE : 0);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Push the dword value of a global variable on the stack
-	case asBC_PshG4:
+	asBC_CASE(asBC_PshG4):
 		--l_sp;
 		*l_sp = *(asDWORD*)asBC_PTRARG(l_bc);
 		l_bc += 1 + AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
 	// Load the address of a global variable in the register, then
 	// copy the value of the global variable into a local variable
-	case asBC_LdGRdR4:
+	asBC_CASE(asBC_LdGRdR4):
 		*(void**)&m_regs.valueRegister = (void*)asBC_PTRARG(l_bc);
 		*(l_fp - asBC_SWORDARG0(l_bc)) = **(asDWORD**)&m_regs.valueRegister;
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
 //----------------
 // path control instructions
 
 	// Begin execution of a script function
-	case asBC_CALL:
+	asBC_CASE(asBC_CALL):
 		{
 			int i = asBC_INTARG(l_bc);
 			l_bc += 2;
@@ -1880,10 +1976,10 @@ void asCContext::ExecuteNext()
 			if( m_status != asEXECUTION_ACTIVE )
 				return;
 		}
-		break;
+		asBC_NEXT;
 
 	// Return to the caller, and remove the arguments from the stack
-	case asBC_RET:
+	asBC_CASE(asBC_RET):
 		{
 			// Return if this was the first function, or a nested execution
 			if( m_callStack.GetLength() == 0 ||
@@ -1906,68 +2002,68 @@ void asCContext::ExecuteNext()
 			// Pop arguments from stack
 			l_sp += w;
 		}
-		break;
+		asBC_NEXT;
 
 	// Jump to a relative position
-	case asBC_JMP:
+	asBC_CASE(asBC_JMP):
 		l_bc += 2 + asBC_INTARG(l_bc);
-		break;
+		asBC_NEXT;
 
 //----------------
 // Conditional jumps
 
 	// Jump to a relative position if the value in the register is 0
-	case asBC_JZ:
+	asBC_CASE(asBC_JZ):
 		if( *(int*)&m_regs.valueRegister == 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Jump to a relative position if the value in the register is not 0
-	case asBC_JNZ:
+	asBC_CASE(asBC_JNZ):
 		if( *(int*)&m_regs.valueRegister != 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Jump to a relative position if the value in the register is negative
-	case asBC_JS:
+	asBC_CASE(asBC_JS):
 		if( *(int*)&m_regs.valueRegister < 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Jump to a relative position if the value in the register it not negative
-	case asBC_JNS:
+	asBC_CASE(asBC_JNS):
 		if( *(int*)&m_regs.valueRegister >= 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Jump to a relative position if the value in the register is greater than 0
-	case asBC_JP:
+	asBC_CASE(asBC_JP):
 		if( *(int*)&m_regs.valueRegister > 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Jump to a relative position if the value in the register is not greater than 0
-	case asBC_JNP:
+	asBC_CASE(asBC_JNP):
 		if( *(int*)&m_regs.valueRegister <= 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 //--------------------
 // test instructions
 
 	// If the value in the register is 0, then set the register to 1, else to 0
-	case asBC_TZ:
+	asBC_CASE(asBC_TZ):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is equal to 0
@@ -1991,10 +2087,10 @@ void asCContext::ExecuteNext()
 		*(int*)&m_regs.valueRegister = (*(int*)&m_regs.valueRegister == 0 ? VALUE_OF_BOOLEAN_TRUE : 0);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// If the value in the register is not 0, then set the register to 1, else to 0
-	case asBC_TNZ:
+	asBC_CASE(asBC_TNZ):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is not equal to 0
@@ -2018,10 +2114,10 @@ void asCContext::ExecuteNext()
 		*(int*)&m_regs.valueRegister = (*(int*)&m_regs.valueRegister == 0 ? 0 : VALUE_OF_BOOLEAN_TRUE);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// If the value in the register is negative, then set the register to 1, else to 0
-	case asBC_TS:
+	asBC_CASE(asBC_TS):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is less than 0
@@ -2045,10 +2141,10 @@ void asCContext::ExecuteNext()
 		*(int*)&m_regs.valueRegister = (*(int*)&m_regs.valueRegister < 0 ? VALUE_OF_BOOLEAN_TRUE : 0);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// If the value in the register is not negative, then set the register to 1, else to 0
-	case asBC_TNS:
+	asBC_CASE(asBC_TNS):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is not less than 0
@@ -2072,10 +2168,10 @@ void asCContext::ExecuteNext()
 		*(int*)&m_regs.valueRegister = (*(int*)&m_regs.valueRegister < 0 ? 0 : VALUE_OF_BOOLEAN_TRUE);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// If the value in the register is greater than 0, then set the register to 1, else to 0
-	case asBC_TP:
+	asBC_CASE(asBC_TP):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is greater than 0
@@ -2099,10 +2195,10 @@ void asCContext::ExecuteNext()
 		*(int*)&m_regs.valueRegister = (*(int*)&m_regs.valueRegister > 0 ? VALUE_OF_BOOLEAN_TRUE : 0);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// If the value in the register is not greater than 0, then set the register to 1, else to 0
-	case asBC_TNP:
+	asBC_CASE(asBC_TNP):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Set the value to true if it is not greater than 0
@@ -2126,150 +2222,150 @@ void asCContext::ExecuteNext()
 		*(int*)&m_regs.valueRegister = (*(int*)&m_regs.valueRegister > 0 ? 0 : VALUE_OF_BOOLEAN_TRUE);
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 //--------------------
 // negate value
 
 	// Negate the integer value in the variable
-	case asBC_NEGi:
+	asBC_CASE(asBC_NEGi):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = asDWORD(-int(*(l_fp - asBC_SWORDARG0(l_bc))));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Negate the float value in the variable
-	case asBC_NEGf:
+	asBC_CASE(asBC_NEGf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = -*(float*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Negate the double value in the variable
-	case asBC_NEGd:
+	asBC_CASE(asBC_NEGd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = -*(double*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 //-------------------------
 // Increment value pointed to by address in register
 
 	// Increment the short value pointed to by the register
-	case asBC_INCi16:
+	asBC_CASE(asBC_INCi16):
 		(**(short**)&m_regs.valueRegister)++;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Increment the byte value pointed to by the register
-	case asBC_INCi8:
+	asBC_CASE(asBC_INCi8):
 		(**(char**)&m_regs.valueRegister)++;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Decrement the short value pointed to by the register
-	case asBC_DECi16:
+	asBC_CASE(asBC_DECi16):
 		(**(short**)&m_regs.valueRegister)--;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Decrement the byte value pointed to by the register
-	case asBC_DECi8:
+	asBC_CASE(asBC_DECi8):
 		(**(char**)&m_regs.valueRegister)--;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Increment the integer value pointed to by the register
-	case asBC_INCi:
+	asBC_CASE(asBC_INCi):
 		++(**(int**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Decrement the integer value pointed to by the register
-	case asBC_DECi:
+	asBC_CASE(asBC_DECi):
 		--(**(int**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Increment the float value pointed to by the register
-	case asBC_INCf:
+	asBC_CASE(asBC_INCf):
 		++(**(float**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Decrement the float value pointed to by the register
-	case asBC_DECf:
+	asBC_CASE(asBC_DECf):
 		--(**(float**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Increment the double value pointed to by the register
-	case asBC_INCd:
+	asBC_CASE(asBC_INCd):
 		++(**(double**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Decrement the double value pointed to by the register
-	case asBC_DECd:
+	asBC_CASE(asBC_DECd):
 		--(**(double**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Increment the local integer variable
-	case asBC_IncVi:
+	asBC_CASE(asBC_IncVi):
 		(*(int*)(l_fp - asBC_SWORDARG0(l_bc)))++;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Decrement the local integer variable
-	case asBC_DecVi:
+	asBC_CASE(asBC_DecVi):
 		(*(int*)(l_fp - asBC_SWORDARG0(l_bc)))--;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 //--------------------
 // bits instructions
 
 	// Do a bitwise not on the value in the variable
-	case asBC_BNOT:
+	asBC_CASE(asBC_BNOT):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = ~*(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	// Do a bitwise and of two variables and store the result in a third variable
-	case asBC_BAND:
+	asBC_CASE(asBC_BAND):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(l_fp - asBC_SWORDARG1(l_bc)) & *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Do a bitwise or of two variables and store the result in a third variable
-	case asBC_BOR:
+	asBC_CASE(asBC_BOR):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(l_fp - asBC_SWORDARG1(l_bc)) | *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Do a bitwise xor of two variables and store the result in a third variable
-	case asBC_BXOR:
+	asBC_CASE(asBC_BXOR):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(l_fp - asBC_SWORDARG1(l_bc)) ^ *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Do a logical shift left of two variables and store the result in a third variable
-	case asBC_BSLL:
+	asBC_CASE(asBC_BSLL):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(l_fp - asBC_SWORDARG1(l_bc)) << *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Do a logical shift right of two variables and store the result in a third variable
-	case asBC_BSRL:
+	asBC_CASE(asBC_BSRL):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(l_fp - asBC_SWORDARG1(l_bc)) >> *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	// Do an arithmetic shift right of two variables and store the result in a third variable
-	case asBC_BSRA:
+	asBC_CASE(asBC_BSRA):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = int(*(l_fp - asBC_SWORDARG1(l_bc))) >> *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_COPY:
+	asBC_CASE(asBC_COPY):
 		{
 			void *d = (void*)*(asPWORD*)l_sp; l_sp += AS_PTR_SIZE;
 			void *s = (void*)*(asPWORD*)l_sp;
@@ -2290,21 +2386,21 @@ void asCContext::ExecuteNext()
 			*(asPWORD**)l_sp = (asPWORD*)d;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_PshC8:
+	asBC_CASE(asBC_PshC8):
 		l_sp -= 2;
 		*(asQWORD*)l_sp = asBC_QWORDARG(l_bc);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_PshVPtr:
+	asBC_CASE(asBC_PshVPtr):
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = *(asPWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_RDSPtr:
+	asBC_CASE(asBC_RDSPtr):
 		{
 			// The pointer must not be null
 			asPWORD a = *(asPWORD*)l_sp;
@@ -2321,11 +2417,11 @@ void asCContext::ExecuteNext()
 			*(asPWORD*)l_sp = *(asPWORD*)a;
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	//----------------------------
 	// Comparisons
-	case asBC_CMPd:
+	asBC_CASE(asBC_CMPd):
 		{
 			// Do a comparison of the values, rather than a subtraction
 			// in order to get proper behaviour for infinity values.
@@ -2336,9 +2432,9 @@ void asCContext::ExecuteNext()
 			else                   *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPu:
+	asBC_CASE(asBC_CMPu):
 		{
 			asDWORD d1 = *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 			asDWORD d2 = *(asDWORD*)(l_fp - asBC_SWORDARG1(l_bc));
@@ -2347,9 +2443,9 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPf:
+	asBC_CASE(asBC_CMPf):
 		{
 			// Do a comparison of the values, rather than a subtraction
 			// in order to get proper behaviour for infinity values.
@@ -2360,9 +2456,9 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPi:
+	asBC_CASE(asBC_CMPi):
 		{
 			int i1 = *(int*)(l_fp - asBC_SWORDARG0(l_bc));
 			int i2 = *(int*)(l_fp - asBC_SWORDARG1(l_bc));
@@ -2371,11 +2467,11 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
 	//----------------------------
 	// Comparisons with constant value
-	case asBC_CMPIi:
+	asBC_CASE(asBC_CMPIi):
 		{
 			int i1 = *(int*)(l_fp - asBC_SWORDARG0(l_bc));
 			int i2 = asBC_INTARG(l_bc);
@@ -2384,9 +2480,9 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPIf:
+	asBC_CASE(asBC_CMPIf):
 		{
 			// Do a comparison of the values, rather than a subtraction
 			// in order to get proper behaviour for infinity values.
@@ -2397,9 +2493,9 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPIu:
+	asBC_CASE(asBC_CMPIu):
 		{
 			asDWORD d1 = *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 			asDWORD d2 = asBC_DWORDARG(l_bc);
@@ -2408,25 +2504,25 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_JMPP:
+	asBC_CASE(asBC_JMPP):
 		l_bc += 1 + (*(int*)(l_fp - asBC_SWORDARG0(l_bc)))*2;
-		break;
+		asBC_NEXT;
 
-	case asBC_PopRPtr:
+	asBC_CASE(asBC_PopRPtr):
 		*(asPWORD*)&m_regs.valueRegister = *(asPWORD*)l_sp;
 		l_sp += AS_PTR_SIZE;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_PshRPtr:
+	asBC_CASE(asBC_PshRPtr):
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = *(asPWORD*)&m_regs.valueRegister;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_STR:
+	asBC_CASE(asBC_STR):
 		{
 			// Get the string id from the argument
 			asWORD w = asBC_WORDARG0(l_bc);
@@ -2439,9 +2535,9 @@ void asCContext::ExecuteNext()
 			*l_sp = (asDWORD)b.GetLength();
 			l_bc++;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CALLSYS:
+	asBC_CASE(asBC_CALLSYS):
 		{
 			// Get function ID from the argument
 			int i = asBC_INTARG(l_bc);
@@ -2480,9 +2576,9 @@ void asCContext::ExecuteNext()
 				}
 			}
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CALLBND:
+	asBC_CASE(asBC_CALLBND):
 		{
 			// TODO: Clean-up: This code is very similar to asBC_CallPtr. Create a shared method for them
 			// Get the function ID from the stack
@@ -2561,10 +2657,12 @@ void asCContext::ExecuteNext()
 			if( m_status != asEXECUTION_ACTIVE )
 				return;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_SUSPEND:
-		if( m_regs.doProcessSuspend )
+	asBC_CASE(asBC_SUSPEND):
+		// Breakpoints are set by flagging the SUSPEND instruction in the bytecode
+		// so a debugger doesn't need the line callback to be called for each line
+		if( m_regs.doProcessSuspend || asBC_BREAKPOINT_FLAG(l_bc) )
 		{
 			if( m_lineCallback )
 			{
@@ -2574,6 +2672,14 @@ void asCContext::ExecuteNext()
 
 				CallLineCallback();
 			}
+			if( m_breakpointCallback && asBC_BREAKPOINT_FLAG(l_bc) )
+			{
+				m_regs.programPointer    = l_bc;
+				m_regs.stackPointer      = l_sp;
+				m_regs.stackFramePointer = l_fp;
+
+				CallBreakpointCallback();
+			}
 			if( m_doSuspend )
 			{
 				l_bc++;
@@ -2589,9 +2695,9 @@ void asCContext::ExecuteNext()
 		}
 
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_ALLOC:
+	asBC_CASE(asBC_ALLOC):
 		{
 			asCObjectType *objType = (asCObjectType*)asBC_PTRARG(l_bc);
 			int func = asBC_INTARG(l_bc+AS_PTR_SIZE);
@@ -2683,9 +2789,9 @@ void asCContext::ExecuteNext()
 				}
 			}
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_FREE:
+	asBC_CASE(asBC_FREE):
 		{
 			// Get the variable that holds the object handle/reference
 			asPWORD *a = (asPWORD*)asPWORD(l_fp - asBC_SWORDARG0(l_bc));
@@ -2721,9 +2827,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_LOADOBJ:
+	asBC_CASE(asBC_LOADOBJ):
 		{
 			// Move the object pointer from the object variable into the object register
 			void **a = (void**)(l_fp - asBC_SWORDARG0(l_bc));
@@ -2732,16 +2838,16 @@ void asCContext::ExecuteNext()
 			*a = 0;
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_STOREOBJ:
+	asBC_CASE(asBC_STOREOBJ):
 		// Move the object pointer from the object register to the object variable
 		*(asPWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = asPWORD(m_regs.objectRegister);
 		m_regs.objectRegister = 0;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_GETOBJ:
+	asBC_CASE(asBC_GETOBJ):
 		{
 			// Read variable index from location on stack
 			asPWORD *a = (asPWORD*)(l_sp + asBC_WORDARG0(l_bc));
@@ -2753,9 +2859,9 @@ void asCContext::ExecuteNext()
 			*v = 0;
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_REFCPY:
+	asBC_CASE(asBC_REFCPY):
 		{
 			asCObjectType *objType = (asCObjectType*)asBC_PTRARG(l_bc);
 			asSTypeBehaviour *beh = &objType->beh;
@@ -2787,9 +2893,9 @@ void asCContext::ExecuteNext()
 			*d = s;
 		}
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_CHKREF:
+	asBC_CASE(asBC_CHKREF):
 		{
 			// Verify if the pointer on the stack is null
 			// This is used when validating a pointer that an operator will work on
@@ -2805,9 +2911,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_GETOBJREF:
+	asBC_CASE(asBC_GETOBJREF):
 		{
 			// Get the location on the stack where the reference will be placed
 			asPWORD *a = (asPWORD*)(l_sp + asBC_WORDARG0(l_bc));
@@ -2816,9 +2922,9 @@ void asCContext::ExecuteNext()
 			*(asPWORD**)a = *(asPWORD**)(l_fp - *a);
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_GETREF:
+	asBC_CASE(asBC_GETREF):
 		{
 			// Get the location on the stack where the reference will be placed
 			asPWORD *a = (asPWORD*)(l_sp + asBC_WORDARG0(l_bc));
@@ -2827,49 +2933,49 @@ void asCContext::ExecuteNext()
 			*(asPWORD**)a = (asPWORD*)(l_fp - (int)*a);
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_PshNull:
+	asBC_CASE(asBC_PshNull):
 		// Push a null pointer on the stack
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = 0;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_ClrVPtr:
+	asBC_CASE(asBC_ClrVPtr):
 		// TODO: runtime optimize: Is this instruction really necessary?
 		//                         CallScriptFunction() can clear the null handles upon entry, just as is done for
 		//                         all other object variables
 		// Clear pointer variable
 		*(asPWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = 0;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_OBJTYPE:
+	asBC_CASE(asBC_OBJTYPE):
 		// Push the object type on the stack
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = asBC_PTRARG(l_bc);
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_TYPEID:
+	asBC_CASE(asBC_TYPEID):
 		// Equivalent to PshC4, but kept as separate instruction for bytecode serialization
 		--l_sp;
 		*l_sp = asBC_DWORDARG(l_bc);
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SetV4:
+	asBC_CASE(asBC_SetV4):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = asBC_DWORDARG(l_bc);
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SetV8:
+	asBC_CASE(asBC_SetV8):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = asBC_QWORDARG(l_bc);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_ADDSi:
+	asBC_CASE(asBC_ADDSi):
 		{
 			// The pointer must not be null
 			asPWORD a = *(asPWORD*)l_sp;
@@ -2886,71 +2992,71 @@ void asCContext::ExecuteNext()
 			*(asPWORD*)l_sp = a + asBC_SWORDARG0(l_bc);
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyVtoV4:
+	asBC_CASE(asBC_CpyVtoV4):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(l_fp - asBC_SWORDARG1(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyVtoV8:
+	asBC_CASE(asBC_CpyVtoV8):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyVtoR4:
+	asBC_CASE(asBC_CpyVtoR4):
 		*(asDWORD*)&m_regs.valueRegister = *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyVtoR8:
+	asBC_CASE(asBC_CpyVtoR8):
 		*(asQWORD*)&m_regs.valueRegister = *(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyVtoG4:
+	asBC_CASE(asBC_CpyVtoG4):
 		*(asDWORD*)asBC_PTRARG(l_bc) = *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc += 1 + AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyRtoV4:
+	asBC_CASE(asBC_CpyRtoV4):
 		*(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asDWORD*)&m_regs.valueRegister;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyRtoV8:
+	asBC_CASE(asBC_CpyRtoV8):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = m_regs.valueRegister;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_CpyGtoV4:
+	asBC_CASE(asBC_CpyGtoV4):
 		*(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asDWORD*)asBC_PTRARG(l_bc);
 		l_bc += 1 + AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_WRTV1:
+	asBC_CASE(asBC_WRTV1):
 		// The pointer in the register points to a byte, and *(l_fp - offset) too
 		**(asBYTE**)&m_regs.valueRegister = *(asBYTE*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_WRTV2:
+	asBC_CASE(asBC_WRTV2):
 		// The pointer in the register points to a word, and *(l_fp - offset) too
 		**(asWORD**)&m_regs.valueRegister = *(asWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_WRTV4:
+	asBC_CASE(asBC_WRTV4):
 		**(asDWORD**)&m_regs.valueRegister = *(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_WRTV8:
+	asBC_CASE(asBC_WRTV8):
 		**(asQWORD**)&m_regs.valueRegister = *(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_RDR1:
+	asBC_CASE(asBC_RDR1):
 		{
 			// The pointer in the register points to a byte, and *(l_fp - offset) will also point to a byte
 			asBYTE *bPtr = (asBYTE*)(l_fp - asBC_SWORDARG0(l_bc));
@@ -2960,9 +3066,9 @@ void asCContext::ExecuteNext()
 			bPtr[3] = 0;
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_RDR2:
+	asBC_CASE(asBC_RDR2):
 		{
 			// The pointer in the register points to a word, and *(l_fp - offset) will also point to a word
 			asWORD *wPtr = (asWORD*)(l_fp - asBC_SWORDARG0(l_bc));
@@ -2970,35 +3076,35 @@ void asCContext::ExecuteNext()
 			wPtr[1] = 0;                      // 0 the rest of the DWORD
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_RDR4:
+	asBC_CASE(asBC_RDR4):
 		*(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = **(asDWORD**)&m_regs.valueRegister;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_RDR8:
+	asBC_CASE(asBC_RDR8):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = **(asQWORD**)&m_regs.valueRegister;
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_LDG:
+	asBC_CASE(asBC_LDG):
 		*(asPWORD*)&m_regs.valueRegister = asBC_PTRARG(l_bc);
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_LDV:
+	asBC_CASE(asBC_LDV):
 		*(asDWORD**)&m_regs.valueRegister = (l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_PGA:
+	asBC_CASE(asBC_PGA):
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = asBC_PTRARG(l_bc);
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_CmpPtr:
+	asBC_CASE(asBC_CmpPtr):
 		{
 			// TODO: runtime optimize: This instruction should really just be an equals, and return true or false.
 			//                         The instruction is only used for is and !is tests anyway.
@@ -3009,110 +3115,110 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_VAR:
+	asBC_CASE(asBC_VAR):
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = (asPWORD)asBC_SWORDARG0(l_bc);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
 	//----------------------------
 	// Type conversions
-	case asBC_iTOf:
+	asBC_CASE(asBC_iTOf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = float(*(int*)(l_fp - asBC_SWORDARG0(l_bc)));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_fTOi:
+	asBC_CASE(asBC_fTOi):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = int(*(float*)(l_fp - asBC_SWORDARG0(l_bc)));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_uTOf:
+	asBC_CASE(asBC_uTOf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = float(*(l_fp - asBC_SWORDARG0(l_bc)));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_fTOu:
+	asBC_CASE(asBC_fTOu):
 		// We must cast to int first, because on some compilers the cast of a negative float value to uint result in 0
 		*(l_fp - asBC_SWORDARG0(l_bc)) = asUINT(int(*(float*)(l_fp - asBC_SWORDARG0(l_bc))));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_sbTOi:
+	asBC_CASE(asBC_sbTOi):
 		// *(l_fp - offset) points to a char, and will point to an int afterwards
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(signed char*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_swTOi:
+	asBC_CASE(asBC_swTOi):
 		// *(l_fp - offset) points to a short, and will point to an int afterwards
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(short*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_ubTOi:
+	asBC_CASE(asBC_ubTOi):
 		// (l_fp - offset) points to a byte, and will point to an int afterwards
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(asBYTE*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_uwTOi:
+	asBC_CASE(asBC_uwTOi):
 		// *(l_fp - offset) points to a word, and will point to an int afterwards
 		*(l_fp - asBC_SWORDARG0(l_bc)) = *(asWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_dTOi:
+	asBC_CASE(asBC_dTOi):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = int(*(double*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_dTOu:
+	asBC_CASE(asBC_dTOu):
 		// We must cast to int first, because on some compilers the cast of a negative float value to uint result in 0
 		*(l_fp - asBC_SWORDARG0(l_bc)) = asUINT(int(*(double*)(l_fp - asBC_SWORDARG1(l_bc))));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_dTOf:
+	asBC_CASE(asBC_dTOf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = float(*(double*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_iTOd:
+	asBC_CASE(asBC_iTOd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = double(*(int*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_uTOd:
+	asBC_CASE(asBC_uTOd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = double(*(asUINT*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_fTOd:
+	asBC_CASE(asBC_fTOd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = double(*(float*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
 	//------------------------------
 	// Math operations
-	case asBC_ADDi:
+	asBC_CASE(asBC_ADDi):
 		*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) + *(int*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SUBi:
+	asBC_CASE(asBC_SUBi):
 		*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) - *(int*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MULi:
+	asBC_CASE(asBC_MULi):
 		*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) * *(int*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_DIVi:
+	asBC_CASE(asBC_DIVi):
 		{
 			int divider = *(int*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3145,9 +3251,9 @@ void asCContext::ExecuteNext()
 			*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) / divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MODi:
+	asBC_CASE(asBC_MODi):
 		{
 			int divider = *(int*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3180,24 +3286,24 @@ void asCContext::ExecuteNext()
 			*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) % divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_ADDf:
+	asBC_CASE(asBC_ADDf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) + *(float*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SUBf:
+	asBC_CASE(asBC_SUBf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) - *(float*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MULf:
+	asBC_CASE(asBC_MULf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) * *(float*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_DIVf:
+	asBC_CASE(asBC_DIVf):
 		{
 			float divider = *(float*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3214,9 +3320,9 @@ void asCContext::ExecuteNext()
 			*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) / divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MODf:
+	asBC_CASE(asBC_MODf):
 		{
 			float divider = *(float*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3233,24 +3339,24 @@ void asCContext::ExecuteNext()
 			*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = fmodf(*(float*)(l_fp - asBC_SWORDARG1(l_bc)), divider);
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_ADDd:
+	asBC_CASE(asBC_ADDd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) + *(double*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SUBd:
+	asBC_CASE(asBC_SUBd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) - *(double*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MULd:
+	asBC_CASE(asBC_MULd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) * *(double*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_DIVd:
+	asBC_CASE(asBC_DIVd):
 		{
 			double divider = *(double*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3268,9 +3374,9 @@ void asCContext::ExecuteNext()
 			*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) / divider;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_MODd:
+	asBC_CASE(asBC_MODd):
 		{
 			double divider = *(double*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3288,47 +3394,47 @@ void asCContext::ExecuteNext()
 			*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = fmod(*(double*)(l_fp - asBC_SWORDARG1(l_bc)), divider);
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
 	//------------------------------
 	// Math operations with constant value
-	case asBC_ADDIi:
+	asBC_CASE(asBC_ADDIi):
 		*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) + asBC_INTARG(l_bc+1);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_SUBIi:
+	asBC_CASE(asBC_SUBIi):
 		*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) - asBC_INTARG(l_bc+1);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_MULIi:
+	asBC_CASE(asBC_MULIi):
 		*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = *(int*)(l_fp - asBC_SWORDARG1(l_bc)) * asBC_INTARG(l_bc+1);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_ADDIf:
+	asBC_CASE(asBC_ADDIf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) + asBC_FLOATARG(l_bc+1);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_SUBIf:
+	asBC_CASE(asBC_SUBIf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) - asBC_FLOATARG(l_bc+1);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_MULIf:
+	asBC_CASE(asBC_MULIf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = *(float*)(l_fp - asBC_SWORDARG1(l_bc)) * asBC_FLOATARG(l_bc+1);
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
 	//-----------------------------------
-	case asBC_SetG4:
+	asBC_CASE(asBC_SetG4):
 		*(asDWORD*)asBC_PTRARG(l_bc) = asBC_DWORDARG(l_bc+AS_PTR_SIZE);
 		l_bc += 2 + AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_ChkRefS:
+	asBC_CASE(asBC_ChkRefS):
 		{
 			// Verify if the pointer on the stack refers to a non-null value
 			// This is used to validate a reference to a handle
@@ -3344,9 +3450,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_ChkNullV:
+	asBC_CASE(asBC_ChkNullV):
 		{
 			// Verify if variable (on the stack) is not null
 			asDWORD *a = *(asDWORD**)(l_fp - asBC_SWORDARG0(l_bc));
@@ -3361,9 +3467,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_CALLINTF:
+	asBC_CASE(asBC_CALLINTF):
 		{
 			int i = asBC_INTARG(l_bc);
 			l_bc += 2;
@@ -3387,9 +3493,9 @@ void asCContext::ExecuteNext()
 			if( m_status != asEXECUTION_ACTIVE )
 				return;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_iTOb:
+	asBC_CASE(asBC_iTOb):
 		{
 			// *(l_fp - offset) points to an int, and will point to a byte afterwards
 
@@ -3403,9 +3509,9 @@ void asCContext::ExecuteNext()
 			bPtr[3] = 0;
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_iTOw:
+	asBC_CASE(asBC_iTOw):
 		{
 			// *(l_fp - offset) points to an int, and will point to word afterwards
 
@@ -3417,9 +3523,9 @@ void asCContext::ExecuteNext()
 			wPtr[1] = 0;           // 0 the rest of the DWORD
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_SetV1:
+	asBC_CASE(asBC_SetV1):
 		// TODO: This is exactly the same as SetV4. This is a left over from the time
 		//       when the bytecode instructions were more tightly packed. It can now
 		//       be removed. When removing it, make sure the value is correctly converted
@@ -3428,9 +3534,9 @@ void asCContext::ExecuteNext()
 		// The byte is already stored correctly in the argument
 		*(l_fp - asBC_SWORDARG0(l_bc)) = asBC_DWORDARG(l_bc);
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SetV2:
+	asBC_CASE(asBC_SetV2):
 		// TODO: This is exactly the same as SetV4. This is a left over from the time
 		//       when the bytecode instructions were more tightly packed. It can now
 		//       be removed. When removing it, make sure the value is correctly converted
@@ -3439,9 +3545,9 @@ void asCContext::ExecuteNext()
 		// The word is already stored correctly in the argument
 		*(l_fp - asBC_SWORDARG0(l_bc)) = asBC_DWORDARG(l_bc);
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_Cast:
+	asBC_CASE(asBC_Cast):
 		// Cast the handle at the top of the stack to the type in the argument
 		{
 			asDWORD **a = (asDWORD**)*(asPWORD*)l_sp;
@@ -3473,49 +3579,49 @@ void asCContext::ExecuteNext()
 			l_sp += AS_PTR_SIZE;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_i64TOi:
+	asBC_CASE(asBC_i64TOi):
 		*(l_fp - asBC_SWORDARG0(l_bc)) = int(*(asINT64*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_uTOi64:
+	asBC_CASE(asBC_uTOi64):
 		*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = asINT64(*(asUINT*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_iTOi64:
+	asBC_CASE(asBC_iTOi64):
 		*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = asINT64(*(int*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_fTOi64:
+	asBC_CASE(asBC_fTOi64):
 		*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = asINT64(*(float*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_dTOi64:
+	asBC_CASE(asBC_dTOi64):
 		*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = asINT64(*(double*)(l_fp - asBC_SWORDARG0(l_bc)));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_fTOu64:
+	asBC_CASE(asBC_fTOu64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = asQWORD(asINT64(*(float*)(l_fp - asBC_SWORDARG1(l_bc))));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_dTOu64:
+	asBC_CASE(asBC_dTOu64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = asQWORD(asINT64(*(double*)(l_fp - asBC_SWORDARG0(l_bc))));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_i64TOf:
+	asBC_CASE(asBC_i64TOf):
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = float(*(asINT64*)(l_fp - asBC_SWORDARG1(l_bc)));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_u64TOf:
+	asBC_CASE(asBC_u64TOf):
 #if _MSC_VER <= 1200 // MSVC6
 		{
 			// MSVC6 doesn't permit UINT64 to double
@@ -3529,14 +3635,14 @@ void asCContext::ExecuteNext()
 		*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = float(*(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)));
 #endif
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_i64TOd:
+	asBC_CASE(asBC_i64TOd):
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = double(*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_u64TOd:
+	asBC_CASE(asBC_u64TOd):
 #if _MSC_VER <= 1200 // MSVC6
 		{
 			// MSVC6 doesn't permit UINT64 to double
@@ -3550,44 +3656,44 @@ void asCContext::ExecuteNext()
 		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = double(*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)));
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_NEGi64:
+	asBC_CASE(asBC_NEGi64):
 		*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = -*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_INCi64:
+	asBC_CASE(asBC_INCi64):
 		++(**(asQWORD**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_DECi64:
+	asBC_CASE(asBC_DECi64):
 		--(**(asQWORD**)&m_regs.valueRegister);
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_BNOT64:
+	asBC_CASE(asBC_BNOT64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = ~*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_ADDi64:
+	asBC_CASE(asBC_ADDi64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) + *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SUBi64:
+	asBC_CASE(asBC_SUBi64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) - *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MULi64:
+	asBC_CASE(asBC_MULi64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) * *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_DIVi64:
+	asBC_CASE(asBC_DIVi64):
 		{
 			asINT64 divider = *(asINT64*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3621,9 +3727,9 @@ void asCContext::ExecuteNext()
 			*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asINT64*)(l_fp - asBC_SWORDARG1(l_bc)) / divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MODi64:
+	asBC_CASE(asBC_MODi64):
 		{
 			asINT64 divider = *(asINT64*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3656,39 +3762,39 @@ void asCContext::ExecuteNext()
 			*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asINT64*)(l_fp - asBC_SWORDARG1(l_bc)) % divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_BAND64:
+	asBC_CASE(asBC_BAND64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) & *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_BOR64:
+	asBC_CASE(asBC_BOR64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) | *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_BXOR64:
+	asBC_CASE(asBC_BXOR64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) ^ *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_BSLL64:
+	asBC_CASE(asBC_BSLL64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) << *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_BSRL64:
+	asBC_CASE(asBC_BSRL64):
 		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) >> *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_BSRA64:
+	asBC_CASE(asBC_BSRA64):
 		*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asINT64*)(l_fp - asBC_SWORDARG1(l_bc)) >> *(l_fp - asBC_SWORDARG2(l_bc));
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPi64:
+	asBC_CASE(asBC_CMPi64):
 		{
 			asINT64 i1 = *(asINT64*)(l_fp - asBC_SWORDARG0(l_bc));
 			asINT64 i2 = *(asINT64*)(l_fp - asBC_SWORDARG1(l_bc));
@@ -3697,9 +3803,9 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CMPu64:
+	asBC_CASE(asBC_CMPu64):
 		{
 			asQWORD d1 = *(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 			asQWORD d2 = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc));
@@ -3708,9 +3814,9 @@ void asCContext::ExecuteNext()
 			else               *(int*)&m_regs.valueRegister =  1;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_ChkNullS:
+	asBC_CASE(asBC_ChkNullS):
 		{
 			// Verify if the pointer on the stack is null
 			// This is used for example when validating handles passed as function arguments
@@ -3726,9 +3832,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_ClrHi:
+	asBC_CASE(asBC_ClrHi):
 #if AS_SIZEOF_BOOL == 1
 		{
 			// Clear the upper bytes, so that trash data don't interfere with boolean operations
@@ -3745,9 +3851,9 @@ void asCContext::ExecuteNext()
 		// We don't have anything to do here
 #endif
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_JitEntry:
+	asBC_CASE(asBC_JitEntry):
 		{
 			if( m_currentFunction->scriptData->jitFunction )
 			{
@@ -3770,16 +3876,16 @@ void asCContext::ExecuteNext()
 					if( m_status != asEXECUTION_ACTIVE )
 						return;
 
-					break;
+					asBC_NEXT;
 				}
 			}
 
 			// Not a JIT resume point, treat as nop
 			l_bc += 1+AS_PTR_SIZE;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_CallPtr:
+	asBC_CASE(asBC_CallPtr):
 		{
 			// Get the function pointer from the local variable
 			asCScriptFunction *func = *(asCScriptFunction**)(l_fp - asBC_SWORDARG0(l_bc));
@@ -3854,16 +3960,16 @@ void asCContext::ExecuteNext()
 			if( m_status != asEXECUTION_ACTIVE )
 				return;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_FuncPtr:
+	asBC_CASE(asBC_FuncPtr):
 		// Push the function pointer on the stack. The pointer is in the argument
 		l_sp -= AS_PTR_SIZE;
 		*(asPWORD*)l_sp = asBC_PTRARG(l_bc);
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_LoadThisR:
+	asBC_CASE(asBC_LoadThisR):
 		{
 			// PshVPtr 0
 			asPWORD tmp = *(asPWORD*)l_fp;
@@ -3888,16 +3994,16 @@ void asCContext::ExecuteNext()
 			*(asPWORD*)&m_regs.valueRegister = tmp;
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
 	// Push the qword value of a variable on the stack
-	case asBC_PshV8:
+	asBC_CASE(asBC_PshV8):
 		l_sp -= 2;
 		*(asQWORD*)l_sp = *(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc));
 		l_bc++;
-		break;
+		asBC_NEXT;
 
-	case asBC_DIVu:
+	asBC_CASE(asBC_DIVu):
 		{
 			asUINT divider = *(asUINT*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3914,9 +4020,9 @@ void asCContext::ExecuteNext()
 			*(asUINT*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asUINT*)(l_fp - asBC_SWORDARG1(l_bc)) / divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MODu:
+	asBC_CASE(asBC_MODu):
 		{
 			asUINT divider = *(asUINT*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3933,9 +4039,9 @@ void asCContext::ExecuteNext()
 			*(asUINT*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asUINT*)(l_fp - asBC_SWORDARG1(l_bc)) % divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_DIVu64:
+	asBC_CASE(asBC_DIVu64):
 		{
 			asQWORD divider = *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3952,9 +4058,9 @@ void asCContext::ExecuteNext()
 			*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) / divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_MODu64:
+	asBC_CASE(asBC_MODu64):
 		{
 			asQWORD divider = *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc));
 			if( divider == 0 )
@@ -3971,9 +4077,9 @@ void asCContext::ExecuteNext()
 			*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) % divider;
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_LoadRObjR:
+	asBC_CASE(asBC_LoadRObjR):
 		{
 			// PshVPtr x
 			asPWORD tmp = *(asPWORD*)(l_fp - asBC_SWORDARG0(l_bc));
@@ -3998,9 +4104,9 @@ void asCContext::ExecuteNext()
 			*(asPWORD*)&m_regs.valueRegister = tmp;
 			l_bc += 3;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_LoadVObjR:
+	asBC_CASE(asBC_LoadVObjR):
 		{
 			// PSF x
 			asPWORD tmp = (asPWORD)(l_fp - asBC_SWORDARG0(l_bc));
@@ -4012,9 +4118,9 @@ void asCContext::ExecuteNext()
 			*(asPWORD*)&m_regs.valueRegister = tmp;
 			l_bc += 3;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_RefCpyV:
+	asBC_CASE(asBC_RefCpyV):
 		// Same as PSF v, REFCPY
 		{
 			asCObjectType *objType = (asCObjectType*)asBC_PTRARG(l_bc);
@@ -4046,23 +4152,23 @@ void asCContext::ExecuteNext()
 			*d = s;
 		}
 		l_bc += 1+AS_PTR_SIZE;
-		break;
+		asBC_NEXT;
 
-	case asBC_JLowZ:
+	asBC_CASE(asBC_JLowZ):
 		if( *(asBYTE*)&m_regs.valueRegister == 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_JLowNZ:
+	asBC_CASE(asBC_JLowNZ):
 		if( *(asBYTE*)&m_regs.valueRegister != 0 )
 			l_bc += asBC_INTARG(l_bc) + 2;
 		else
 			l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_AllocMem:
+	asBC_CASE(asBC_AllocMem):
 		// Allocate a buffer and store the pointer in the local variable
 		{
 			// TODO: runtime optimize: As the list buffers are going to be short lived, it may be interesting
@@ -4080,9 +4186,9 @@ void asCContext::ExecuteNext()
 			memset(*var, 0, size);
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SetListSize:
+	asBC_CASE(asBC_SetListSize):
 		{
 			// Set the size element in the buffer
 			asBYTE *var = *(asBYTE**)(l_fp - asBC_SWORDARG0(l_bc));
@@ -4094,9 +4200,9 @@ void asCContext::ExecuteNext()
 			*(asUINT*)(var+off) = size;
 		}
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
-	case asBC_PshListElmnt:
+	asBC_CASE(asBC_PshListElmnt):
 		{
 			// Push the pointer to the list element on the stack
 			// In essence it does the same as PSF, RDSPtr, ADDSi
@@ -4109,9 +4215,9 @@ void asCContext::ExecuteNext()
 			*(asPWORD*)l_sp = asPWORD(var+off);
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_SetListType:
+	asBC_CASE(asBC_SetListType):
 		{
 			// Set the type id in the buffer
 			asBYTE *var = *(asBYTE**)(l_fp - asBC_SWORDARG0(l_bc));
@@ -4123,11 +4229,11 @@ void asCContext::ExecuteNext()
 			*(asUINT*)(var+off) = type;
 		}
 		l_bc += 3;
-		break;
+		asBC_NEXT;
 
 	//------------------------------
 	// Exponent operations
-	case asBC_POWi:
+	asBC_CASE(asBC_POWi):
 		{
 			bool isOverflow;
 			*(int*)(l_fp - asBC_SWORDARG0(l_bc)) = as_powi(*(int*)(l_fp - asBC_SWORDARG1(l_bc)), *(int*)(l_fp - asBC_SWORDARG2(l_bc)), isOverflow);
@@ -4144,9 +4250,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_POWu:
+	asBC_CASE(asBC_POWu):
 		{
 			bool isOverflow;
 			*(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = as_powu(*(asDWORD*)(l_fp - asBC_SWORDARG1(l_bc)), *(asDWORD*)(l_fp - asBC_SWORDARG2(l_bc)), isOverflow);
@@ -4163,9 +4269,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_POWf:
+	asBC_CASE(asBC_POWf):
 		{
 			float r = powf(*(float*)(l_fp - asBC_SWORDARG1(l_bc)), *(float*)(l_fp - asBC_SWORDARG2(l_bc)));
 			*(float*)(l_fp - asBC_SWORDARG0(l_bc)) = r;
@@ -4182,9 +4288,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_POWd:
+	asBC_CASE(asBC_POWd):
 		{
 			double r = pow(*(double*)(l_fp - asBC_SWORDARG1(l_bc)), *(double*)(l_fp - asBC_SWORDARG2(l_bc)));
 			*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = r;
@@ -4201,9 +4307,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_POWdi:
+	asBC_CASE(asBC_POWdi):
 		{
 			double r = pow(*(double*)(l_fp - asBC_SWORDARG1(l_bc)), *(int*)(l_fp - asBC_SWORDARG2(l_bc)));
 			*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = r;
@@ -4220,9 +4326,9 @@ void asCContext::ExecuteNext()
 			}
 			l_bc += 2;
 		}
-		break;
+		asBC_NEXT;
 
-	case asBC_POWi64:
+	asBC_CASE(asBC_POWi64):
 		{
 			bool isOverflow;
 			*(asINT64*)(l_fp - asBC_SWORDARG0(l_bc)) = as_powi64(*(asINT64*)(l_fp - asBC_SWORDARG1(l_bc)), *(asINT64*)(l_fp - asBC_SWORDARG2(l_bc)), isOverflow);
@@ -4239,9 +4345,9 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
 
-	case asBC_POWu64:
+	asBC_CASE(asBC_POWu64):
 		{
 			bool isOverflow;
 			*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = as_powu64(*(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)), *(asQWORD*)(l_fp - asBC_SWORDARG2(l_bc)), isOverflow);
@@ -4258,29 +4364,159 @@ void asCContext::ExecuteNext()
 			}
 		}
 		l_bc += 2;
-		break;
+		asBC_NEXT;
+
+//------------------------------
+// Compare and jump, produced by the optimizer from
+// a compare instruction followed by a conditional jump.
+// The jump offset is always in the last argument
+
+	// Compare two int variables
+	asBC_CASE(asBC_JLTi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) < *(int*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JLEi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) <= *(int*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGTi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) > *(int*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGEi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) >= *(int*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JEQi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) == *(int*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JNEi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) != *(int*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	// Compare two uint variables
+	asBC_CASE(asBC_JLTu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) < *(asDWORD*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JLEu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) <= *(asDWORD*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGTu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) > *(asDWORD*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGEu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) >= *(asDWORD*)(l_fp - asBC_SWORDARG1(l_bc)) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	// Compare an int variable with a constant
+	asBC_CASE(asBC_JLTIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) < asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JLEIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) <= asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGTIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) > asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGEIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) >= asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JEQIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) == asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JNEIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) != asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	// Compare a uint variable with a constant
+	asBC_CASE(asBC_JLTIu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) < asBC_DWORDARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JLEIu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) <= asBC_DWORDARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGTIu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) > asBC_DWORDARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
+
+	asBC_CASE(asBC_JGEIu):
+		if( *(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) >= asBC_DWORDARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		asBC_NEXT;
 
 	// Don't let the optimizer optimize for size,
 	// since it requires extra conditions and jumps
-	case 201: l_bc = (asDWORD*)201; break;
-	case 202: l_bc = (asDWORD*)202; break;
-	case 203: l_bc = (asDWORD*)203; break;
-	case 204: l_bc = (asDWORD*)204; break;
-	case 205: l_bc = (asDWORD*)205; break;
-	case 206: l_bc = (asDWORD*)206; break;
-	case 207: l_bc = (asDWORD*)207; break;
-	case 208: l_bc = (asDWORD*)208; break;
-	case 209: l_bc = (asDWORD*)209; break;
-	case 210: l_bc = (asDWORD*)210; break;
-	case 211: l_bc = (asDWORD*)211; break;
-	case 212: l_bc = (asDWORD*)212; break;
-	case 213: l_bc = (asDWORD*)213; break;
-	case 214: l_bc = (asDWORD*)214; break;
-	case 215: l_bc = (asDWORD*)215; break;
-	case 216: l_bc = (asDWORD*)216; break;
-	case 217: l_bc = (asDWORD*)217; break;
-	case 218: l_bc = (asDWORD*)218; break;
-	case 219: l_bc = (asDWORD*)219; break;
 	case 220: l_bc = (asDWORD*)220; break;
 	case 221: l_bc = (asDWORD*)221; break;
 	case 222: l_bc = (asDWORD*)222; break;
@@ -4318,6 +4554,16 @@ void asCContext::ExecuteNext()
 	case 254: l_bc = (asDWORD*)254; break;
 	case 255: l_bc = (asDWORD*)255; break;
 
+#ifdef AS_USE_COMPUTED_GOTO
+	// Unknown bytecodes are sent here by the dispatch table
+	asBC_invalid_label:
+		m_regs.programPointer    = l_bc;
+		m_regs.stackPointer      = l_sp;
+		m_regs.stackFramePointer = l_fp;
+		SetInternalException(TXT_UNRECOGNIZED_BYTE_CODE);
+		return;
+#endif
+
 #ifdef AS_DEBUG
 	default:
 		asASSERT(false);
@@ -4336,6 +4582,7 @@ void asCContext::ExecuteNext()
 #ifdef AS_DEBUG
 		asDWORD instr = *(asBYTE*)old;
 		if( instr != asBC_JMP && instr != asBC_JMPP && (instr < asBC_JZ || instr > asBC_JNP) && instr != asBC_JLowZ && instr != asBC_JLowNZ &&
+			(instr < asBC_JLTi || instr > asBC_JGEIu) &&
 			instr != asBC_CALL && instr != asBC_CALLBND && instr != asBC_CALLINTF && instr != asBC_RET && instr != asBC_ALLOC && instr != asBC_CallPtr &&
 			instr != asBC_JitEntry )
 		{
@@ -4345,6 +4592,9 @@ void asCContext::ExecuteNext()
 	}
 }
 
+#undef asBC_CASE
+#undef asBC_NEXT
+
 int asCContext::SetException(const char *descr)
 {
 	// Only allow this if we're executing a CALL byte code
@@ -4917,6 +5167,39 @@ void asCContext::CallLineCallback()
 		m_engine->CallObjectMethod(m_lineCallbackObj, this, &m_lineCallbackFunc, 0);
 }
 
+// interface
+int asCContext::SetBreakpointCallback(asSFuncPtr callback, void *obj, int callConv)
+{
+	m_breakpointCallback = true;
+	m_breakpointCallbackObj = obj;
+	bool isObj = false;
+	if( (unsigned)callConv == asCALL_GENERIC || (unsigned)callConv == asCALL_THISCALL_OBJFIRST || (unsigned)callConv == asCALL_THISCALL_OBJLAST )
+	{
+		m_breakpointCallback = false;
+		return asNOT_SUPPORTED;
+	}
+	if( (unsigned)callConv >= asCALL_THISCALL )
+	{
+		isObj = true;
+		if( obj == 0 )
+		{
+			m_breakpointCallback = false;
+			return asINVALID_ARG;
+		}
+	}
+	int r = DetectCallingConvention(isObj, callback, callConv, 0, &m_breakpointCallbackFunc);
+	if( r < 0 ) m_breakpointCallback = false;
+	return r;
+}
+
+void asCContext::CallBreakpointCallback()
+{
+	if( m_breakpointCallbackFunc.callConv < ICC_THISCALL )
+		m_engine->CallGlobalFunction(this, m_breakpointCallbackObj, &m_breakpointCallbackFunc, 0);
+	else
+		m_engine->CallObjectMethod(m_breakpointCallbackObj, this, &m_breakpointCallbackFunc, 0);
+}
+
 // interface
 int asCContext::SetExceptionCallback(asSFuncPtr callback, void *obj, int callConv)
 {
@@ -4954,6 +5237,12 @@ void asCContext::ClearLineCallback()
 	m_regs.doProcessSuspend = m_doSuspend;
 }
 
+// interface
+void asCContext::ClearBreakpointCallback()
+{
+	m_breakpointCallback = false;
+}
+
 // interface
 void asCContext::ClearExceptionCallback()
 {
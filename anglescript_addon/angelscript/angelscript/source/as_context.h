@@ -108,6 +108,8 @@ public:
 	// Debugging
 	int                SetLineCallback(asSFuncPtr callback, void *obj, int callConv);
 	void               ClearLineCallback();
+	int                SetBreakpointCallback(asSFuncPtr callback, void *obj, int callConv);
+	void               ClearBreakpointCallback();
 	asUINT             GetCallstackSize() const;
 	asIScriptFunction *GetFunction(asUINT stackLevel);
 	int                GetLineNumber(asUINT stackLevel, int *column, const char **sectionName);
@@ -134,11 +136,13 @@ public:
 	friend class asCScriptEngine;
 
 	void CallLineCallback();
+	void CallBreakpointCallback();
 	void CallExceptionCallback();
 
 	int  CallGeneric(int funcID, void *objectPointer);
 
 	void DetachEngine();
+	void CleanUserData();
 
 	void ExecuteNext();
 	void CleanStack();
@@ -200,6 +204,10 @@ public:
 	asSSystemFunctionInterface m_lineCallbackFunc;
 	void *                     m_lineCallbackObj;
 
+	bool                       m_breakpointCallback;
+	asSSystemFunctionInterface m_breakpointCallbackFunc;
+	void *                     m_breakpointCallbackObj;
+
 	bool                       m_exceptionCallback;
 	asSSystemFunctionInterface m_exceptionCallbackFunc;
 	void *                     m_exceptionCallbackObj;
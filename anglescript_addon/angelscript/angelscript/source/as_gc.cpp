@@ -37,39 +37,131 @@
 
 
 #include <stdlib.h>
+#include <string.h> // memset
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+	#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <time.h>
+	#include <sys/time.h>
+#else
+	#include <time.h>
+#endif
 
 #include "as_gc.h"
 #include "as_scriptengine.h"
 #include "as_scriptobject.h"
 #include "as_texts.h"
 
+// The parallel cycle detection needs to be able to start threads
+#if !defined(AS_NO_THREADS) && (defined(AS_POSIX_THREADS) || defined(AS_WINDOWS_THREADS))
+	#define AS_GC_PARALLEL
+	#ifdef AS_POSIX_THREADS
+		#include <sched.h>
+	#endif
+#endif
+
 BEGIN_AS_NAMESPACE
 
+// The map entries are handed out to the threads in chunks of this size, and
+// the map must hold at least this many objects for the threads to be started
+static const asUINT gcParallelChunkSize  = 256;
+static const asUINT gcParallelMinObjects = 4096;
+
+// The work given to each thread when the cycle detection runs in parallel
+struct asSGCWorker
+{
+	asCGarbageCollector *gc;
+	int                  phase;
+	asCArray<asUINT>     stack;   // Indices of the map entries to enumerate while marking
+#ifdef AS_GC_PARALLEL
+#ifdef AS_POSIX_THREADS
+	pthread_t            thread;
+#else
+	HANDLE               thread;
+#endif
+	bool                 started;
+#endif
+};
+
+#ifdef AS_GC_PARALLEL
+#ifdef AS_POSIX_THREADS
+static void *GCWorkerThread(void *param)
+#else
+static DWORD WINAPI GCWorkerThread(LPVOID param)
+#endif
+{
+	asSGCWorker *worker = reinterpret_cast<asSGCWorker*>(param);
+	worker->gc->DoParallelWork(worker);
+
+	// Give the cached slab blocks back and free the thread local data
+	// that was allocated for the marking, as the thread ends here
+	asThreadCleanup();
+	return 0;
+}
+#endif
+
+// Returns a time stamp in microseconds, used for the time budget and the pause statistics
+static asQWORD GetTimeInMicroseconds()
+{
+#if defined(_WIN32)
+	static LARGE_INTEGER frequency = {0};
+	if( frequency.QuadPart == 0 )
+		QueryPerformanceFrequency(&frequency);
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return asQWORD(ticks.QuadPart / frequency.QuadPart * 1000000 + (ticks.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart);
+#elif defined(__unix__) || defined(__APPLE__)
+	#if defined(CLOCK_MONOTONIC)
+	timespec ts;
+	if( clock_gettime(CLOCK_MONOTONIC, &ts) == 0 )
+		return asQWORD(ts.tv_sec) * 1000000 + asQWORD(ts.tv_nsec) / 1000;
+	#endif
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return asQWORD(tv.tv_sec) * 1000000 + asQWORD(tv.tv_usec);
+#else
+	return asQWORD(clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+// The low bits of the object pointers are always zero due to the
+// alignment so the bits are mixed before masking with the table size
+static inline asUINT HashPointer(void *ptr)
+{
+	asUINT h = asUINT(asPWORD(ptr) >> 3) * 2654435761u;
+	return h ^ (h >> 15);
+}
+
 asCGarbageCollector::asCGarbageCollector()
 {
-	engine          = 0;
-	detectState     = clearCounters_init;
-	destroyNewState = destroyGarbage_init;
-	destroyOldState = destroyGarbage_init;
-	numDestroyed    = 0;
-	numNewDestroyed = 0;
-	numDetected     = 0;
-	numAdded        = 0;
-	isProcessing    = false;
-
-	seqAtSweepStart[0] = 0;
-	seqAtSweepStart[1] = 0;
-	seqAtSweepStart[2] = 0;
+	engine            = 0;
+	detectState       = clearCounters_init;
+	destroyNewState   = destroyGarbage_init;
+	destroyOldState   = destroyGarbage_init;
+	numDestroyed      = 0;
+	numNewDestroyed   = 0;
+	numDetected       = 0;
+	numAdded          = 0;
+	isProcessing      = false;
+	gcMapCursor       = 0;
+	runParallel       = false;
+	workersActive     = false;
+	nextChunk         = 0;
+	registeredWorkers = 0;
+	idleWorkers       = 0;
+
+	pauseCount = 0;
+	pauseTotal = 0;
+	pauseMax   = 0;
+	memset(pauseHistogram, 0, sizeof(pauseHistogram));
 }
 
 asCGarbageCollector::~asCGarbageCollector()
 {
-	// This local typedef is done to workaround a compiler error on
-	// MSVC6 when using the typedef declared in the class definition
-	typedef asSMapNode_t node_t;
-	for( asUINT n = 0; n < freeNodes.GetLength(); n++ )
-		asDELETE(freeNodes[n], node_t);
-	freeNodes.SetLength(0);
 }
 
 int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
@@ -81,7 +173,7 @@ int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
 	}
 
 	engine->CallObjectMethod(obj, objType->beh.addref);
-	asSObjTypePair ot = {obj, objType, 0};
+	asSObjTypePair ot = {obj, objType, 0, 0};
 
 	// Invoke the garbage collector to destroy a little garbage as new comes in
 	// This will maintain the number of objects in the GC at a maintainable level without
@@ -96,6 +188,7 @@ int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
 			if( !isProcessing )
 			{
 				isProcessing = true;
+				asQWORD start = GetTimeInMicroseconds();
 
 				// TODO: The number of iterations should be dynamic, and increase 
 				//       if the number of objects in the garbage collector grows high
@@ -113,6 +206,7 @@ int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
 				while( iter-- > 0 )
 					DestroyNewGarbage();
 
+				RecordPause(start);
 				isProcessing = false;
 			}
 
@@ -125,6 +219,7 @@ int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
 	ENTERCRITICALSECTION(gcCritical);
 	ot.seqNbr = numAdded++;
 	gcNewObjects.PushLast(ot);
+	objType->gcStats.created++;
 	LEAVECRITICALSECTION(gcCritical);
 
 	return ot.seqNbr;
@@ -176,11 +271,49 @@ int asCGarbageCollector::GarbageCollect(asDWORD flags, asUINT iterations)
 		}
 
 		isProcessing = true;
+		asQWORD start = GetTimeInMicroseconds();
 
 		bool doDetect  = (flags & asGC_DETECT_GARBAGE)  || !(flags & asGC_DESTROY_GARBAGE);
 		bool doDestroy = (flags & asGC_DESTROY_GARBAGE) || !(flags & asGC_DETECT_GARBAGE);
 
-		if( flags & asGC_FULL_CYCLE )
+		if( flags & asGC_TIME_BUDGET )
+		{
+			// Run the incremental steps until the deadline has passed or until each
+			// phase has completed its pass. A phase that has returned 0 isn't called 
+			// again, as it would just restart the pass over the same objects. The time
+			// is only checked every few steps as each step is usually much quicker
+			// than reading the clock
+			asQWORD deadline = start + iterations;
+			bool newDone    = !doDestroy;
+			bool oldDone    = !doDestroy;
+			bool detectDone = !doDetect || gcOldObjects.GetLength() == 0;
+			int r = 1;
+			for( asUINT n = 1; ; n++ )
+			{
+				if( !newDone && DestroyNewGarbage() == 0 )
+					newDone = true;
+				if( !oldDone && DestroyOldGarbage() == 0 )
+					oldDone = true;
+				if( !detectDone && IdentifyGarbageWithCyclicRefs() == 0 )
+					detectDone = true;
+
+				if( newDone && oldDone && detectDone )
+				{
+					// The cycle was completed within the budget
+					r = 0;
+					break;
+				}
+
+				if( (n & 15) == 0 && GetTimeInMicroseconds() >= deadline )
+					break;
+			}
+
+			RecordPause(start);
+			isProcessing = false;
+			LEAVECRITICALSECTION(gcCollecting);
+			return r;
+		}
+		else if( flags & asGC_FULL_CYCLE )
 		{
 			// Reset the state
 			if( doDetect )
@@ -199,6 +332,10 @@ int asCGarbageCollector::GarbageCollect(asDWORD flags, asUINT iterations)
 			// set of objects scanned for garbage is fixed even if new objects are added
 			// by other threads in parallel.
 			unsigned int count = (unsigned int)(gcOldObjects.GetLength());
+
+			// Only the full cycle lets the detection use the worker threads, as each
+			// parallel phase goes through the whole map in one step
+			runParallel = engine->ep.gcWorkerThreads > 0;
 			for(;;)
 			{
 				// Detect all garbage with cyclic references
@@ -230,6 +367,8 @@ int asCGarbageCollector::GarbageCollect(asDWORD flags, asUINT iterations)
 				}
 			}
 
+			runParallel = false;
+			RecordPause(start);
 			isProcessing = false;
 			LEAVECRITICALSECTION(gcCollecting);
 			return 0;
@@ -251,6 +390,7 @@ int asCGarbageCollector::GarbageCollect(asDWORD flags, asUINT iterations)
 			}
 		}
 
+		RecordPause(start);
 		isProcessing = false;
 		LEAVECRITICALSECTION(gcCollecting);
 	}
@@ -296,6 +436,49 @@ void asCGarbageCollector::GetStatistics(asUINT *currentSize, asUINT *totalDestro
 		*totalNewDestroyed = numNewDestroyed;
 }
 
+void asCGarbageCollector::GetPauseStatistics(asUINT *count, asQWORD *totalTime, asUINT *maxTime, asUINT *histogram, asUINT histogramSize) const
+{
+	// Like GetStatistics this isn't protected with a critical section
+	// so the values may be updated while they are being read
+
+	if( count )
+		*count = pauseCount;
+
+	if( totalTime )
+		*totalTime = pauseTotal;
+
+	if( maxTime )
+		*maxTime = pauseMax;
+
+	if( histogram && histogramSize )
+	{
+		// If the application's histogram is smaller, then the last bucket will also count the longer pauses
+		for( asUINT n = 0; n < histogramSize; n++ )
+			histogram[n] = n < PAUSE_BUCKETS ? pauseHistogram[n] : 0;
+		for( asUINT n = histogramSize; n < PAUSE_BUCKETS; n++ )
+			histogram[histogramSize-1] += pauseHistogram[n];
+	}
+}
+
+void asCGarbageCollector::RecordPause(asQWORD start)
+{
+	// This function will only be called within the critical section gcCollecting
+	asASSERT(isProcessing);
+
+	asQWORD now = GetTimeInMicroseconds();
+	asQWORD elapsed = now > start ? now - start : 0;
+
+	pauseCount++;
+	pauseTotal += elapsed;
+	if( elapsed > pauseMax )
+		pauseMax = elapsed > 0xFFFFFFFF ? 0xFFFFFFFF : asUINT(elapsed);
+
+	asUINT bucket = 0;
+	while( bucket < PAUSE_BUCKETS - 1 && (asQWORD(1) << bucket) <= elapsed )
+		bucket++;
+	pauseHistogram[bucket]++;
+}
+
 asCGarbageCollector::asSObjTypePair asCGarbageCollector::GetNewObjectAtIdx(int idx)
 {
 	// We need to protect this access with a critical section as
@@ -342,17 +525,28 @@ void asCGarbageCollector::RemoveOldObjectAtIdx(int idx)
 	LEAVECRITICALSECTION(gcCritical);
 }
 
-void asCGarbageCollector::MoveObjectToOldList(int idx)
+bool asCGarbageCollector::AgeNewObjectAtIdx(int idx)
 {
 	// We need to protect this update with a critical section as
 	// another thread might be appending an object at the same time
 	ENTERCRITICALSECTION(gcCritical);
-	gcOldObjects.PushLast(gcNewObjects[idx]);
-	if( idx == (int)gcNewObjects.GetLength() - 1)
-		gcNewObjects.PopLast();
-	else
-		gcNewObjects[idx] = gcNewObjects.PopLast();
+	asSObjTypePair &gcObj = gcNewObjects[idx];
+
+	// The type can override the engine's threshold
+	asUINT threshold = gcObj.type->gcPromotionThreshold >= 0 ? asUINT(gcObj.type->gcPromotionThreshold) : engine->ep.gcPromotionThreshold;
+	bool promote = ++gcObj.survived >= threshold;
+	if( promote )
+	{
+		gcObj.type->gcStats.promoted++;
+		gcOldObjects.PushLast(gcObj);
+		if( idx == (int)gcNewObjects.GetLength() - 1)
+			gcNewObjects.PopLast();
+		else
+			gcNewObjects[idx] = gcNewObjects.PopLast();
+	}
 	LEAVECRITICALSECTION(gcCritical);
+
+	return promote;
 }
 
 void asCGarbageCollector::MoveAllObjectsToOldList()
@@ -361,7 +555,11 @@ void asCGarbageCollector::MoveAllObjectsToOldList()
 	// another thread might be appending an object at the same time
 	ENTERCRITICALSECTION(gcCritical);
 	if( gcOldObjects.Concatenate(gcNewObjects) )
+	{
+		for( asUINT n = 0; n < gcNewObjects.GetLength(); n++ )
+			gcNewObjects[n].type->gcStats.promoted++;
 		gcNewObjects.SetLength(0);
+	}
 	LEAVECRITICALSECTION(gcCritical);
 }
 
@@ -380,12 +578,6 @@ int asCGarbageCollector::DestroyNewGarbage()
 			if( gcNewObjects.GetLength() == 0 )
 				return 0;
 
-			// Update the seqAtSweepStart which is used to determine when 
-			// to move an object from the new set to the old set
-			seqAtSweepStart[0] = seqAtSweepStart[1];
-			seqAtSweepStart[1] = seqAtSweepStart[2];
-			seqAtSweepStart[2] = numAdded;
-
 			destroyNewIdx = (asUINT)-1;
 			destroyNewState = destroyGarbage_loop;
 		}
@@ -410,6 +602,9 @@ int asCGarbageCollector::DestroyNewGarbage()
 
 					// Make sure the refCount is really 0, because the
 					// destructor may have increased the refCount again.
+					// The type's counter is updated before the release as the 
+					// type may be destroyed together with its last object
+					gcObj.type->gcStats.destroyedYoung++;
 					bool addRef = false;
 					if( gcObj.type->flags & asOBJ_SCRIPT_OBJECT )
 					{
@@ -432,21 +627,16 @@ int asCGarbageCollector::DestroyNewGarbage()
 					{
 						// Since the object was resurrected in the
 						// destructor, we must add our reference again
+						gcObj.type->gcStats.destroyedYoung--;
 						engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.addref);
 					}
 
 					destroyNewState = destroyGarbage_haveMore;
 				}
-				// Check if this object has been inspected 3 times already, and if so move it to the 
-				// set of old objects that are less likely to become garbage in a short time
-				// TODO: Is 3 really a good value? Should the number of times be dynamic? 
-				else if( gcObj.seqNbr < seqAtSweepStart[0] )
-				{
-					// We've already verified this object multiple times. It is likely
-					// to live for quite a long time so we'll move it to the list if old objects
-					MoveObjectToOldList(destroyNewIdx);
+				// Move the object to the set of old objects once it has survived enough sweeps. It
+				// is then likely to live for quite a long time and less likely to become garbage soon
+				else if( AgeNewObjectAtIdx(destroyNewIdx) )
 					destroyNewIdx--;
-				}
 
 				// Allow the application to work a little
 				return 1;
@@ -579,6 +769,7 @@ int asCGarbageCollector::DestroyOldGarbage()
 
 					// Make sure the refCount is really 0, because the
 					// destructor may have increased the refCount again.
+					gcObj.type->gcStats.destroyedOld++;
 					bool addRef = false;
 					if( gcObj.type->flags & asOBJ_SCRIPT_OBJECT )
 					{
@@ -600,6 +791,7 @@ int asCGarbageCollector::DestroyOldGarbage()
 					{
 						// Since the object was resurrected in the
 						// destructor, we must add our reference again
+						gcObj.type->gcStats.destroyedOld--;
 						engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.addref);
 					}
 
@@ -645,26 +837,26 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 		switch( detectState )
 		{
 		case clearCounters_init:
+			gcMapCursor = 0;
 			detectState = clearCounters_loop;
 		break;
 
 		case clearCounters_loop:
 		{
-			// Decrease reference counter for all objects removed from the map
-			asSMapNode<void*, asSIntTypePair> *cursor = 0;
-			gcMap.MoveFirst(&cursor);
-			if( cursor )
+			// Decrease reference counter for all objects left in the map
+			gcMapCursor = NextInMap(gcMapCursor);
+			if( gcMapCursor < gcMapEntries.GetLength() )
 			{
-				void *obj = gcMap.GetKey(cursor);
-				asSIntTypePair it = gcMap.GetValue(cursor);
-
-				engine->CallObjectMethod(obj, it.type->beh.release);
+				asSMapEntry &entry = gcMapEntries[gcMapCursor++];
+				asCObjectType *type = entry.type;
+				entry.type = 0;
 
-				ReturnNode(gcMap.Remove(cursor));
+				engine->CallObjectMethod(entry.obj, type->beh.release);
 
 				return 1;
 			}
 
+			ClearMap();
 			detectState = buildMap_init;
 		}
 		break;
@@ -696,12 +888,8 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 				if( gcObj.type->beh.gcGetRefCount )
 					refCount = engine->CallObjectMethodRetInt(gcObj.obj, gcObj.type->beh.gcGetRefCount);
 
-				if( refCount > 1 )
+				if( refCount > 1 && InsertInMap(gcObj.obj, refCount-1, gcObj.type) )
 				{
-					asSIntTypePair it = {refCount-1, gcObj.type};
-
-					gcMap.Insert(GetNode(gcObj.obj, it));
-
 					// Increment the object's reference counter when putting it in the map
 					engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.addref);
 
@@ -722,8 +910,20 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 		case countReferences_init:
 		{
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = 0;
 			detectState = countReferences_loop;
+
+			// Count the references for the whole map at once if the worker threads can be used.
+			// The references are counted separately and only subtracted when all are done
+			if( RunInParallel(parallel_countReferences) )
+			{
+				for( asUINT n = 0; n < gcMapEntries.GetLength(); n++ )
+				{
+					gcMapEntries[n].i -= gcMapEntries[n].found;
+					gcMapEntries[n].found = 0;
+				}
+				detectState = detectGarbage_init;
+			}
 		}
 		break;
 
@@ -740,11 +940,12 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 			// Any new objects created after this step in the GC cycle won't be
 			// in the map, and is thus automatically considered alive.
-			if( gcMapCursor )
+			gcMapCursor = NextInMap(gcMapCursor);
+			if( gcMapCursor < gcMapEntries.GetLength() )
 			{
-				void *obj = gcMap.GetKey(gcMapCursor);
-				asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
-				gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+				void *obj = gcMapEntries[gcMapCursor].obj;
+				asCObjectType *type = gcMapEntries[gcMapCursor].type;
+				gcMapCursor++;
 
 				if( engine->CallObjectMethodRetBool(obj, type->beh.gcGetFlag) )
 				{
@@ -761,9 +962,28 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 		case detectGarbage_init:
 		{
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = 0;
 			liveObjects.SetLength(0);
-			detectState = detectGarbage_loop1;
+
+			// Mark the live objects in the whole map at once if the worker threads can be used
+			detectState = detectGarbage_loop2;
+			if( RunInParallel(parallel_markLiveObjects) )
+			{
+				// Remove the marked objects from the map
+				for( asUINT n = 0; n < gcMapEntries.GetLength(); n++ )
+				{
+					asSMapEntry &entry = gcMapEntries[n];
+					if( entry.type && entry.marked )
+					{
+						engine->CallObjectMethod(entry.obj, entry.type->beh.release);
+						entry.type   = 0;
+						entry.marked = 0;
+					}
+				}
+				detectState = verifyUnmarked_init;
+			}
+			else
+				detectState = detectGarbage_loop1;
 		}
 		break;
 
@@ -777,16 +997,14 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 			// references were not found in the map.
 
 			// Add all alive objects from the map to the liveObjects array
-			if( gcMapCursor )
+			gcMapCursor = NextInMap(gcMapCursor);
+			if( gcMapCursor < gcMapEntries.GetLength() )
 			{
-				asSMapNode<void*, asSIntTypePair> *cursor = gcMapCursor;
-				gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+				const asSMapEntry &entry = gcMapEntries[gcMapCursor++];
+				void *obj = entry.obj;
 
-				void *obj = gcMap.GetKey(cursor);
-				asSIntTypePair it = gcMap.GetValue(cursor);
-
-				bool gcFlag = engine->CallObjectMethodRetBool(obj, it.type->beh.gcGetFlag);
-				if( !gcFlag || it.i > 0 )
+				bool gcFlag = engine->CallObjectMethodRetBool(obj, entry.type->beh.gcGetFlag);
+				if( !gcFlag || entry.i > 0 )
 				{
 					liveObjects.PushLast(obj);
 				}
@@ -811,11 +1029,11 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 				asCObjectType *type = 0;
 
 				// Remove the object from the map to mark it as alive
-				asSMapNode<void*, asSIntTypePair> *cursor = 0;
-				if( gcMap.MoveTo(&cursor, gcObj) )
+				int idx = FindInMap(gcObj);
+				if( idx >= 0 )
 				{
-					type = gcMap.GetValue(cursor).type;
-					ReturnNode(gcMap.Remove(cursor));
+					type = gcMapEntries[idx].type;
+					gcMapEntries[idx].type = 0;
 
 					// We need to decrease the reference count again as we remove the object from the map
 					engine->CallObjectMethod(gcObj, type->beh.release);
@@ -833,7 +1051,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 		break;
 
 		case verifyUnmarked_init:
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = 0;
 			detectState = verifyUnmarked_loop;
 			break;
 
@@ -842,10 +1060,11 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 			// In this step we must make sure that none of the objects still in the map
 			// has been touched by the application. If they have then we must run the
 			// detectGarbage loop once more.
-			if( gcMapCursor )
+			gcMapCursor = NextInMap(gcMapCursor);
+			if( gcMapCursor < gcMapEntries.GetLength() )
 			{
-				void *gcObj = gcMap.GetKey(gcMapCursor);
-				asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
+				void *gcObj = gcMapEntries[gcMapCursor].obj;
+				asCObjectType *type = gcMapEntries[gcMapCursor].type;
 
 				bool gcFlag = engine->CallObjectMethodRetBool(gcObj, type->beh.gcGetFlag);
 				if( !gcFlag )
@@ -854,7 +1073,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 					detectState = detectGarbage_init;
 				}
 				else
-					gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+					gcMapCursor++;
 
 				// Allow the application to work a little
 				return 1;
@@ -870,7 +1089,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 		case breakCircles_init:
 		{
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = 0;
 			detectState = breakCircles_loop;
 		}
 		break;
@@ -882,11 +1101,13 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 			// kept alive through circular references. To be able to free
 			// these objects we need to force the breaking of the circle
 			// by having the objects release their references.
-			if( gcMapCursor )
+			gcMapCursor = NextInMap(gcMapCursor);
+			if( gcMapCursor < gcMapEntries.GetLength() )
 			{
 				numDetected++;
-				void *gcObj = gcMap.GetKey(gcMapCursor);
-				asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
+				void *gcObj = gcMapEntries[gcMapCursor].obj;
+				asCObjectType *type = gcMapEntries[gcMapCursor].type;
+				type->gcStats.detected++;
 				if( type->flags & asOBJ_SCRIPT_OBJECT )
 				{
 					// For script objects we must call the class destructor before
@@ -897,7 +1118,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 				}
 				engine->CallObjectMethod(gcObj, engine, type->beh.gcReleaseAllReferences);
 
-				gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+				gcMapCursor++;
 
 				detectState = breakCircles_haveGarbage;
 
@@ -928,35 +1149,288 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 	UNREACHABLE_RETURN;
 }
 
-asCGarbageCollector::asSMapNode_t *asCGarbageCollector::GetNode(void *obj, asSIntTypePair it)
+int asCGarbageCollector::FindInMap(void *obj) const
+{
+	if( gcMapTable.GetLength() == 0 )
+		return -1;
+
+	asUINT mask = asUINT(gcMapTable.GetLength()) - 1;
+	for( asUINT h = HashPointer(obj) & mask; gcMapTable[h]; h = (h + 1) & mask )
+	{
+		const asSMapEntry &entry = gcMapEntries[gcMapTable[h] - 1];
+		if( entry.obj == obj )
+		{
+			// Removed entries are kept in the table, but with the type cleared
+			return entry.type ? int(gcMapTable[h] - 1) : -1;
+		}
+	}
+
+	return -1;
+}
+
+asUINT asCGarbageCollector::NextInMap(asUINT idx) const
+{
+	// Skip the entries that have been removed from the map
+	while( idx < gcMapEntries.GetLength() && gcMapEntries[idx].type == 0 )
+		idx++;
+	return idx;
+}
+
+bool asCGarbageCollector::InsertInMap(void *obj, int count, asCObjectType *type)
 {
 	// This function will only be called within the critical section gcCollecting
 	asASSERT(isProcessing);
 
-	asSMapNode_t *node;
-	if( freeNodes.GetLength() )
-		node = freeNodes.PopLast();
-	else
+	// Keep the table at most half full so the probe sequences stay short
+	asUINT length = asUINT(gcMapEntries.GetLength());
+	if( (length + 1) * 2 > gcMapTable.GetLength() )
 	{
-		node = asNEW(asSMapNode_t);
-		if( !node )
+		asUINT size = gcMapTable.GetLength() ? asUINT(gcMapTable.GetLength()) * 2 : 64;
+		if( !gcMapTable.SetLength(size) )
 		{
-			// Out of memory
-			return 0;
+			// Out of memory. The object will be considered alive
+			return false;
+		}
+		memset(gcMapTable.AddressOf(), 0, sizeof(asUINT) * size);
+
+		asUINT mask = size - 1;
+		for( asUINT n = 0; n < length; n++ )
+		{
+			asUINT h = HashPointer(gcMapEntries[n].obj) & mask;
+			while( gcMapTable[h] )
+				h = (h + 1) & mask;
+			gcMapTable[h] = n + 1;
 		}
 	}
-	
-	node->Init(obj, it);
-	return node;
+
+	asSMapEntry entry = {obj, count, type, 0, 0};
+	gcMapEntries.PushLast(entry);
+	if( gcMapEntries.GetLength() != length + 1 )
+	{
+		// Out of memory
+		return false;
+	}
+
+	asUINT mask = asUINT(gcMapTable.GetLength()) - 1;
+	asUINT h = HashPointer(obj) & mask;
+	while( gcMapTable[h] )
+		h = (h + 1) & mask;
+	gcMapTable[h] = length + 1;
+
+	return true;
+}
+
+void asCGarbageCollector::ClearMap()
+{
+	// This function will only be called within the critical section gcCollecting
+	asASSERT(isProcessing);
+
+	// Only the slots that were used are cleared, so the cost doesn't depend 
+	// on how large the table grew in earlier cycles. The entries are looked 
+	// up by their index so it doesn't matter that the probe sequences are
+	// broken as the slots are cleared
+	if( gcMapEntries.GetLength() )
+	{
+		asUINT mask = asUINT(gcMapTable.GetLength()) - 1;
+		for( asUINT n = 0; n < gcMapEntries.GetLength(); n++ )
+		{
+			asUINT h = HashPointer(gcMapEntries[n].obj) & mask;
+			while( gcMapTable[h] != n + 1 )
+				h = (h + 1) & mask;
+			gcMapTable[h] = 0;
+		}
+	}
+
+	gcMapEntries.SetLength(0);
 }
 
-void asCGarbageCollector::ReturnNode(asSMapNode_t *node)
+bool asCGarbageCollector::RunInParallel(egcParallelPhase phase)
 {
 	// This function will only be called within the critical section gcCollecting
 	asASSERT(isProcessing);
 
-	if( node )
-		freeNodes.PushLast(node);
+#ifdef AS_GC_PARALLEL
+	asUINT threads = engine->ep.gcWorkerThreads;
+	if( !runParallel || threads == 0 || gcMapEntries.GetLength() < gcParallelMinObjects )
+		return false;
+
+	// The calling thread must be able to take part as it may be the only one
+	// if the other threads cannot be started
+	if( asCThreadManager::GetLocalData() == 0 )
+		return false;
+
+	asCArray<asSGCWorker> workers;
+	if( !workers.SetLength(threads + 1) )
+		return false;
+
+	nextChunk         = 0;
+	registeredWorkers = 0;
+	idleWorkers       = 0;
+	sharedWork.SetLength(0);
+	workersActive     = true;
+
+	for( asUINT n = 0; n <= threads; n++ )
+	{
+		workers[n].gc      = this;
+		workers[n].phase   = phase;
+		workers[n].started = false;
+	}
+
+	// The work is handed out in chunks as the threads ask for it, so it
+	// doesn't matter if any of the threads fail to start
+	for( asUINT n = 1; n <= threads; n++ )
+	{
+#ifdef AS_POSIX_THREADS
+		workers[n].started = pthread_create(&workers[n].thread, 0, GCWorkerThread, &workers[n]) == 0;
+#else
+		workers[n].thread  = CreateThread(0, 0, GCWorkerThread, &workers[n], 0, 0);
+		workers[n].started = workers[n].thread != 0;
+#endif
+	}
+
+	DoParallelWork(&workers[0]);
+
+	for( asUINT n = 1; n <= threads; n++ )
+	{
+		if( !workers[n].started )
+			continue;
+#ifdef AS_POSIX_THREADS
+		pthread_join(workers[n].thread, 0);
+#else
+		WaitForSingleObject(workers[n].thread, INFINITE);
+		CloseHandle(workers[n].thread);
+#endif
+	}
+
+	workersActive = false;
+	return true;
+#else
+	UNUSED_VAR(phase);
+	return false;
+#endif
+}
+
+bool asCGarbageCollector::TakeParallelChunk(asUINT *first, asUINT *last)
+{
+	asUINT count = asUINT(gcMapEntries.GetLength());
+	asUINT chunk = asUINT(asAtomicInc(nextChunk) - 1);
+	if( chunk >= (count + gcParallelChunkSize - 1) / gcParallelChunkSize )
+		return false;
+
+	*first = chunk * gcParallelChunkSize;
+	*last  = *first + gcParallelChunkSize < count ? *first + gcParallelChunkSize : count;
+	return true;
+}
+
+void asCGarbageCollector::DoParallelWork(asSGCWorker *worker)
+{
+	// This function is called by the thread that holds the critical 
+	// section gcCollecting and by the worker threads it started
+	asASSERT(workersActive);
+
+	if( worker->phase == parallel_countReferences )
+	{
+		// Call EnumReferences on the objects in each chunk. The enum
+		// callback counts the references in the found member
+		asUINT first, last;
+		while( TakeParallelChunk(&first, &last) )
+		{
+			for( asUINT n = first; n < last; n++ )
+			{
+				const asSMapEntry &entry = gcMapEntries[n];
+				if( entry.type && engine->CallObjectMethodRetBool(entry.obj, entry.type->beh.gcGetFlag) )
+					engine->CallObjectMethod(entry.obj, engine, entry.type->beh.gcEnumReferences);
+			}
+		}
+	}
+	else
+		MarkLiveObjects(worker);
+}
+
+void asCGarbageCollector::MarkLiveObjects(asSGCWorker *worker)
+{
+	// The enum callback puts the objects it marks on the stack of the current thread
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	if( tld == 0 )
+		return;
+	tld->gcWorker = worker;
+
+	ENTERCRITICALSECTION(gcSharedWork);
+	registeredWorkers++;
+	LEAVECRITICALSECTION(gcSharedWork);
+
+	for(;;)
+	{
+		asUINT first, last;
+		if( TakeParallelChunk(&first, &last) )
+		{
+			// The objects that are referenced from outside the map are alive. 
+			// The marked member is incremented atomically so that only the 
+			// thread that marks an object enumerates its references
+			for( asUINT n = first; n < last; n++ )
+			{
+				asSMapEntry &entry = gcMapEntries[n];
+				if( entry.type == 0 || entry.marked )
+					continue;
+
+				bool gcFlag = engine->CallObjectMethodRetBool(entry.obj, entry.type->beh.gcGetFlag);
+				if( (!gcFlag || entry.i > 0) && asAtomicInc(entry.marked) == 1 )
+					worker->stack.PushLast(n);
+			}
+		}
+		else if( worker->stack.GetLength() == 0 )
+		{
+			// Wait for another thread to share its work. When all threads
+			// are waiting there are no more live objects to mark
+			ENTERCRITICALSECTION(gcSharedWork);
+			if( sharedWork.GetLength() == 0 )
+			{
+				idleWorkers++;
+				while( sharedWork.GetLength() == 0 && idleWorkers < registeredWorkers )
+				{
+					LEAVECRITICALSECTION(gcSharedWork);
+#ifdef AS_POSIX_THREADS
+					sched_yield();
+#elif defined(AS_WINDOWS_THREADS)
+					Sleep(0);
+#endif
+					ENTERCRITICALSECTION(gcSharedWork);
+				}
+
+				if( sharedWork.GetLength() == 0 )
+				{
+					LEAVECRITICALSECTION(gcSharedWork);
+					break;
+				}
+				idleWorkers--;
+			}
+
+			for( asUINT n = 0; n < gcParallelChunkSize && sharedWork.GetLength(); n++ )
+				worker->stack.PushLast(sharedWork.PopLast());
+			LEAVECRITICALSECTION(gcSharedWork);
+		}
+
+		// Enumerate the references of the live objects so they too are marked
+		while( worker->stack.GetLength() )
+		{
+			asSMapEntry &entry = gcMapEntries[worker->stack.PopLast()];
+			engine->CallObjectMethod(entry.obj, engine, entry.type->beh.gcEnumReferences);
+
+			// Give away half the work if any thread is waiting for it. The idle
+			// count is read without the lock, so it is only used as a hint
+			if( idleWorkers && worker->stack.GetLength() > 1 )
+			{
+				ENTERCRITICALSECTION(gcSharedWork);
+				asUINT keep = asUINT(worker->stack.GetLength()) / 2;
+				for( asUINT n = keep; n < worker->stack.GetLength(); n++ )
+					sharedWork.PushLast(worker->stack[n]);
+				worker->stack.SetLength(keep);
+				LEAVECRITICALSECTION(gcSharedWork);
+			}
+		}
+	}
+
+	tld->gcWorker = 0;
 }
 
 void asCGarbageCollector::GCEnumCallback(void *reference)
@@ -967,18 +1441,29 @@ void asCGarbageCollector::GCEnumCallback(void *reference)
 	if( detectState == countReferences_loop )
 	{
 		// Find the reference in the map
-		asSMapNode<void*, asSIntTypePair> *cursor = 0;
-		if( gcMap.MoveTo(&cursor, reference) )
+		int idx = FindInMap(reference);
+		if( idx >= 0 )
 		{
-			// Decrease the counter in the map for the reference
-			gcMap.GetValue(cursor).i--;
+			// Decrease the counter in the map for the reference. When the worker
+			// threads are used the references are counted separately
+			if( workersActive )
+				asAtomicInc(gcMapEntries[idx].found);
+			else
+				gcMapEntries[idx].i--;
 		}
 	}
+	else if( detectState == detectGarbage_loop2 && workersActive )
+	{
+		// Mark the object, unless another thread already did, and
+		// put it on this thread's stack to enumerate its references
+		int idx = FindInMap(reference);
+		if( idx >= 0 && gcMapEntries[idx].marked == 0 && asAtomicInc(gcMapEntries[idx].marked) == 1 )
+			asCThreadManager::GetLocalData()->gcWorker->stack.PushLast(asUINT(idx));
+	}
 	else if( detectState == detectGarbage_loop2 )
 	{
 		// Find the reference in the map
-		asSMapNode<void*, asSIntTypePair> *cursor = 0;
-		if( gcMap.MoveTo(&cursor, reference) )
+		if( FindInMap(reference) >= 0 )
 		{
 			// Add the object to the list of objects to mark as alive
 			liveObjects.PushLast(reference);
@@ -42,13 +42,13 @@
 
 #include "as_config.h"
 #include "as_array.h"
-#include "as_map.h"
 #include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
 class asCScriptEngine;
 class asCObjectType;
+struct asSGCWorker;
 
 class asCGarbageCollector
 {
@@ -58,18 +58,21 @@ public:
 
 	int    GarbageCollect(asDWORD flags, asUINT iterations);
 	void   GetStatistics(asUINT *currentSize, asUINT *totalDestroyed, asUINT *totalDetected, asUINT *newObjects, asUINT *totalNewDestroyed) const;
+	void   GetPauseStatistics(asUINT *count, asQWORD *totalTime, asUINT *maxTime, asUINT *histogram, asUINT histogramSize) const;
 	void   GCEnumCallback(void *reference);
 	int    AddScriptObjectToGC(void *obj, asCObjectType *objType);
 	int    GetObjectInGC(asUINT idx, asUINT *seqNbr, void **obj, asIObjectType **type);
 
 	int    ReportAndReleaseUndestroyedObjects();
 
+	// Executed by each thread when the cycle detection runs in parallel
+	void   DoParallelWork(asSGCWorker *worker);
+
 	asCScriptEngine *engine;
 
 protected:
-	struct asSObjTypePair {void *obj; asCObjectType *type; asUINT seqNbr;};
-	struct asSIntTypePair {int i; asCObjectType *type;};
-	typedef asSMapNode<void*, asSIntTypePair> asSMapNode_t;
+	struct asSObjTypePair {void *obj; asCObjectType *type; asUINT seqNbr; asUINT survived;};
+	struct asSMapEntry {void *obj; int i; asCObjectType *type; int found; int marked;};
 
 	enum egcDestroyState
 	{
@@ -96,6 +99,12 @@ protected:
 		breakCircles_haveGarbage
 	};
 
+	enum egcParallelPhase
+	{
+		parallel_countReferences = 0,
+		parallel_markLiveObjects
+	};
+
 	int            DestroyNewGarbage();
 	int            DestroyOldGarbage();
 	int            IdentifyGarbageWithCyclicRefs();
@@ -103,8 +112,20 @@ protected:
 	asSObjTypePair GetOldObjectAtIdx(int idx);
 	void           RemoveNewObjectAtIdx(int idx);
 	void           RemoveOldObjectAtIdx(int idx);
-	void           MoveObjectToOldList(int idx);
+	bool           AgeNewObjectAtIdx(int idx);
 	void           MoveAllObjectsToOldList();
+	void           RecordPause(asQWORD start);
+
+	// Helpers for the map of objects searched for cyclic references
+	int            FindInMap(void *obj) const;
+	asUINT         NextInMap(asUINT idx) const;
+	bool           InsertInMap(void *obj, int count, asCObjectType *type);
+	void           ClearMap();
+
+	// Helpers for the parallel cycle detection
+	bool           RunInParallel(egcParallelPhase phase);
+	bool           TakeParallelChunk(asUINT *first, asUINT *last);
+	void           MarkLiveObjects(asSGCWorker *worker);
 
 	// Holds all the objects known by the garbage collector
 	asCArray<asSObjTypePair>           gcNewObjects;
@@ -114,8 +135,21 @@ protected:
 	asCArray<void*>                    liveObjects;
 
 	// This map holds objects currently being searched for cyclic references, it also holds a 
-	// counter that gives the number of references to the object that the GC can't reach
-	asCMap<void*, asSIntTypePair>      gcMap;
+	// counter that gives the number of references to the object that the GC can't reach.
+	// The entries are kept in insertion order so the incremental steps can iterate over them
+	// with an index, and the open addressing table maps the object pointer to the entry 
+	// index + 1. Entries that are removed keep their slot with the type cleared. Both arrays 
+	// are only emptied between the detection cycles so the memory is reused.
+	asCArray<asSMapEntry>              gcMapEntries;
+	asCArray<asUINT>                   gcMapTable;
+
+	// Pause times for the calls that did some work, in microseconds. Each 
+	// histogram bucket n counts the pauses that were shorter than 2^n us
+	enum { PAUSE_BUCKETS = 24 };
+	asUINT                             pauseCount;
+	asQWORD                            pauseTotal;
+	asUINT                             pauseMax;
+	asUINT                             pauseHistogram[PAUSE_BUCKETS];
 
 	// State variables
 	egcDestroyState                    destroyNewState;
@@ -128,18 +162,24 @@ protected:
 	asUINT                             detectIdx;
 	asUINT                             numDetected;
 	asUINT                             numAdded;
-	asUINT                             seqAtSweepStart[3];
-	asSMapNode_t                      *gcMapCursor;
+	asUINT                             gcMapCursor;
 	bool                               isProcessing;
 
-	// We'll keep a pool of nodes to avoid allocating memory all the time
-	asSMapNode_t            *GetNode(void *obj, asSIntTypePair it);
-	void                     ReturnNode(asSMapNode_t *node);
-	asCArray<asSMapNode_t*>  freeNodes;
+	// State for the parallel cycle detection. It is only used during full cycles 
+	// when asEP_GC_WORKER_THREADS is set and the map holds enough objects. The 
+	// map entries are handed out in chunks, and while marking the live objects the
+	// threads that run out of work take the objects that others put in sharedWork
+	bool                               runParallel;
+	bool                               workersActive;
+	int                                nextChunk;
+	asCArray<asUINT>                   sharedWork;
+	asUINT                             registeredWorkers;
+	asUINT                             idleWorkers;
 
 	// Critical section for multithreaded access
 	DECLARECRITICALSECTION(gcCritical)   // Used for adding/removing objects
 	DECLARECRITICALSECTION(gcCollecting) // Used for processing
+	DECLARECRITICALSECTION(gcSharedWork) // Used by the worker threads to share the marking
 };
 
 END_AS_NAMESPACE
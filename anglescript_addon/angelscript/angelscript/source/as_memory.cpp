@@ -44,6 +44,7 @@
 
 #include "as_config.h"
 #include "as_memory.h"
+#include "as_atomic.h"
 #include "as_scriptnode.h"
 #include "as_bytecode.h"
 
@@ -173,6 +174,285 @@ void asFreeMem(void *mem)
 
 } // extern "C"
 
+//
+// Slab allocator
+//
+// Blocks of up to 1KB are taken from slabs that are split into blocks of the
+// same size class. Each thread keeps a short list of free blocks per class
+// and exchanges them with the shared pool in batches, so most allocations
+// and frees don't need any lock. Larger blocks go directly to malloc. Each
+// block is preceded by a header that tells which class it belongs to. The
+// slabs are never returned to the system, their blocks are just reused.
+//
+
+#if defined(AS_NO_THREADS)
+	#define AS_SLAB_THREAD_LOCAL
+#elif defined(_MSC_VER)
+	#define AS_SLAB_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+	#define AS_SLAB_THREAD_LOCAL __thread
+#else
+	// Without thread local storage all threads share one cache
+	#define AS_SLAB_THREAD_LOCAL
+	#define AS_SLAB_SHARED_CACHE
+#endif
+
+const asUINT SLAB_CLASS_COUNT = 20;
+const asUINT SLAB_MAX_SIZE    = 1024;
+const asUINT SLAB_SIZE        = 65536;
+const asUINT SLAB_BATCH       = 32;
+const asUINT SLAB_LARGE       = 0xFFFFFFFF;
+
+struct asSTypeMemStats
+{
+	asCAtomic allocCount;
+	asCAtomic refCount;   // One for the object type, plus one for each live object
+};
+
+struct asSSlabHeader
+{
+	asUINT sizeClass;
+	asUINT reserved;
+	union
+	{
+		asSTypeMemStats *typeStats;
+		asQWORD          align;
+	};
+};
+
+struct asSSlabCache
+{
+	void   *blocks[SLAB_CLASS_COUNT];
+	asUINT  count[SLAB_CLASS_COUNT];
+};
+
+static AS_SLAB_THREAD_LOCAL asSSlabCache slabCache;
+
+// The shared pool
+static void   *slabFreeBlocks[SLAB_CLASS_COUNT];
+static asUINT  slabFreeCount[SLAB_CLASS_COUNT];
+static asUINT  slabReservedBytes[SLAB_CLASS_COUNT];
+DECLARECRITICALSECTION(slabCritical)
+#ifdef AS_SLAB_SHARED_CACHE
+DECLARECRITICALSECTION(slabCacheCritical)
+#endif
+
+// Classes step by 16 bytes up to 128 bytes, and then by a quarter of the power of two
+static inline asUINT SlabSizeClass(size_t size)
+{
+	if( size <= 128 )
+		return size ? asUINT(size - 1) >> 4 : 0;
+
+	asUINT n = asUINT(size - 1);
+	asUINT bit = 7;
+	while( n >> (bit + 1) )
+		bit++;
+
+	return 8 + (bit - 7)*4 + ((n >> (bit - 2)) & 3);
+}
+
+static inline asUINT SlabBlockSize(asUINT sizeClass)
+{
+	if( sizeClass < 8 )
+		return (sizeClass + 1) << 4;
+
+	asUINT bit = 7 + (sizeClass - 8)/4;
+	return (5 + (sizeClass - 8)%4) << (bit - 2);
+}
+
+// Moves a batch of blocks from the shared pool to the cache, creating a new slab if necessary
+static void SlabRefill(asSSlabCache &cache, asUINT sizeClass)
+{
+	ENTERCRITICALSECTION(slabCritical);
+
+	if( slabFreeCount[sizeClass] == 0 )
+	{
+		asUINT blockSize = sizeof(asSSlabHeader) + SlabBlockSize(sizeClass);
+		asUINT count     = SLAB_SIZE / blockSize;
+		char  *slab      = (char*)malloc(count * blockSize);
+		if( slab )
+		{
+			for( asUINT n = count; n-- > 0; )
+			{
+				asSSlabHeader *header = (asSSlabHeader*)(slab + n*blockSize);
+				header->sizeClass = sizeClass;
+				header->typeStats = 0;
+
+				void **block = (void**)(header + 1);
+				*block = slabFreeBlocks[sizeClass];
+				slabFreeBlocks[sizeClass] = block;
+			}
+			slabFreeCount[sizeClass]     += count;
+			slabReservedBytes[sizeClass] += count * blockSize;
+		}
+	}
+
+	for( asUINT n = 0; n < SLAB_BATCH && slabFreeBlocks[sizeClass]; n++ )
+	{
+		void **block = (void**)slabFreeBlocks[sizeClass];
+		slabFreeBlocks[sizeClass] = *block;
+		slabFreeCount[sizeClass]--;
+
+		*block = cache.blocks[sizeClass];
+		cache.blocks[sizeClass] = block;
+		cache.count[sizeClass]++;
+	}
+
+	LEAVECRITICALSECTION(slabCritical);
+}
+
+// Moves blocks from the cache back to the shared pool
+static void SlabFlush(asSSlabCache &cache, asUINT sizeClass, asUINT count)
+{
+	ENTERCRITICALSECTION(slabCritical);
+
+	for( asUINT n = 0; n < count && cache.blocks[sizeClass]; n++ )
+	{
+		void **block = (void**)cache.blocks[sizeClass];
+		cache.blocks[sizeClass] = *block;
+		cache.count[sizeClass]--;
+
+		*block = slabFreeBlocks[sizeClass];
+		slabFreeBlocks[sizeClass] = block;
+		slabFreeCount[sizeClass]++;
+	}
+
+	LEAVECRITICALSECTION(slabCritical);
+}
+
+void asSlabThreadCleanup()
+{
+#ifndef AS_SLAB_SHARED_CACHE
+	for( asUINT n = 0; n < SLAB_CLASS_COUNT; n++ )
+		SlabFlush(slabCache, n, slabCache.count[n]);
+#endif
+}
+
+asSTypeMemStats *asCreateTypeMemStats()
+{
+	asSTypeMemStats *stats = asNEW(asSTypeMemStats);
+	if( stats )
+		stats->refCount.set(1);
+	return stats;
+}
+
+void asReleaseTypeMemStats(asSTypeMemStats *stats)
+{
+	if( stats && stats->refCount.atomicDec() == 0 )
+		asDELETE(stats, asSTypeMemStats);
+}
+
+void asGetTypeMemStats(const asSTypeMemStats *stats, asUINT *allocCount, asUINT *liveCount)
+{
+	if( allocCount ) *allocCount = stats ? stats->allocCount.get() : 0;
+	if( liveCount )  *liveCount  = stats ? stats->refCount.get() - 1 : 0;
+}
+
+void asSlabSetTypeMemStats(void *mem, asSTypeMemStats *stats)
+{
+	stats->allocCount.atomicInc();
+	stats->refCount.atomicInc();
+
+	asSSlabHeader *header = ((asSSlabHeader*)mem) - 1;
+	header->typeStats = stats;
+}
+
+extern "C"
+{
+
+// interface
+void *asSlabAlloc(size_t size)
+{
+	if( size > SLAB_MAX_SIZE )
+	{
+		asSSlabHeader *header = (asSSlabHeader*)malloc(sizeof(asSSlabHeader) + size);
+		if( header == 0 )
+			return 0;
+
+		header->sizeClass = SLAB_LARGE;
+		header->typeStats = 0;
+		return header + 1;
+	}
+
+	asUINT sizeClass = SlabSizeClass(size);
+
+#ifdef AS_SLAB_SHARED_CACHE
+	ENTERCRITICALSECTION(slabCacheCritical);
+#endif
+
+	if( slabCache.blocks[sizeClass] == 0 )
+		SlabRefill(slabCache, sizeClass);
+
+	void **block = (void**)slabCache.blocks[sizeClass];
+	if( block )
+	{
+		slabCache.blocks[sizeClass] = *block;
+		slabCache.count[sizeClass]--;
+	}
+
+#ifdef AS_SLAB_SHARED_CACHE
+	LEAVECRITICALSECTION(slabCacheCritical);
+#endif
+
+	return block;
+}
+
+// interface
+void asSlabFree(void *mem)
+{
+	if( mem == 0 )
+		return;
+
+	asSSlabHeader *header = ((asSSlabHeader*)mem) - 1;
+	if( header->typeStats )
+	{
+		asSTypeMemStats *stats = header->typeStats;
+		header->typeStats = 0;
+		asReleaseTypeMemStats(stats);
+	}
+
+	if( header->sizeClass == SLAB_LARGE )
+	{
+		free(header);
+		return;
+	}
+
+	asUINT sizeClass = header->sizeClass;
+
+#ifdef AS_SLAB_SHARED_CACHE
+	ENTERCRITICALSECTION(slabCacheCritical);
+#endif
+
+	void **block = (void**)mem;
+	*block = slabCache.blocks[sizeClass];
+	slabCache.blocks[sizeClass] = block;
+
+	// Don't let one thread hold on to too many free blocks
+	if( ++slabCache.count[sizeClass] >= 2*SLAB_BATCH )
+		SlabFlush(slabCache, sizeClass, SLAB_BATCH);
+
+#ifdef AS_SLAB_SHARED_CACHE
+	LEAVECRITICALSECTION(slabCacheCritical);
+#endif
+}
+
+// interface
+int asGetSlabStatistics(asUINT sizeClass, asUINT *blockSize, asUINT *reservedBytes, asUINT *freeBlocks)
+{
+	if( sizeClass >= SLAB_CLASS_COUNT )
+		return asINVALID_ARG;
+
+	ENTERCRITICALSECTION(slabCritical);
+	if( blockSize )     *blockSize     = SlabBlockSize(sizeClass);
+	if( reservedBytes ) *reservedBytes = slabReservedBytes[sizeClass];
+	if( freeBlocks )    *freeBlocks    = slabFreeCount[sizeClass];
+	LEAVECRITICALSECTION(slabCritical);
+
+	return asSUCCESS;
+}
+
+} // extern "C"
+
 asCMemoryMgr::asCMemoryMgr()
 {
 }
@@ -108,6 +108,20 @@ END_AS_NAMESPACE
 
 BEGIN_AS_NAMESPACE
 
+// Allocation statistics of an object type. The counters are only kept
+// while the slab allocator is registered as the global memory functions
+struct asSTypeMemStats;
+
+asSTypeMemStats *asCreateTypeMemStats();
+void             asReleaseTypeMemStats(asSTypeMemStats *stats);
+void             asGetTypeMemStats(const asSTypeMemStats *stats, asUINT *allocCount, asUINT *liveCount);
+
+// Associates a block from asSlabAlloc with the object type it holds
+void             asSlabSetTypeMemStats(void *mem, asSTypeMemStats *stats);
+
+// Returns the blocks in the calling thread's cache to the shared pool
+void             asSlabThreadCleanup();
+
 class asCMemoryMgr
 {
 public:
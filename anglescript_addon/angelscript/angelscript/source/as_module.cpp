@@ -1209,10 +1209,23 @@ bool asCModule::IsEmpty() const
 
 // interface
 int asCModule::SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const
+{
+	return InternalSaveByteCode(out, stripDebugInfo, false);
+}
+
+// interface
+int asCModule::SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo) const
+{
+	return InternalSaveByteCode(out, stripDebugInfo, true);
+}
+
+// internal
+int asCModule::InternalSaveByteCode(asIBinaryStream *out, bool stripDebugInfo, bool writeImage) const
 {
 #ifdef AS_NO_COMPILER
 	UNUSED_VAR(out);
 	UNUSED_VAR(stripDebugInfo);
+	UNUSED_VAR(writeImage);
 	return asNOT_SUPPORTED;
 #else
 	if( out == 0 ) return asINVALID_ARG;
@@ -1221,7 +1234,7 @@ int asCModule::SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const
 	if( IsEmpty() )
 		return asERROR;
 
-	asCWriter write(const_cast<asCModule*>(this), out, engine, stripDebugInfo);
+	asCWriter write(const_cast<asCModule*>(this), out, engine, stripDebugInfo, writeImage);
 	return write.Write();
 #endif
 }
@@ -1231,13 +1244,28 @@ int asCModule::LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped)
 {
 	if( in == 0 ) return asINVALID_ARG;
 
+	asCReader read(this, in, engine);
+	return InternalLoadByteCode(read, wasDebugInfoStripped);
+}
+
+// interface
+int asCModule::LoadByteCodeImage(const void *image, asUINT size, bool *wasDebugInfoStripped)
+{
+	if( image == 0 || size == 0 ) return asINVALID_ARG;
+
+	asCReader read(this, image, size, engine);
+	return InternalLoadByteCode(read, wasDebugInfoStripped);
+}
+
+// internal
+int asCModule::InternalLoadByteCode(asCReader &read, bool *wasDebugInfoStripped)
+{
 	// Only permit loading bytecode if no other thread is currently compiling
 	// TODO: It should be possible to have multiple threads perform compilations
 	int r = engine->RequestBuild();
 	if( r < 0 )
 		return r;
 
-	asCReader read(this, in, engine);
 	r = read.Read(wasDebugInfoStripped);
 
 	JITCompile();
@@ -58,6 +58,7 @@ class asCCompiler;
 class asCBuilder;
 class asCContext;
 class asCConfigGroup;
+class asCReader;
 struct asSNameSpace;
 
 struct sBindInfo
@@ -158,6 +159,8 @@ public:
 	// Bytecode Saving/Loading
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const;
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped);
+	virtual int SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo) const;
+	virtual int LoadByteCodeImage(const void *image, asUINT size, bool *wasDebugInfoStripped);
 
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type);
@@ -184,6 +187,9 @@ public:
 
 	void JITCompile();
 
+	int  InternalSaveByteCode(asIBinaryStream *out, bool stripDebugInfo, bool writeImage) const;
+	int  InternalLoadByteCode(asCReader &reader, bool *wasDebugInfoStripped);
+
 #ifndef AS_NO_COMPILER
 	int  AddScriptFunction(int sectionIdx, int declaredAt, int id, const asCString &name, const asCDataType &returnType, const asCArray<asCDataType> &params, const asCArray<asCString> &paramNames, const asCArray<asETypeModifiers> &inOutFlags, const asCArray<asCString *> &defaultArgs, bool isInterface, asCObjectType *objType = 0, bool isConstMethod = false, bool isGlobalFunction = false, bool isPrivate = false, bool isFinal = false, bool isOverride = false, bool isShared = false, asSNameSpace *ns = 0);
 	int  AddScriptFunction(asCScriptFunction *func);
@@ -33,6 +33,8 @@
 #define AS_NAMESPACE_H
 
 #include "as_string.h"
+#include "as_array.h"
+#include "as_memory.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -71,6 +73,113 @@ struct asSNameSpaceNamePair
 	}
 };
 
+// Hash table from namespace and name to a value, used by the engine to cache
+// lookups done by the application at runtime. Entries can only be added or all
+// removed at once, which is all a cache needs
+template <class VAL> class asCNameHashMap
+{
+public:
+	asCNameHashMap() : count(0) {}
+	~asCNameHashMap() { EraseAll(); }
+
+	bool Find(const asSNameSpace *ns, const char *name, VAL *value) const
+	{
+		if( count == 0 )
+			return false;
+
+		asUINT hash = Hash(ns, name);
+		asUINT mask = asUINT(slots.GetLength()) - 1;
+		for( asUINT n = hash & mask; slots[n]; n = (n + 1) & mask )
+		{
+			const SEntry *entry = slots[n];
+			if( entry->hash == hash && entry->ns == ns && entry->name == name )
+			{
+				*value = entry->value;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// The caller must make sure the name isn't already in the map
+	void Insert(const asSNameSpace *ns, const char *name, const VAL &value)
+	{
+		// Keep the table at most half full
+		if( (count + 1) * 2 > slots.GetLength() )
+			Rehash(slots.GetLength() ? asUINT(slots.GetLength()) * 2 : 32);
+
+		SEntry *entry = asNEW(SEntry);
+		if( entry == 0 )
+			return;
+
+		entry->hash  = Hash(ns, name);
+		entry->ns    = ns;
+		entry->name  = name;
+		entry->value = value;
+		Place(slots, entry);
+		count++;
+	}
+
+	void EraseAll()
+	{
+		for( asUINT n = 0; n < slots.GetLength(); n++ )
+			if( slots[n] )
+				asDELETE(slots[n], SEntry);
+		slots.SetLength(0);
+		count = 0;
+	}
+
+protected:
+	struct SEntry
+	{
+		asUINT              hash;
+		const asSNameSpace *ns;
+		asCString           name;
+		VAL                 value;
+	};
+
+	static asUINT Hash(const asSNameSpace *ns, const char *name)
+	{
+		// FNV-1a on the name, seeded with the namespace pointer
+		asUINT h = 2166136261u ^ asUINT(asPWORD(ns) >> 4);
+		for( ; *name; name++ )
+			h = (h ^ asBYTE(*name)) * 16777619u;
+		return h ^ (h >> 15);
+	}
+
+	static void Place(asCArray<SEntry*> &table, SEntry *entry)
+	{
+		asUINT mask = asUINT(table.GetLength()) - 1;
+		asUINT n = entry->hash & mask;
+		while( table[n] )
+			n = (n + 1) & mask;
+		table[n] = entry;
+	}
+
+	void Rehash(asUINT size)
+	{
+		asCArray<SEntry*> table;
+		table.SetLength(size);
+		if( table.GetLength() != size )
+			return;
+		for( asUINT n = 0; n < size; n++ )
+			table[n] = 0;
+
+		for( asUINT n = 0; n < slots.GetLength(); n++ )
+			if( slots[n] )
+				Place(table, slots[n]);
+
+		slots.SwapWith(table);
+	}
+
+	// Don't allow value assignment
+	asCNameHashMap &operator=(const asCNameHashMap &) { return *this; }
+
+	asCArray<SEntry*> slots;
+	asUINT            count;
+};
+
 END_AS_NAMESPACE
 
 #endif
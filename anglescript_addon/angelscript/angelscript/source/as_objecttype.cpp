@@ -37,6 +37,7 @@
 
 
 #include <stdio.h>
+#include <string.h> // memset
 
 #include "as_config.h"
 #include "as_objecttype.h"
@@ -136,6 +137,11 @@ asCObjectType::asCObjectType()
 #ifdef WIP_16BYTE_ALIGN
 	alignment = 4;
 #endif
+
+	memStats = asCreateTypeMemStats();
+
+	memset(&gcStats, 0, sizeof(gcStats));
+	gcPromotionThreshold = -1;
 }
 
 asCObjectType::asCObjectType(asCScriptEngine *engine) 
@@ -153,6 +159,11 @@ asCObjectType::asCObjectType(asCScriptEngine *engine)
 #ifdef WIP_16BYTE_ALIGN
 	alignment = 4;
 #endif
+
+	memStats = asCreateTypeMemStats();
+
+	memset(&gcStats, 0, sizeof(gcStats));
+	gcPromotionThreshold = -1;
 }
 
 int asCObjectType::AddRef() const
@@ -331,6 +342,39 @@ void asCObjectType::DestroyInternal()
 asCObjectType::~asCObjectType()
 {
 	DestroyInternal();
+
+	// Objects that are still alive keep the statistics until they are freed
+	asReleaseTypeMemStats(memStats);
+}
+
+// interface
+void asCObjectType::GetMemoryStatistics(asUINT *allocCount, asUINT *liveCount) const
+{
+	asGetTypeMemStats(memStats, allocCount, liveCount);
+}
+
+// interface
+void asCObjectType::GetGCStatistics(asUINT *created, asUINT *destroyedYoung, asUINT *promoted, asUINT *destroyedOld, asUINT *detected) const
+{
+	// The counters are updated by the garbage collector without 
+	// synchronizing with this, so they may not match perfectly
+	if( created )        *created        = gcStats.created;
+	if( destroyedYoung ) *destroyedYoung = gcStats.destroyedYoung;
+	if( promoted )       *promoted       = gcStats.promoted;
+	if( destroyedOld )   *destroyedOld   = gcStats.destroyedOld;
+	if( detected )       *detected       = gcStats.detected;
+}
+
+// interface
+void asCObjectType::SetGCPromotionThreshold(int sweeps)
+{
+	gcPromotionThreshold = sweeps < 0 ? -1 : sweeps;
+}
+
+// interface
+int asCObjectType::GetGCPromotionThreshold() const
+{
+	return gcPromotionThreshold;
 }
 
 // interface
@@ -108,6 +108,7 @@ struct asSEnumValue
 
 class asCScriptEngine;
 struct asSNameSpace;
+struct asSTypeMemStats;
 
 void RegisterObjectTypeGCBehaviours(asCScriptEngine *engine);
 
@@ -163,6 +164,14 @@ public:
 	asUINT             GetBehaviourCount() const;
 	asIScriptFunction *GetBehaviourByIndex(asUINT index, asEBehaviours *outBehaviour) const;
 
+	// Memory statistics
+	void               GetMemoryStatistics(asUINT *allocCount, asUINT *liveCount) const;
+
+	// Garbage collector statistics
+	void               GetGCStatistics(asUINT *created, asUINT *destroyedYoung, asUINT *promoted, asUINT *destroyedOld, asUINT *detected) const;
+	void               SetGCPromotionThreshold(int sweeps);
+	int                GetGCPromotionThreshold() const;
+
 	// User data
 	void *SetUserData(void *data, asPWORD type);
 	void *GetUserData(asPWORD type) const;
@@ -219,6 +228,21 @@ public:
 	asCModule        *module;
 	asCArray<asPWORD> userData;
 
+	// Counts the objects allocated by CallAlloc
+	asSTypeMemStats  *memStats;
+
+	// Updated by the garbage collector. The objects destroyed
+	// from the old list include the ones freed by the detection
+	struct
+	{
+		asUINT created;
+		asUINT destroyedYoung;
+		asUINT promoted;
+		asUINT destroyedOld;
+		asUINT detected;
+	}                 gcStats;
+	int               gcPromotionThreshold;
+
 protected:
 	friend class asCScriptEngine;
 	asCObjectType();
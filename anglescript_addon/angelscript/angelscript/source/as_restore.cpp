@@ -48,11 +48,50 @@ asCReader::asCReader(asCModule* _module, asIBinaryStream* _stream, asCScriptEngi
 {
 	error = false;
 	bytesRead = 0;
+	buffer = 0;
+	bufferSize = 0;
+	bufferPos = 0;
+	bufferEnd = 0;
+	isImage = false;
+	memset(&imageHeader, 0, sizeof(imageHeader));
+}
+
+asCReader::asCReader(asCModule* _module, const void *_buffer, asUINT _size, asCScriptEngine* _engine)
+ : module(_module), stream(0), engine(_engine)
+{
+	error = false;
+	bytesRead = 0;
+	buffer = (const asBYTE*)_buffer;
+	bufferSize = _size;
+	bufferPos = 0;
+	bufferEnd = _size;
+	isImage = false;
+	memset(&imageHeader, 0, sizeof(imageHeader));
 }
 
 void asCReader::ReadData(void *data, asUINT size)
 {
 	asASSERT(size == 1 || size == 2 || size == 4 || size == 8);
+	if( buffer )
+	{
+		if( size > bufferEnd - bufferPos )
+		{
+			memset(data, 0, size);
+			Error(TXT_INVALID_BYTECODE_d);
+			return;
+		}
+
+#if defined(AS_BIG_ENDIAN)
+		memcpy(data, buffer + bufferPos, size);
+#else
+		for( asUINT n = 0; n < size; n++ )
+			((asBYTE*)data)[n] = buffer[bufferPos + size - 1 - n];
+#endif
+		bufferPos += size;
+		bytesRead += size;
+		return;
+	}
+
 #if defined(AS_BIG_ENDIAN)
 	for( asUINT n = 0; n < size; n++ )
 		stream->Read(((asBYTE*)data)+n, 1);
@@ -63,6 +102,69 @@ void asCReader::ReadData(void *data, asUINT size)
 	bytesRead += size;
 }
 
+void asCReader::ReadRawData(void *data, asUINT size)
+{
+	if( buffer )
+	{
+		if( size > bufferEnd - bufferPos )
+		{
+			memset(data, 0, size);
+			Error(TXT_INVALID_BYTECODE_d);
+			return;
+		}
+
+		memcpy(data, buffer + bufferPos, size);
+		bufferPos += size;
+		return;
+	}
+
+	stream->Read(data, size);
+}
+
+int asCReader::ReadImageHeader()
+{
+	// The stream format starts with the flag for stripped debug info, so
+	// it is loaded as before if the buffer doesn't start with the magic
+	if( bufferSize < 4 || memcmp(buffer, "ASBI", 4) != 0 )
+		return asSUCCESS;
+
+	// A truncated image must not be decoded as the stream format
+	if( bufferSize < sizeof(asSByteCodeImageHeader) )
+		return Error(TXT_INVALID_BYTECODE_d);
+
+	memcpy(&imageHeader, buffer, sizeof(asSByteCodeImageHeader));
+
+#if defined(AS_BIG_ENDIAN)
+	const asBYTE isBigEndian = 1;
+#else
+	const asBYTE isBigEndian = 0;
+#endif
+	if( imageHeader.version != AS_BYTECODE_IMAGE_VERSION ||
+		imageHeader.pointerSize != AS_PTR_SIZE ||
+		imageHeader.isBigEndian != isBigEndian ||
+		imageHeader.libraryVersion != ANGELSCRIPT_VERSION )
+	{
+		engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_BYTECODE_IMAGE_INCOMPATIBLE);
+		error = true;
+		return asNOT_SUPPORTED;
+	}
+
+	// Make sure all the sections are within the buffer
+	if( imageHeader.stringTableOffset > bufferSize ||
+		imageHeader.stringCount > (bufferSize - imageHeader.stringTableOffset) / (2*sizeof(asDWORD)) ||
+		imageHeader.byteCodeOffset > bufferSize ||
+		imageHeader.byteCodeLength > (bufferSize - imageHeader.byteCodeOffset) / sizeof(asDWORD) ||
+		imageHeader.bodyOffset > bufferSize ||
+		imageHeader.bodySize > bufferSize - imageHeader.bodyOffset )
+		return Error(TXT_INVALID_BYTECODE_d);
+
+	isImage = true;
+	bufferPos = imageHeader.bodyOffset;
+	bufferEnd = imageHeader.bodyOffset + imageHeader.bodySize;
+
+	return asSUCCESS;
+}
+
 int asCReader::Read(bool *wasDebugInfoStripped)
 {
 	// Before starting the load, make sure that 
@@ -133,6 +235,12 @@ int asCReader::ReadInner()
 	unsigned long i, count;
 	asCScriptFunction* func;
 
+	if( buffer )
+	{
+		int r = ReadImageHeader();
+		if( r < 0 ) return r;
+	}
+
 	ReadData(&noDebugInfo, 1);
 
 	// Read enums
@@ -592,8 +700,33 @@ void asCReader::ReadUsedFunctions()
 				return;
 			}
 
+			// The image also stores where the function was found when 
+			// it was saved, so try that before searching all functions
+			if( isImage )
+			{
+				asUINT hint = ReadEncodedUInt();
+				asCScriptFunction *f = 0;
+				if( c != 'm' )
+					f = hint < engine->scriptFunctions.GetLength() ? engine->scriptFunctions[hint] : 0;
+				else if( func.funcType == asFUNC_IMPORTED )
+					f = hint < module->bindInformations.GetLength() ? module->bindInformations[hint]->importedFunctionSignature : 0;
+				else
+					f = hint < savedFunctions.GetLength() ? savedFunctions[hint] : 0;
+
+				if( f &&
+					func.IsSignatureEqual(f) &&
+					func.objectType == f->objectType &&
+					(c != 'm' || func.funcType == f->funcType) &&
+					func.nameSpace == f->nameSpace )
+					usedFunctions[n] = f;
+			}
+
 			// Find the correct function
-			if( c == 'm' )
+			if( usedFunctions[n] )
+			{
+				// Already found through the hint
+			}
+			else if( c == 'm' )
 			{
 				if( func.funcType == asFUNC_IMPORTED )
 				{
@@ -1511,8 +1644,32 @@ asQWORD asCReader::ReadEncodedUInt64()
 	return i;
 }
 
+void asCReader::ReadImageString(asUINT n, asCString *str)
+{
+	// The image refers to the string table, with 0 for empty strings
+	if( n == 0 )
+		str->SetLength(0);
+	else if( n <= imageHeader.stringCount )
+	{
+		asDWORD entry[2];
+		memcpy(entry, buffer + imageHeader.stringTableOffset + (n-1)*sizeof(entry), sizeof(entry));
+		if( entry[0] <= bufferSize && entry[1] <= bufferSize - entry[0] )
+			str->Assign((const char*)buffer + entry[0], entry[1]);
+		else
+			Error(TXT_INVALID_BYTECODE_d);
+	}
+	else
+		Error(TXT_INVALID_BYTECODE_d);
+}
+
 void asCReader::ReadString(asCString* str) 
 {
+	if( isImage )
+	{
+		ReadImageString(ReadEncodedUInt(), str);
+		return;
+	}
+
 	char b;
 	ReadData(&b, 1);
 	if( b == '\0' )
@@ -1523,7 +1680,7 @@ void asCReader::ReadString(asCString* str)
 	{
 		asUINT len = ReadEncodedUInt();
 		str->SetLength(len);
-		stream->Read(str->AddressOf(), len);
+		ReadRawData(str->AddressOf(), len);
 
 		savedStrings.PushLast(*str);
 	}
@@ -1777,8 +1934,27 @@ asCObjectType* asCReader::ReadObjectType()
 	{
 		// Read the object type name
 		asCString typeName, ns;
-		ReadString(&typeName);
-		ReadString(&ns);
+		asQWORD imageKey = 0;
+		if( isImage )
+		{
+			// The image identifies the name and namespace by their index in the
+			// string table, so each type only has to be looked up the first time
+			asUINT nameIdx = ReadEncodedUInt();
+			asUINT nsIdx   = ReadEncodedUInt();
+			imageKey = (asQWORD(nameIdx) << 32) | nsIdx;
+
+			asSMapNode<asQWORD, asCObjectType*> *cursor = 0;
+			if( imageObjectTypes.MoveTo(&cursor, imageKey) )
+				return cursor->value;
+
+			ReadImageString(nameIdx, &typeName);
+			ReadImageString(nsIdx, &ns);
+		}
+		else
+		{
+			ReadString(&typeName);
+			ReadString(&ns);
+		}
 		asSNameSpace *nameSpace = engine->AddNameSpace(ns.AddressOf());
 
 		if( typeName.GetLength() && typeName != "_builtin_object_" && typeName != "_builtin_function_" )
@@ -1807,6 +1983,9 @@ asCObjectType* asCReader::ReadObjectType()
 		}
 		else
 			asASSERT( false );
+
+		if( isImage && ot )
+			imageObjectTypes.Insert(imageKey, ot);
 	}
 	else
 	{
@@ -1822,6 +2001,44 @@ void asCReader::ReadByteCode(asCScriptFunction *func)
 {
 	asASSERT( func->scriptData );
 
+	if( isImage )
+	{
+		// The image stores the bytecode with the same layout as 
+		// in memory, so it only needs to be copied as a whole
+		asUINT offset = ReadEncodedUInt();
+		asUINT length = ReadEncodedUInt();
+		if( error || offset > imageHeader.byteCodeLength || length > imageHeader.byteCodeLength - offset )
+		{
+			Error(TXT_INVALID_BYTECODE_d);
+			return;
+		}
+
+		if( !func->scriptData->byteCode.SetLengthNoConstruct(length) )
+		{
+			// Out of memory
+			error = true;
+			return;
+		}
+
+		asDWORD *bc = func->scriptData->byteCode.AddressOf();
+		memcpy(bc, buffer + imageHeader.byteCodeOffset + offset*sizeof(asDWORD), length*sizeof(asDWORD));
+
+		// Verify the instructions so the translation can safely walk through them
+		for( asUINT pos = 0; pos < length; )
+		{
+			asBYTE c = *(asBYTE*)(bc + pos);
+			asUINT len = c < asBC_MAXBYTECODE ? asBCTypeSize[asBCInfo[c].type] : 0;
+			if( len == 0 || len > length - pos )
+			{
+				func->scriptData->byteCode.SetLength(0);
+				Error(TXT_INVALID_BYTECODE_d);
+				return;
+			}
+			pos += len;
+		}
+		return;
+	}
+
 	// Read number of instructions
 	asUINT total, numInstructions;
 	total = numInstructions = ReadEncodedUInt();
@@ -1858,7 +2075,9 @@ void asCReader::ReadByteCode(asCScriptFunction *func)
 		{
 		case asBCTYPE_NO_ARG:
 			{
-				*(asBYTE*)(bc) = b;
+				// Write the whole DWORD so the unused bytes are zero, as
+				// e.g. the breakpoint flag of asBC_SUSPEND is in byte 1
+				*bc = b;
 				bc++;
 			}
 			break;
@@ -1951,6 +2170,7 @@ void asCReader::ReadByteCode(asCScriptFunction *func)
 			break;
 		case asBCTYPE_wW_rW_DW_ARG:
 		case asBCTYPE_rW_W_DW_ARG:
+		case asBCTYPE_rW_rW_DW_ARG:
 			{
 				*(asBYTE*)(bc) = b;
 
@@ -2404,6 +2624,21 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 			// The size is dword offset 
 			bc[n+1] = size;
 		}
+		else if( c >= asBC_JLTi && c <= asBC_JGEIu )
+		{
+			// The offset is in the last argument, after the variables and the constant
+			int offset = int(bc[n+2]);
+
+			int size = 0;
+			if( offset >= 0 )
+				for( asUINT num = bcNum+1; offset-- > 0; num++ )
+					size += bcSizes[num];
+			else
+				for( asUINT num = bcNum; offset++ < 0; num-- )
+					size -= bcSizes[num];
+
+			bc[n+2] = size;
+		}
 		else if( c == asBC_AllocMem )
 		{
 			// The size of the allocated memory is only known after all the elements has been seen.
@@ -2493,6 +2728,7 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 		case asBCTYPE_wW_rW_ARG:
 		case asBCTYPE_wW_rW_DW_ARG:
 		case asBCTYPE_rW_rW_ARG:
+		case asBCTYPE_rW_rW_DW_ARG:
 			{
 				asBC_SWORDARG0(&bc[n]) = (short)AdjustStackPosition(asBC_SWORDARG0(&bc[n]));
 				asBC_SWORDARG1(&bc[n]) = (short)AdjustStackPosition(asBC_SWORDARG1(&bc[n]));
@@ -2866,6 +3102,32 @@ void asCReader::CalculateStackNeeded(asCScriptFunction *func)
 
 			continue;
 		}
+		else if( bc >= asBC_JLTi && bc <= asBC_JGEIu )
+		{
+			// The offset is in the last argument
+			int offset = asBC_INTARG(&func->scriptData->byteCode[pos+1]);
+
+			// Add both paths to the code paths
+			pos += 3;
+			if( stackSize[pos] == -1 )
+			{
+				stackSize[pos] = currStackSize;
+				paths.PushLast(pos);
+			}
+			else
+				asASSERT(stackSize[pos] == currStackSize);
+
+			pos += offset;
+			if( stackSize[pos] == -1 )
+			{
+				stackSize[pos] = currStackSize;
+				paths.PushLast(pos);
+			}
+			else
+				asASSERT(stackSize[pos] == currStackSize);
+
+			continue;
+		}
 		else if( bc == asBC_JMPP )
 		{
 			pos++;
@@ -3169,14 +3431,27 @@ asCObjectType *asCReader::FindObjectType(int idx)
 
 #ifndef AS_NO_COMPILER
 
-asCWriter::asCWriter(asCModule* _module, asIBinaryStream* _stream, asCScriptEngine* _engine, bool _stripDebug)
- : module(_module), stream(_stream), engine(_engine), stripDebugInfo(_stripDebug)
+asCWriter::asCWriter(asCModule* _module, asIBinaryStream* _stream, asCScriptEngine* _engine, bool _stripDebug, bool _writeImage)
+ : module(_module), stream(_stream), engine(_engine), stripDebugInfo(_stripDebug), writeImage(_writeImage)
 {
 }
 
 void asCWriter::WriteData(const void *data, asUINT size)
 {
 	asASSERT(size == 1 || size == 2 || size == 4 || size == 8);
+	if( writeImage )
+	{
+		// Keep the same byte order as the stream format
+#if defined(AS_BIG_ENDIAN)
+		for( asUINT n = 0; n < size; n++ )
+			imageBody.PushLast(((const asBYTE*)data)[n]);
+#else
+		for( int n = size-1; n >= 0; n-- )
+			imageBody.PushLast(((const asBYTE*)data)[n]);
+#endif
+		return;
+	}
+
 #if defined(AS_BIG_ENDIAN)
 	for( asUINT n = 0; n < size; n++ )
 		stream->Write(((asBYTE*)data)+n, 1);
@@ -3309,6 +3584,55 @@ int asCWriter::Write()
 	// usedObjectProperties[]
 	WriteUsedObjectProps();
 
+	if( writeImage )
+		return WriteImage();
+
+	return asSUCCESS;
+}
+
+int asCWriter::WriteImage()
+{
+	asSByteCodeImageHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "ASBI", 4);
+	header.version        = AS_BYTECODE_IMAGE_VERSION;
+	header.pointerSize    = AS_PTR_SIZE;
+#if defined(AS_BIG_ENDIAN)
+	header.isBigEndian    = 1;
+#endif
+	header.libraryVersion = ANGELSCRIPT_VERSION;
+
+	// The sections with DWORDs come first so they stay aligned
+	// as long as the image itself is loaded at an aligned address
+	header.stringCount       = asDWORD(savedStrings.GetLength());
+	header.stringTableOffset = sizeof(header);
+	header.byteCodeOffset    = header.stringTableOffset + header.stringCount*2*sizeof(asDWORD);
+	header.byteCodeLength    = asDWORD(imageByteCode.GetLength());
+
+	asCArray<asDWORD> stringTable;
+	stringTable.Allocate(savedStrings.GetLength()*2, false);
+	asDWORD offset = header.byteCodeOffset + header.byteCodeLength*sizeof(asDWORD);
+	for( asUINT n = 0; n < savedStrings.GetLength(); n++ )
+	{
+		stringTable.PushLast(offset);
+		stringTable.PushLast(asDWORD(savedStrings[n].GetLength()));
+		offset += asDWORD(savedStrings[n].GetLength());
+	}
+
+	header.bodyOffset = offset;
+	header.bodySize   = asDWORD(imageBody.GetLength());
+
+	stream->Write(&header, sizeof(header));
+	if( stringTable.GetLength() )
+		stream->Write(stringTable.AddressOf(), stringTable.GetLength()*sizeof(asDWORD));
+	if( imageByteCode.GetLength() )
+		stream->Write(imageByteCode.AddressOf(), imageByteCode.GetLength()*sizeof(asDWORD));
+	for( asUINT n = 0; n < savedStrings.GetLength(); n++ )
+		if( savedStrings[n].GetLength() )
+			stream->Write(savedStrings[n].AddressOf(), asUINT(savedStrings[n].GetLength()));
+	if( imageBody.GetLength() )
+		stream->Write(imageBody.AddressOf(), imageBody.GetLength());
+
 	return asSUCCESS;
 }
 
@@ -3349,6 +3673,37 @@ void asCWriter::WriteUsedFunctions()
 			c = usedFunctions[n]->module ? 'm' : 'a';
 			WriteData(&c, 1);
 			WriteFunctionSignature(usedFunctions[n]);
+
+			if( writeImage )
+			{
+				// Store where the reader will find the function, so it doesn't have to
+				// search for the signature. Application functions keep their ids as 
+				// long as they are registered in the same order, module functions 
+				// are found in the saved functions, or among the imported functions
+				asCScriptFunction *func = usedFunctions[n];
+				asUINT hint = 0;
+				if( c == 'a' )
+					hint = func->id;
+				else if( func->funcType == asFUNC_IMPORTED )
+				{
+					for( asUINT i = 0; i < module->bindInformations.GetLength(); i++ )
+						if( module->bindInformations[i]->importedFunctionSignature == func )
+						{
+							hint = i;
+							break;
+						}
+				}
+				else
+				{
+					for( asUINT i = 0; i < savedFunctions.GetLength(); i++ )
+						if( savedFunctions[i] == func )
+						{
+							hint = i;
+							break;
+						}
+				}
+				WriteEncodedInt64(hint);
+			}
 		}
 		else
 		{
@@ -3752,6 +4107,12 @@ void asCWriter::WriteString(asCString* str)
 
 	if( str->GetLength() == 0 )
 	{
+		if( writeImage )
+		{
+			WriteEncodedInt64(0);
+			return;
+		}
+
 		char z = '\0';
 		WriteData(&z, 1);
 		return;
@@ -3759,6 +4120,19 @@ void asCWriter::WriteString(asCString* str)
 
 	// First check if the string hasn't been saved already
 	asSMapNode<asCStringPointer, int> *cursor = 0;
+	if( writeImage )
+	{
+		// The image only refers to the string table, which is written at the end
+		if( !stringToIdMap.MoveTo(&cursor, asCStringPointer(str)) )
+		{
+			savedStrings.PushLast(*str);
+			stringToIdMap.Insert(asCStringPointer(str), int(savedStrings.GetLength()) - 1);
+			stringToIdMap.MoveTo(&cursor, asCStringPointer(str));
+		}
+		WriteEncodedInt64(cursor->value + 1);
+		return;
+	}
+
 	if (stringToIdMap.MoveTo(&cursor, asCStringPointer(str)))
 	{
 		// Save a reference to the existing string
@@ -4159,10 +4533,20 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 	asDWORD *bc   = func->scriptData->byteCode.AddressOf();
 	size_t length = func->scriptData->byteCode.GetLength();
 
-	// The length cannot be stored, because it is platform dependent, 
-	// instead we store the number of instructions
-	asUINT count = bytecodeNbrByPos[bytecodeNbrByPos.GetLength()-1] + 1;
-	WriteEncodedInt64(count);
+	if( writeImage )
+	{
+		// The image is platform dependent anyway, so store where the 
+		// bytecode starts in the bytecode section and its length
+		WriteEncodedInt64(imageByteCode.GetLength());
+		WriteEncodedInt64(length);
+	}
+	else
+	{
+		// The length cannot be stored, because it is platform dependent, 
+		// instead we store the number of instructions
+		asUINT count = bytecodeNbrByPos[bytecodeNbrByPos.GetLength()-1] + 1;
+		WriteEncodedInt64(count);
+	}
 
 	asDWORD *startBC = bc;
 	while( length )
@@ -4198,6 +4582,11 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 			// We don't store the JIT argument
 			*(asPWORD*)(tmp+1) = 0;
 		}
+		else if( c == asBC_SUSPEND ) // NO_ARG
+		{
+			// Breakpoints set in this engine aren't stored
+			asBC_BREAKPOINT_FLAG(tmp) = 0;
+		}
 		else if( c == asBC_TYPEID || // DW_ARG
 			     c == asBC_Cast )    // DW_ARG
 		{
@@ -4310,6 +4699,17 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 			// Set the offset in number of instructions
 			*(int*)(tmp+1) = targetBcSeqNum - bcSeqNum;
 		}
+		else if( c >= asBC_JLTi && c <= asBC_JGEIu ) // rW_rW_DW_ARG or rW_DW_DW_ARG
+		{
+			// The offset is in the last argument, after the variables and the constant
+			int offset = *(int*)(tmp+2);
+
+			int bcSeqNum = bytecodeNbrByPos[bc - startBC] + 1;
+			asDWORD *targetBC = bc + 3 + offset;
+			int targetBcSeqNum = bytecodeNbrByPos[targetBC - startBC];
+
+			*(int*)(tmp+2) = targetBcSeqNum - bcSeqNum;
+		}
 		else if( c == asBC_GETOBJ ||    // W_ARG
 			     c == asBC_GETOBJREF ||
 				 c == asBC_GETREF )
@@ -4389,6 +4789,7 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 		case asBCTYPE_wW_rW_ARG:
 		case asBCTYPE_wW_rW_DW_ARG:
 		case asBCTYPE_rW_rW_ARG:
+		case asBCTYPE_rW_rW_DW_ARG:
 			{
 				asBC_SWORDARG0(tmp) = (short)AdjustStackPosition(asBC_SWORDARG0(tmp));
 				asBC_SWORDARG1(tmp) = (short)AdjustStackPosition(asBC_SWORDARG1(tmp));
@@ -4408,6 +4809,17 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 			break;
 		}
 
+		if( writeImage )
+		{
+			// The image keeps the instruction with the same layout as in memory
+			asUINT size = asBCTypeSize[asBCInfo[c].type];
+			for( asUINT n = 0; n < size; n++ )
+				imageByteCode.PushLast(tmp[n]);
+			bc     += size;
+			length -= size;
+			continue;
+		}
+
 		// TODO: bytecode: Must make sure that floats and doubles are always stored the same way regardless of platform. 
 		//                 Some platforms may not use the IEEE 754 standard, in which case it is necessary to encode the values
 		
@@ -4511,6 +4923,7 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 			break;
 		case asBCTYPE_wW_rW_DW_ARG:
 		case asBCTYPE_rW_W_DW_ARG:
+		case asBCTYPE_rW_rW_DW_ARG:
 			{
 				// Write the instruction code
 				asBYTE b = (asBYTE)c;
@@ -45,10 +45,36 @@
 
 BEGIN_AS_NAMESPACE
 
+// The bytecode image is a container for the saved module that is meant to be
+// loaded directly from memory, e.g. a memory mapped file. All strings are kept
+// in a string table, and the bytecode of all functions is stored in a single
+// DWORD aligned section with the same layout as the loaded bytecode, so each
+// function is restored with one copy. The rest of the module is stored in the
+// body with the same encoding as the stream format. The header and tables use
+// the native byte order, so the image can only be loaded on a platform with
+// the same pointer size and byte order, and by the same library version
+const asWORD AS_BYTECODE_IMAGE_VERSION = 1;
+
+struct asSByteCodeImageHeader
+{
+	char    magic[4];           // "ASBI"
+	asWORD  version;            // AS_BYTECODE_IMAGE_VERSION
+	asBYTE  pointerSize;        // AS_PTR_SIZE
+	asBYTE  isBigEndian;
+	asDWORD libraryVersion;     // ANGELSCRIPT_VERSION
+	asDWORD stringCount;
+	asDWORD stringTableOffset;  // stringCount pairs of {offset, length}
+	asDWORD byteCodeOffset;
+	asDWORD byteCodeLength;     // in DWORDs
+	asDWORD bodyOffset;
+	asDWORD bodySize;
+};
+
 class asCReader
 {
 public:
 	asCReader(asCModule *module, asIBinaryStream *stream, asCScriptEngine *engine);
+	asCReader(asCModule *module, const void *buffer, asUINT size, asCScriptEngine *engine);
 
 	int Read(bool *wasDebugInfoStripped);
 
@@ -60,12 +86,25 @@ protected:
 	bool             error;
 	asUINT           bytesRead;
 
+	// Set when loading from memory instead of a stream. The 
+	// buffer holds either a bytecode image or the stream format
+	const asBYTE    *buffer;
+	asUINT           bufferSize;
+	asUINT           bufferPos;
+	asUINT           bufferEnd;
+	bool             isImage;
+	asSByteCodeImageHeader imageHeader;
+	asCMap<asQWORD, asCObjectType*> imageObjectTypes;
+
 	int                Error(const char *msg);
 
 	int                ReadInner();
+	int                ReadImageHeader();
 
 	void               ReadData(void *data, asUINT size);
+	void               ReadRawData(void *data, asUINT size);
 	void               ReadString(asCString *str);
+	void               ReadImageString(asUINT n, asCString *str);
 	asCScriptFunction *ReadFunction(bool &isNew, bool addToModule = true, bool addToEngine = true, bool addToGC = true);
 	void               ReadFunctionSignature(asCScriptFunction *func);
 	void               ReadGlobalProperty();
@@ -156,7 +195,7 @@ protected:
 class asCWriter
 {
 public:
-	asCWriter(asCModule *module, asIBinaryStream *stream, asCScriptEngine *engine, bool stripDebugInfo);
+	asCWriter(asCModule *module, asIBinaryStream *stream, asCScriptEngine *engine, bool stripDebugInfo, bool writeImage = false);
 
 	int Write();
 
@@ -166,7 +205,14 @@ protected:
 	asCScriptEngine *engine;
 	bool             stripDebugInfo;
 
+	// When writing a bytecode image the body and the bytecode 
+	// are buffered and written together with the string table
+	bool              writeImage;
+	asCArray<asBYTE>  imageBody;
+	asCArray<asDWORD> imageByteCode;
+
 	void WriteData(const void *data, asUINT size);
+	int  WriteImage();
 
 	void WriteString(asCString *str);
 	void WriteFunction(asCScriptFunction *func);
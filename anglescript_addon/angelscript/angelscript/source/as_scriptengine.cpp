@@ -384,6 +384,20 @@ int asCScriptEngine::SetEngineProperty(asEEngineProp property, asPWORD value)
 		ep.disableIntegerDivision = value ? true : false;
 		break;
 
+	case asEP_GC_WORKER_THREADS:
+		if( value <= 64 )
+			ep.gcWorkerThreads = (asUINT)value;
+		else
+			return asINVALID_ARG;
+		break;
+
+	case asEP_GC_PROMOTION_THRESHOLD:
+		if( value <= 0xFFFF )
+			ep.gcPromotionThreshold = (asUINT)value;
+		else
+			return asINVALID_ARG;
+		break;
+
 	default:
 		return asINVALID_ARG;
 	}
@@ -462,6 +476,12 @@ asPWORD asCScriptEngine::GetEngineProperty(asEEngineProp property) const
 	case asEP_DISABLE_INTEGER_DIVISION:
 		return ep.disableIntegerDivision;
 
+	case asEP_GC_WORKER_THREADS:
+		return ep.gcWorkerThreads;
+
+	case asEP_GC_PROMOTION_THRESHOLD:
+		return ep.gcPromotionThreshold;
+
 	default:
 		return 0;
 	}
@@ -521,9 +541,12 @@ asCScriptEngine::asCScriptEngine()
 		ep.disallowValueAssignForRefType = false;
 		ep.alterSyntaxNamedArgs          = 0;         // 0 = no alternate syntax, 1 = accept alternate syntax but warn, 2 = accept without warning
 		ep.disableIntegerDivision        = false;
+		ep.gcWorkerThreads               = 0;         // 0 = cycle detection runs only in the thread calling GarbageCollect
+		ep.gcPromotionThreshold          = 3;         // Number of sweeps a new object must survive before it is moved to the old objects
 	}
 
 	gc.engine = this;
+	memset(&gcTypeCursor, 0, sizeof(gcTypeCursor));
 	tok.engine = this;
 
 	refCount.set(1);
@@ -600,6 +623,11 @@ asCScriptEngine::~asCScriptEngine()
 	// violations later on when the pool releases its contexts.
 	SetContextCallbacks(0, 0, 0);
 
+	// Contexts needed during the clean-up are created and destroyed on demand, as the pool is gone
+	for( n = 0; n < contextPool.GetLength(); n++ )
+		contextPool[n]->Release();
+	contextPool.SetLength(0);
+
 	// The modules must be deleted first, as they may use
 	// object types from the config groups
 	for( n = (asUINT)scriptModules.GetLength(); n-- > 0; )
@@ -854,7 +882,22 @@ asIScriptContext *asCScriptEngine::RequestContext()
 		return ctx;
 	}
 
-	// As fallback we create a new context
+	// Reuse a context from the engine's own pool so the stack memory is already allocated
+	asCContext *ctx = 0;
+	ENTERCRITICALSECTION(contextPoolCritical);
+	if( contextPool.GetLength() )
+		ctx = contextPool.PopLast();
+	LEAVECRITICALSECTION(contextPoolCritical);
+
+	if( ctx )
+	{
+		// The context holds a reference to the engine while it is in use
+		AddRef();
+		ctx->m_holdEngineRef = true;
+		return ctx;
+	}
+
+	// Create a new context if the pool is empty
 	return CreateContext();
 }
 
@@ -867,9 +910,33 @@ void asCScriptEngine::ReturnContext(asIScriptContext *ctx)
 		return;
 	}
 
-	// As fallback we just release the context
-	if( ctx )
+	if( ctx == 0 )
+		return;
+
+	// Only contexts that nobody else refers to and that aren't in 
+	// use can be reused. Anything else is simply released
+	asCContext *context = static_cast<asCContext*>(ctx);
+	if( shuttingDown || context->m_engine != this || !context->m_holdEngineRef ||
+		context->m_refCount.get() != 1 || context->IsNested() || context->Unprepare() < 0 )
+	{
 		ctx->Release();
+		return;
+	}
+
+	// Settings made by the previous user shouldn't carry over to the next.
+	// The user data is cleaned the same way as if the context was destroyed
+	context->ClearLineCallback();
+	context->ClearExceptionCallback();
+	context->ClearBreakpointCallback();
+	context->CleanUserData();
+
+	context->m_holdEngineRef = false;
+	ENTERCRITICALSECTION(contextPoolCritical);
+	contextPool.PushLast(context);
+	LEAVECRITICALSECTION(contextPoolCritical);
+
+	// This may destroy the engine if the application has already released it
+	Release();
 }
 
 // interface
@@ -1578,6 +1645,7 @@ int asCScriptEngine::RegisterInterface(const char *name)
 	st->beh.copy = 0;
 
 	allRegisteredTypes.Insert(asSNameSpaceNamePair(st->nameSpace, st->name), st);
+	ClearTypeLookupCaches();
 	registeredObjTypes.PushLast(st);
 
 	currentGroup->objTypes.PushLast(st);
@@ -1782,6 +1850,7 @@ int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asDWORD
 
 		// Store it in the object types
 		allRegisteredTypes.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
+		ClearTypeLookupCaches();
 		currentGroup->objTypes.PushLast(type);
 		registeredObjTypes.PushLast(type);
 		registeredTemplateTypes.PushLast(type);
@@ -1882,6 +1951,7 @@ int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asDWORD
 			type->accessMask = defaultAccessMask;
 
 			allRegisteredTypes.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
+			ClearTypeLookupCaches();
 			registeredObjTypes.PushLast(type);
 
 			currentGroup->objTypes.PushLast(type);
@@ -4039,6 +4109,11 @@ bool asCScriptEngine::GenerateNewTemplateFunction(asCObjectType *templateType, a
 	func2->isReadOnly = func->isReadOnly;
 	func2->objectType = ot;
 	func2->sysFuncIntf = asNEW(asSSystemFunctionInterface)(*func->sysFuncIntf);
+#ifdef AS_CALL_THUNKS
+	// The argument list depends on the actual parameter types
+	if( func2->sysFuncIntf->hasCallThunk )
+		PrepareSystemFunctionThunk(func2, func2->sysFuncIntf);
+#endif
 
 	func2->id       = GetNextScriptFunctionId();
 	SetScriptFunction(func2);
@@ -4523,10 +4598,16 @@ void *asCScriptEngine::CallAlloc(const asCObjectType *type) const
 
 #ifndef WIP_16BYTE_ALIGN
 #if defined(AS_DEBUG)
-	return ((asALLOCFUNCDEBUG_t)userAlloc)(size, __FILE__, __LINE__);
+	void *mem = ((asALLOCFUNCDEBUG_t)userAlloc)(size, __FILE__, __LINE__);
 #else
-	return userAlloc(size);
+	void *mem = userAlloc(size);
 #endif
+
+	// The slab allocator can tell how much memory each object type uses
+	if( mem && userAlloc == asSlabAlloc && type->memStats )
+		asSlabSetTypeMemStats(mem, type->memStats);
+
+	return mem;
 #else
 #if defined(AS_DEBUG)
 	return ((asALLOCALIGNEDFUNCDEBUG_t)userAllocAligned)(size, type->alignment, __FILE__, __LINE__);
@@ -4557,6 +4638,62 @@ int asCScriptEngine::GetObjectInGC(asUINT idx, asUINT *seqNbr, void **obj, asIOb
 	return gc.GetObjectInGC(idx, seqNbr, obj, type);
 }
 
+// interface
+asIObjectType *asCScriptEngine::GetGCObjectTypeByIndex(asUINT index) const
+{
+	// Go through the object types that the engine knows of and only 
+	// count the ones that have had objects in the garbage collector.
+	// The first list is the builtin types
+	const asCObjectType *builtinTypes[] = {&functionBehaviours, &objectTypeBehaviours, &globalPropertyBehaviours};
+	const asCArray<asCObjectType *> *typeLists[] = {0, &registeredObjTypes, &templateInstanceTypes, &scriptTypes};
+
+	ACQUIREEXCLUSIVE(typeLookupLock);
+
+	// When the types are enumerated in order the search continues after the
+	// previously returned type, as long as it is still in the same place
+	asUINT list = 0, pos = 0, count = 0;
+	const asCObjectType *cursorType = 0;
+	if( gcTypeCursor.type && index > gcTypeCursor.index && gcTypeCursor.list < 4 )
+	{
+		if( gcTypeCursor.list == 0 )
+			cursorType = gcTypeCursor.pos < 3 ? builtinTypes[gcTypeCursor.pos] : 0;
+		else if( gcTypeCursor.pos < typeLists[gcTypeCursor.list]->GetLength() )
+			cursorType = (*typeLists[gcTypeCursor.list])[gcTypeCursor.pos];
+	}
+	if( cursorType && cursorType == gcTypeCursor.type )
+	{
+		list  = gcTypeCursor.list;
+		pos   = gcTypeCursor.pos + 1;
+		count = gcTypeCursor.index + 1;
+	}
+
+	asCObjectType *found = 0;
+	for( ; list < 4 && found == 0; list++, pos = 0 )
+	{
+		asUINT length = list == 0 ? 3 : asUINT(typeLists[list]->GetLength());
+		for( ; pos < length; pos++ )
+		{
+			asCObjectType *ot = const_cast<asCObjectType*>(list == 0 ? builtinTypes[pos] : (*typeLists[list])[pos]);
+			if( ot == 0 || ot->gcStats.created == 0 )
+				continue;
+
+			if( count++ == index )
+			{
+				gcTypeCursor.type  = ot;
+				gcTypeCursor.index = index;
+				gcTypeCursor.list  = list;
+				gcTypeCursor.pos   = pos;
+				found = ot;
+				break;
+			}
+		}
+	}
+
+	RELEASEEXCLUSIVE(typeLookupLock);
+
+	return found;
+}
+
 // interface
 int asCScriptEngine::GarbageCollect(asDWORD flags, asUINT iterations)
 {
@@ -4569,6 +4706,12 @@ void asCScriptEngine::GetGCStatistics(asUINT *currentSize, asUINT *totalDestroye
 	gc.GetStatistics(currentSize, totalDestroyed, totalDetected, newObjects, totalNewDestroyed);
 }
 
+// interface
+void asCScriptEngine::GetGCPauseStatistics(asUINT *pauseCount, asQWORD *totalMicroseconds, asUINT *maxMicroseconds, asUINT *histogram, asUINT histogramSize) const
+{
+	gc.GetPauseStatistics(pauseCount, totalMicroseconds, maxMicroseconds, histogram, histogramSize);
+}
+
 // interface
 void asCScriptEngine::GCEnumCallback(void *reference)
 {
@@ -4666,6 +4809,8 @@ asCObjectType *asCScriptEngine::GetObjectTypeFromTypeId(int typeId) const
 
 void asCScriptEngine::RemoveFromTypeIdMap(asCObjectType *type)
 {
+	ClearTypeLookupCaches();
+
 	asSMapNode<int,asCDataType*> *cursor = 0;
 	mapTypeIdToDataType.MoveFirst(&cursor);
 	while( cursor )
@@ -4684,22 +4829,41 @@ void asCScriptEngine::RemoveFromTypeIdMap(asCObjectType *type)
 // interface
 asIObjectType *asCScriptEngine::GetObjectTypeByDecl(const char *decl) const
 {
-	asCDataType dt;
-	// This cast is ok, because we are not changing anything in the engine
-	asCBuilder bld(const_cast<asCScriptEngine*>(this), 0);
-
-	// Don't write parser errors to the message callback
-	bld.silent = true;
-
-	int r = bld.ParseDataType(decl, &dt, defaultNamespace);
-	if( r < 0 )
+	int typeId = GetTypeIdByDecl(decl);
+	if( typeId < 0 )
 		return 0;
 
-	return dt.GetObjectType();
+	return GetDataTypeFromTypeId(typeId).GetObjectType();
 }
 
 // interface
 int asCScriptEngine::GetTypeIdByDecl(const char *decl) const
+{
+	// Add-ons call this at runtime, so the result is cached to avoid parsing the declaration every time
+	int typeId;
+	ACQUIRESHARED(typeLookupLock);
+	bool found = typeIdByDecl.Find(defaultNamespace, decl, &typeId);
+	RELEASESHARED(typeLookupLock);
+	if( found )
+		return typeId;
+
+	typeId = GetTypeIdByDeclUncached(decl);
+
+	// Invalid declarations are not cached, as the type may still be registered
+	if( typeId >= 0 )
+	{
+		int cached;
+		ACQUIREEXCLUSIVE(typeLookupLock);
+		if( !typeIdByDecl.Find(defaultNamespace, decl, &cached) )
+			const_cast<asCScriptEngine*>(this)->typeIdByDecl.Insert(defaultNamespace, decl, typeId);
+		RELEASEEXCLUSIVE(typeLookupLock);
+	}
+
+	return typeId;
+}
+
+// internal
+int asCScriptEngine::GetTypeIdByDeclUncached(const char *decl) const
 {
 	asCDataType dt;
 	// This cast is ok, because we are not changing anything in the engine
@@ -4715,6 +4879,17 @@ int asCScriptEngine::GetTypeIdByDecl(const char *decl) const
 	return GetTypeIdFromDataType(dt);
 }
 
+// internal
+void asCScriptEngine::ClearTypeLookupCaches()
+{
+	// A new type may hide a type from a parent namespace and a removed
+	// type may leave a stale type id, so all entries are dropped
+	ACQUIREEXCLUSIVE(typeLookupLock);
+	typeIdByDecl.EraseAll();
+	objectTypeByName.EraseAll();
+	RELEASEEXCLUSIVE(typeLookupLock);
+}
+
 // interface
 const char *asCScriptEngine::GetTypeDeclaration(int typeId, bool includeNamespace) const
 {
@@ -5289,6 +5464,7 @@ int asCScriptEngine::RegisterFuncdef(const char *decl)
 	funcDefs.PushLast(func);
 	registeredFuncDefs.PushLast(func);
 	currentGroup->funcDefs.PushLast(func);
+	ClearTypeLookupCaches();
 
 	// If parameter type from other groups are used, add references
 	if( func->returnType.GetObjectType() )
@@ -5393,6 +5569,7 @@ int asCScriptEngine::RegisterTypedef(const char *type, const char *decl)
 	object->templateSubTypes.PushLast(dataType);
 
 	allRegisteredTypes.Insert(asSNameSpaceNamePair(object->nameSpace, object->name), object);
+	ClearTypeLookupCaches();
 	registeredTypeDefs.PushLast(object);
 
 	currentGroup->objTypes.PushLast(object);
@@ -5477,6 +5654,7 @@ int asCScriptEngine::RegisterEnum(const char *name)
 	st->nameSpace = defaultNamespace;
 
 	allRegisteredTypes.Insert(asSNameSpaceNamePair(st->nameSpace, st->name), st);
+	ClearTypeLookupCaches();
 	registeredEnums.PushLast(st);
 
 	currentGroup->objTypes.PushLast(st);
@@ -5609,24 +5787,41 @@ asIObjectType *asCScriptEngine::GetObjectTypeByIndex(asUINT index) const
 // interface
 asIObjectType *asCScriptEngine::GetObjectTypeByName(const char *name) const
 {
+	asCObjectType *ot = 0;
+	ACQUIRESHARED(typeLookupLock);
+	bool found = objectTypeByName.Find(defaultNamespace, name, &ot);
+	RELEASESHARED(typeLookupLock);
+	if( found )
+		return ot;
+
 	// Check the object types
-	for( asUINT n = 0; n < registeredObjTypes.GetLength(); n++ )
+	for( asUINT n = 0; n < registeredObjTypes.GetLength() && ot == 0; n++ )
 	{
 		if( registeredObjTypes[n]->name == name &&
 			registeredObjTypes[n]->nameSpace == defaultNamespace )
-			return registeredObjTypes[n];
+			ot = registeredObjTypes[n];
 	}
 
 	// Perhaps it is a template type? In this case
 	// the returned type will be the generic type
-	for( asUINT n = 0; n < registeredTemplateTypes.GetLength(); n++ )
+	for( asUINT n = 0; n < registeredTemplateTypes.GetLength() && ot == 0; n++ )
 	{
 		if( registeredTemplateTypes[n]->name == name &&
 			registeredTemplateTypes[n]->nameSpace == defaultNamespace )
-			return registeredTemplateTypes[n];
+			ot = registeredTemplateTypes[n];
 	}
 
-	return 0;
+	// Unknown names are not cached, as the type may still be registered
+	if( ot )
+	{
+		asCObjectType *cached;
+		ACQUIREEXCLUSIVE(typeLookupLock);
+		if( !objectTypeByName.Find(defaultNamespace, name, &cached) )
+			const_cast<asCScriptEngine*>(this)->objectTypeByName.Insert(defaultNamespace, name, ot);
+		RELEASEEXCLUSIVE(typeLookupLock);
+	}
+
+	return ot;
 }
 
 // interface
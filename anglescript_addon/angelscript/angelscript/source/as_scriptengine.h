@@ -187,8 +187,10 @@ public:
 	// Garbage collection
 	virtual int  GarbageCollect(asDWORD flags = asGC_FULL_CYCLE, asUINT numIterations = 1);
 	virtual void GetGCStatistics(asUINT *currentSize, asUINT *totalDestroyed, asUINT *totalDetected, asUINT *newObjects, asUINT *totalNewDestroyed) const;
+	virtual void GetGCPauseStatistics(asUINT *pauseCount, asQWORD *totalMicroseconds, asUINT *maxMicroseconds, asUINT *histogram, asUINT histogramSize) const;
 	virtual int  NotifyGarbageCollectorOfNewObject(void *obj, asIObjectType *type);
 	virtual int  GetObjectInGC(asUINT idx, asUINT *seqNbr, void **obj = 0, asIObjectType **type = 0);
+	virtual asIObjectType *GetGCObjectTypeByIndex(asUINT index) const;
 	virtual void GCEnumCallback(void *reference);
 
 	// User data
@@ -340,6 +342,14 @@ public:
 	// Stores all registered types except funcdefs
 	asCMap<asSNameSpaceNamePair, asCObjectType*> allRegisteredTypes;  
 
+	// Results of GetTypeIdByDecl and GetObjectTypeByName for each namespace and name.
+	// The caches are cleared whenever a type is registered or removed
+	asCNameHashMap<int>             typeIdByDecl;
+	asCNameHashMap<asCObjectType *> objectTypeByName;
+	DECLAREREADWRITELOCK(mutable typeLookupLock)
+	int  GetTypeIdByDeclUncached(const char *decl) const;
+	void ClearTypeLookupCaches();
+
 	// Dummy types used to name the subtypes in the template objects 
 	asCArray<asCObjectType *>      templateSubTypes;
 
@@ -397,6 +407,16 @@ public:
 	// Garbage collector
 	asCGarbageCollector gc;
 
+	// Where GetGCObjectTypeByIndex found the last type, so the next index 
+	// can continue from there. Protected by the exclusive typeLookupLock
+	struct
+	{
+		const asCObjectType *type;
+		asUINT               index;
+		asUINT               list;
+		asUINT               pos;
+	} mutable gcTypeCursor;
+
 	// Dynamic groups
 	asCConfigGroup             defaultGroup;
 	asCArray<asCConfigGroup*>  configGroups;
@@ -437,6 +457,12 @@ public:
 	asRETURNCONTEXTFUNC_t   returnCtxFunc;
 	void                   *ctxCallbackParam;
 
+	// Contexts kept by RequestContext/ReturnContext when the
+	// application hasn't registered the callbacks. They don't
+	// hold a reference to the engine while they are in the pool
+	asCArray<asCContext*>   contextPool;
+	DECLARECRITICALSECTION(contextPoolCritical)
+
 	// User data
 	asCArray<asPWORD>       userData;
 
@@ -479,6 +505,8 @@ public:
 		bool   disallowValueAssignForRefType;
 		int    alterSyntaxNamedArgs;
 		bool   disableIntegerDivision;
+		asUINT gcWorkerThreads;
+		asUINT gcPromotionThreshold;
 	} ep;
 
 	// This flag is to allow a quicker shutdown when releasing the engine
@@ -815,6 +815,43 @@ int asCScriptFunction::FindNextLineWithCode(int line) const
 	return -1;
 }
 
+// interface
+int asCScriptFunction::SetBreakpoint(int line, bool enable)
+{
+	// Breakpoints are placed on the SUSPEND instructions that the
+	// compiler adds for each statement, so without line cues there
+	// is nothing to patch
+	if( scriptData == 0 || engine->ep.buildWithoutLineCues ) return asNOT_SUPPORTED;
+
+	// Line 0 means the first line with code in the function
+	if( line == 0 )
+		line = scriptData->declaredAt&0xFFFFF;
+
+	line = FindNextLineWithCode(line);
+	if( line < 0 ) return asINVALID_ARG;
+
+	// The same line can have more than one position, e.g. the
+	// condition and increment of a for loop, so flag all of them
+	int count = 0;
+	for( asUINT n = 0; n < scriptData->lineNumbers.GetLength(); n += 2 )
+	{
+		asUINT pos = scriptData->lineNumbers[n];
+		if( (scriptData->lineNumbers[n+1]&0xFFFFF) != line || pos >= scriptData->byteCode.GetLength() )
+			continue;
+
+		asDWORD *bc = &scriptData->byteCode[pos];
+		if( *(asBYTE*)bc != asBC_SUSPEND )
+			continue;
+
+		asBC_BREAKPOINT_FLAG(bc) = enable ? 1 : 0;
+		count++;
+	}
+
+	if( count == 0 ) return asINVALID_ARG;
+
+	return line;
+}
+
 // internal
 int asCScriptFunction::GetLineNumber(int programPosition, int *sectionIdx)
 {
@@ -163,6 +163,7 @@ public:
 	int                  GetVar(asUINT index, const char **name, int *typeId = 0) const;
 	const char *         GetVarDecl(asUINT index, bool includeNamespace = false) const;
 	int                  FindNextLineWithCode(int line) const;
+	int                  SetBreakpoint(int line, bool enable);
 
 	// For JIT compilation
 	asDWORD             *GetByteCode(asUINT *length = 0);
@@ -39,6 +39,7 @@
 #include "as_config.h"
 #include "as_thread.h"
 #include "as_atomic.h"
+#include "as_memory.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -55,7 +56,13 @@ extern "C"
 
 AS_API int asThreadCleanup()
 {
-	return asCThreadManager::CleanupLocalData();
+	int r = asCThreadManager::CleanupLocalData();
+
+	// Give the thread's cached memory blocks back to the other threads. This
+	// is done last so the blocks freed with the thread local data are included
+	asSlabThreadCleanup();
+
+	return r;
 }
 
 AS_API asIThreadManager *asGetThreadManager()
@@ -315,6 +322,7 @@ asCThreadLocalData *asCThreadManager::GetLocalData()
 
 asCThreadLocalData::asCThreadLocalData()
 {
+	gcWorker = 0;
 }
 
 asCThreadLocalData::~asCThreadLocalData()
@@ -89,6 +89,7 @@ protected:
 //======================================================================
 
 class asIScriptContext;
+struct asSGCWorker;
 
 class asCThreadLocalData
 {
@@ -96,6 +97,9 @@ public:
 	asCArray<asIScriptContext *> activeContexts;
 	asCString string;
 
+	// Set while the thread is marking live objects for the garbage collector
+	asSGCWorker *gcWorker;
+
 protected:
 	friend class asCThreadManager;
 
@@ -0,0 +1,16 @@
+// Element access and floating point math on arrays
+void main()
+{
+	array<double> a(10000), b(10000);
+	for( uint i = 0; i < a.length(); i++ )
+	{
+		a[i] = i * 0.5;
+		b[i] = 1.0 / (i + 1);
+	}
+
+	double dot = 0;
+	for( int k = 0; k < 100; k++ )
+		for( uint i = 0; i < a.length(); i++ )
+			dot += a[i] * b[i] + k;
+	check(dot > 0, "arraymath");
+}
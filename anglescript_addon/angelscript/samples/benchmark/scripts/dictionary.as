@@ -0,0 +1,48 @@
+// Dictionary operations from a script, including the cost of the calls
+// into the add-on. Run it with 'scriptbench -r 1'
+void bench(int n)
+{
+	array<string> keys(n), missing(n);
+	for( int i = 0; i < n; i++ )
+	{
+		keys[i] = "key_" + (i * 7919);
+		missing[i] = "nokey_" + i;
+	}
+
+	dictionary d;
+	double t = now();
+	for( int i = 0; i < n; i++ )
+		d.set(keys[i], int64(i));
+	double ins = now() - t;
+
+	int64 v, sum = 0;
+	t = now();
+	for( int i = 0; i < n; i++ )
+	{
+		d.get(keys[i], v);
+		sum += v;
+	}
+	double hit = now() - t;
+
+	int found = 0;
+	t = now();
+	for( int i = 0; i < n; i++ )
+		if( d.exists(missing[i]) )
+			found++;
+	double miss = now() - t;
+
+	t = now();
+	for( int i = 0; i < n; i++ )
+		d.delete(keys[i]);
+	double del = now() - t;
+
+	print("n=" + n + " insert " + ins*1e6/n + " ns  hit " + hit*1e6/n + " ns  miss " + miss*1e6/n + " ns  delete " + del*1e6/n + " ns\n");
+	check(found == 0 && d.isEmpty() && sum == int64(n) * (n - 1) / 2, "dictionary");
+}
+
+void main()
+{
+	bench(1000);
+	bench(100000);
+	bench(1000000);
+}
@@ -0,0 +1,12 @@
+// Recursive calls
+int fib(int n)
+{
+	if( n < 2 )
+		return n;
+	return fib(n-1) + fib(n-2);
+}
+
+void main()
+{
+	check(fib(30) == 832040, "fib");
+}
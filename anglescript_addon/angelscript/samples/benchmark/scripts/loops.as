@@ -0,0 +1,9 @@
+// Nested loops with integer arithmetic
+void main()
+{
+	int sum = 0;
+	for( int i = 0; i < 3000; i++ )
+		for( int j = 0; j < 3000; j++ )
+			sum += (i ^ j) & 7;
+	check(sum == 31500000, "loops " + sum);
+}
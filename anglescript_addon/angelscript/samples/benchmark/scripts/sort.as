@@ -0,0 +1,57 @@
+// Sorts shuffled arrays of int, double, string and a script class with
+// opCmp, and prints the time of each sort. Run it with 'scriptbench -r 1'.
+// The class isn't sorted at 1M elements as every instance holds a
+// reference to the type, and debug builds assert on a million references
+class Item
+{
+	int key;
+	int opCmp(const Item &in o) const { return key - o.key; }
+}
+
+uint seed = 12345;
+int rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return int((seed >> 8) & 0xffffff);
+}
+
+void bench(int n, bool objects)
+{
+	array<int> ai(n);
+	array<double> ad(n);
+	array<string> as(n);
+	array<Item> ao(objects ? n : 0);
+	for( int i = 0; i < n; i++ )
+	{
+		int r = rnd();
+		ai[i] = r;
+		ad[i] = r * 0.5;
+		as[i] = "" + rnd();
+		if( objects )
+			ao[i].key = rnd();
+	}
+
+	double t = now(); ai.sortAsc(); print("int    " + n + ": " + (now() - t) + " ms\n");
+	t = now(); ad.sortAsc(); print("double " + n + ": " + (now() - t) + " ms\n");
+	t = now(); as.sortAsc(); print("string " + n + ": " + (now() - t) + " ms\n");
+	if( objects )
+	{
+		t = now(); ao.sortAsc(); print("class  " + n + ": " + (now() - t) + " ms\n");
+	}
+
+	for( int i = 1; i < n; i++ )
+	{
+		if( ai[i-1] > ai[i] || ad[i-1] > ad[i] || as[i-1] > as[i] || (objects && ao[i-1].key > ao[i].key) )
+		{
+			check(false, "sorted " + i);
+			break;
+		}
+	}
+}
+
+void main()
+{
+	bench(1000, true);
+	bench(100000, true);
+	bench(1000000, false);
+}
@@ -0,0 +1,13 @@
+// String building
+void main()
+{
+	uint total = 0;
+	for( int k = 0; k < 200; k++ )
+	{
+		string s;
+		for( int i = 0; i < 1000; i++ )
+			s += "x" + i;
+		total += s.length();
+	}
+	check(total == 200 * 3890, "strings " + total);
+}
@@ -0,0 +1,39 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <angelscript.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+// Milliseconds since an arbitrary point in time
+inline double BenchNow()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return double(count.QuadPart) * 1000.0 / double(freq.QuadPart);
+#else
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+inline void BenchMessageCallback(const asSMessageInfo *msg, void *)
+{
+	const char *type = "ERR ";
+	if( msg->type == asMSGTYPE_WARNING )
+		type = "WARN";
+	else if( msg->type == asMSGTYPE_INFORMATION )
+		type = "INFO";
+
+	printf("%s (%d, %d) : %s : %s\n", msg->section, msg->row, msg->col, type, msg->message);
+}
+
+#endif
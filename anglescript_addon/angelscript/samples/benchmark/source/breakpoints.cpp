@@ -0,0 +1,90 @@
+// Runs a tight script loop with a breakpoint in a function that is never
+// called. Compares running without a debugger, the line callback of the
+// debugger add-on and a breakpoint patched into the bytecode with
+// asIScriptFunction::SetBreakpoint.
+//
+// Usage: breakpoints
+
+#include <angelscript.h>
+#include <debugger/debugger.h>
+#include <stdio.h>
+#include "bench_utils.h"
+
+static const char *script =
+"int never(int a)       \n"
+"{                      \n"
+"  return a * 3;        \n"
+"}                      \n"
+"int main()             \n"
+"{                      \n"
+"  int s = 0;           \n"
+"  for( int i = 0; i < 20000000; i++ ) \n"
+"  {                    \n"
+"    s += i & 7;        \n"
+"    if( s < 0 )        \n"
+"      s = never(s);    \n"
+"  }                    \n"
+"  return s;            \n"
+"}                      \n";
+
+static int hits = 0;
+
+static void BreakpointCallback(asIScriptContext *)
+{
+	hits++;
+}
+
+int main()
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asFUNCTION(BenchMessageCallback), 0, asCALL_CDECL);
+
+	asIScriptModule *mod = engine->GetModule("bench", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("bench.as", script);
+	if( mod->Build() < 0 )
+		return 1;
+
+	asIScriptFunction *func  = mod->GetFunctionByName("main");
+	asIScriptFunction *never = mod->GetFunctionByName("never");
+	const char *names[] = { "undebugged", "line callback (CDebugger)", "patched breakpoint" };
+
+	for( int mode = 0; mode < 3; mode++ )
+	{
+		asIScriptContext *ctx = engine->CreateContext();
+		CDebugger debugger;
+
+		if( mode == 1 )
+		{
+			debugger.AddFileBreakPoint("bench.as", 3);
+			ctx->SetLineCallback(asMETHOD(CDebugger, LineCallback), &debugger, asCALL_THISCALL);
+		}
+		else if( mode == 2 )
+		{
+			never->SetBreakpoint(3, true);
+			ctx->SetBreakpointCallback(asFUNCTION(BreakpointCallback), 0, asCALL_CDECL);
+		}
+
+		double best = 0;
+		for( int run = 0; run < 3; run++ )
+		{
+			ctx->Prepare(func);
+			double start = BenchNow();
+			ctx->Execute();
+			double time = BenchNow() - start;
+			if( run == 0 || time < best )
+				best = time;
+		}
+
+		printf("%-28s %8.1f ms (best of 3)\n", names[mode], best);
+
+		if( mode == 2 )
+			never->SetBreakpoint(3, false);
+		ctx->Release();
+	}
+
+	if( hits != 0 )
+		printf("FAILED: the breakpoint was hit %d times\n", hits);
+
+	engine->Release();
+	return hits ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+// Generates a large module and compares how long it takes to load it
+// into a fresh engine from the stream format (SaveByteCode) and from the
+// bytecode image format (SaveByteCodeImage). The stream format is also
+// loaded through LoadByteCodeImage, which accepts it from memory.
+//
+// Usage: bytecodeimage [units] [runs]
+//
+// Each unit adds a class, a global variable and a function to the module
+
+#include <angelscript.h>
+#include <scriptstdstring/scriptstdstring.h>
+#include <scriptarray/scriptarray.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "bench_utils.h"
+
+using namespace std;
+
+class CBytecodeStream : public asIBinaryStream
+{
+public:
+	CBytecodeStream() : readPos(0) {}
+
+	void Write(const void *ptr, asUINT size)
+	{
+		if( size == 0 ) return;
+		buffer.insert(buffer.end(), (const char*)ptr, (const char*)ptr + size);
+	}
+
+	void Read(void *ptr, asUINT size)
+	{
+		memcpy(ptr, &buffer[readPos], size);
+		readPos += size;
+	}
+
+	vector<char> buffer;
+	size_t       readPos;
+};
+
+static asIScriptEngine *CreateEngine()
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asFUNCTION(BenchMessageCallback), 0, asCALL_CDECL);
+	RegisterStdString(engine);
+	RegisterScriptArray(engine, true);
+	return engine;
+}
+
+static string GenerateScript(int units)
+{
+	string script;
+	char buf[2048];
+	for( int i = 0; i < units; i++ )
+	{
+		sprintf(buf,
+			"class C%d { int a; double d; string name; array<int> arr; C%d@ next;\n"
+			"  C%d() { a = %d; d = 1.5; name = 'c%d'; arr.resize(3); }\n"
+			"  int Sum(int x) { int s = 0; for( uint n = 0; n < arr.length(); n++ ) s += arr[n] * x + a; if( s > 10 ) s -= 3; else s += 7; return s; }\n"
+			"  string Describe() { return name + ':' + a + ':' + d; }\n"
+			"}\n"
+			"int g%d = %d;\n"
+			"string f%d(int x, const string &in p) { C%d c; c.a = x; string r = p + c.Describe() + 'literal%d'; array<string> l = {'a%d','b','c'}; for( uint n = 0; n < l.length(); n++ ) r += l[n]; g%d += c.Sum(x); return r; }\n",
+			i, i, i, i, i, i, i, i, i, i, i, i);
+		script += buf;
+	}
+
+	// Call some of the functions so the loaded module can be checked
+	script += "int main() { int t = 0; ";
+	for( int i = 0; i < units; i += 50 )
+	{
+		sprintf(buf, "t += f%d(%d, 'x').length(); ", i, i);
+		script += buf;
+	}
+	script += "return t; }\n";
+
+	return script;
+}
+
+static int RunMain(asIScriptModule *mod)
+{
+	asIScriptContext *ctx = mod->GetEngine()->CreateContext();
+	ctx->Prepare(mod->GetFunctionByDecl("int main()"));
+	ctx->Execute();
+	int r = (int)ctx->GetReturnDWord();
+	ctx->Release();
+	return r;
+}
+
+int main(int argc, char **argv)
+{
+	int units = argc > 1 ? atoi(argv[1]) : 400;
+	int runs  = argc > 2 ? atoi(argv[2]) : 5;
+
+	string script = GenerateScript(units);
+
+	asIScriptEngine *engine = CreateEngine();
+	asIScriptModule *mod = engine->GetModule("bench", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("bench", script.c_str(), script.size());
+	double start = BenchNow();
+	if( mod->Build() < 0 )
+		return 1;
+	printf("build:              %8.2f ms, %u functions\n", BenchNow() - start, mod->GetFunctionCount());
+
+	int expected = RunMain(mod);
+
+	CBytecodeStream stream, image;
+	mod->SaveByteCode(&stream);
+	mod->SaveByteCodeImage(&image);
+	engine->Release();
+
+	printf("stream format:      %8u bytes\n", (unsigned)stream.buffer.size());
+	printf("image format:       %8u bytes\n", (unsigned)image.buffer.size());
+
+	int failures = 0;
+	for( int run = 0; run < runs; run++ )
+	{
+		// stream format through asIBinaryStream, image format and stream format from memory
+		for( int format = 0; format < 3; format++ )
+		{
+			engine = CreateEngine();
+			mod = engine->GetModule("bench", asGM_ALWAYS_CREATE);
+
+			int r;
+			start = BenchNow();
+			if( format == 0 )
+			{
+				stream.readPos = 0;
+				r = mod->LoadByteCode(&stream);
+			}
+			else if( format == 1 )
+				r = mod->LoadByteCodeImage(&image.buffer[0], (asUINT)image.buffer.size());
+			else
+				r = mod->LoadByteCodeImage(&stream.buffer[0], (asUINT)stream.buffer.size());
+			double time = BenchNow() - start;
+
+			const char *names[] = { "stream load:", "image load:", "stream from memory:" };
+			printf("%-19s %8.2f ms\n", names[format], time);
+
+			if( r < 0 || RunMain(mod) != expected )
+			{
+				printf("FAILED: the loaded module doesn't work (%d)\n", r);
+				failures++;
+			}
+
+			engine->Release();
+		}
+	}
+
+	return failures ? 1 : 0;
+}
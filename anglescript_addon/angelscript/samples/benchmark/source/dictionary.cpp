@@ -0,0 +1,132 @@
+// Times insert, lookup of existing and missing keys, and delete on
+// CScriptDictionary through the C++ interface, at 1k, 100k and 1M keys.
+// The same operations on a std::map<std::string, asINT64> are timed as
+// a reference, as that is what the dictionary used to be built on.
+//
+// Usage: dictionary
+
+#include <angelscript.h>
+#include <scriptstdstring/scriptstdstring.h>
+#include <scriptarray/scriptarray.h>
+#include <scriptdictionary/scriptdictionary.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "bench_utils.h"
+
+using namespace std;
+
+struct Timings
+{
+	Timings() : insert(0), hit(0), miss(0), remove(0) {}
+	double insert, hit, miss, remove;
+};
+
+static void Report(const char *name, int n, int reps, const Timings &t)
+{
+	// Nanoseconds per operation
+	double k = 1e6 / n / reps;
+	printf("%-10s n=%-8d insert %6.1f ns  hit %6.1f ns  miss %6.1f ns  delete %6.1f ns\n",
+		name, n, t.insert*k, t.hit*k, t.miss*k, t.remove*k);
+}
+
+int main()
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asFUNCTION(BenchMessageCallback), 0, asCALL_CDECL);
+	RegisterStdString(engine);
+	RegisterScriptArray(engine, true);
+	RegisterScriptDictionary(engine);
+
+	int sizes[] = { 1000, 100000, 1000000 };
+	asINT64 dictSum = 0, refSum = 0;
+
+	for( int s = 0; s < 3; s++ )
+	{
+		int n = sizes[s];
+		vector<string> keys(n), missing(n);
+		char buf[64];
+		for( int i = 0; i < n; i++ )
+		{
+			sprintf(buf, "key_%d", i * 7919);
+			keys[i] = buf;
+			sprintf(buf, "nokey_%d", i);
+			missing[i] = buf;
+		}
+
+		// Repeat the small sizes so each measurement covers about a million operations
+		int reps = 1000000 / n;
+		if( reps < 1 )
+			reps = 1;
+
+		Timings dict, ref;
+		for( int r = 0; r < reps; r++ )
+		{
+			CScriptDictionary *d = CScriptDictionary::Create(engine);
+			double t = BenchNow();
+			for( int i = 0; i < n; i++ )
+				d->Set(keys[i], (asINT64)i);
+			dict.insert += BenchNow() - t;
+
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+			{
+				asINT64 v = 0;
+				d->Get(keys[i], v);
+				dictSum += v;
+			}
+			dict.hit += BenchNow() - t;
+
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+				dictSum += d->Exists(missing[i]);
+			dict.miss += BenchNow() - t;
+
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+				d->Delete(keys[i]);
+			dict.remove += BenchNow() - t;
+
+			d->Release();
+
+			map<string, asINT64> m;
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+				m[keys[i]] = i;
+			ref.insert += BenchNow() - t;
+
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+			{
+				map<string, asINT64>::iterator it = m.find(keys[i]);
+				if( it != m.end() )
+					refSum += it->second;
+			}
+			ref.hit += BenchNow() - t;
+
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+				refSum += m.find(missing[i]) != m.end();
+			ref.miss += BenchNow() - t;
+
+			t = BenchNow();
+			for( int i = 0; i < n; i++ )
+				m.erase(keys[i]);
+			ref.remove += BenchNow() - t;
+		}
+
+		Report("dictionary", n, reps, dict);
+		Report("std::map", n, reps, ref);
+	}
+
+	engine->Release();
+
+	// Both containers were given the same keys and values
+	if( dictSum != refSum )
+	{
+		printf("FAILED: the dictionary and the map gave different results\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+// Calls small registered application functions 10M times from a script
+// loop, with a few different signatures and calling conventions.
+//
+// Usage: nativecalls
+
+#include <angelscript.h>
+#include <stdio.h>
+#include "bench_utils.h"
+
+static int Add(int a, int b) { return a + b; }
+static float MulF(float a, double b, int c) { return float(a * b) + c; }
+static void Noop() {}
+
+struct Obj
+{
+	int v;
+	int Get(int x) { return v + x; }
+	virtual int VGet(int x) { return v * x; }
+	double DGet(double d, float f) { return v + d + f; }
+};
+
+static int ObjLast(int x, Obj *o) { return o->v - x; }
+
+static Obj obj;
+
+static const char *script =
+"int    callAdd()     { int s = 0;    for( int i = 0; i < 10000000; i++ ) s = add(s, i); return s; }\n"
+"float  callMulF()    { float s = 0;  for( int i = 0; i < 10000000; i++ ) s += mulf(0.5f, 2.0, i & 3); return s; }\n"
+"int    callMethod()  { int s = 0;    for( int i = 0; i < 10000000; i++ ) s += obj.get(i); return s; }\n"
+"int    callVirtual() { int s = 0;    for( int i = 0; i < 10000000; i++ ) s += obj.vget(i & 7) + obj.objlast(i & 7); return s; }\n"
+"double callDMethod() { double s = 0; for( int i = 0; i < 10000000; i++ ) s += obj.dget(1.5, 0.25f); return s; }\n"
+"void   callNoop()    { for( int i = 0; i < 10000000; i++ ) noop(); }\n";
+
+int main()
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asFUNCTION(BenchMessageCallback), 0, asCALL_CDECL);
+
+	engine->RegisterGlobalFunction("int add(int, int)", asFUNCTION(Add), asCALL_CDECL);
+	engine->RegisterGlobalFunction("float mulf(float, double, int)", asFUNCTION(MulF), asCALL_CDECL);
+	engine->RegisterGlobalFunction("void noop()", asFUNCTION(Noop), asCALL_CDECL);
+	engine->RegisterObjectType("Obj", 0, asOBJ_REF | asOBJ_NOCOUNT);
+	engine->RegisterObjectMethod("Obj", "int get(int)", asMETHOD(Obj, Get), asCALL_THISCALL);
+	engine->RegisterObjectMethod("Obj", "int vget(int)", asMETHOD(Obj, VGet), asCALL_THISCALL);
+	engine->RegisterObjectMethod("Obj", "double dget(double, float)", asMETHOD(Obj, DGet), asCALL_THISCALL);
+	engine->RegisterObjectMethod("Obj", "int objlast(int)", asFUNCTION(ObjLast), asCALL_CDECL_OBJLAST);
+	engine->RegisterGlobalProperty("Obj obj", &obj);
+	obj.v = 3;
+
+	asIScriptModule *mod = engine->GetModule("bench", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("bench", script);
+	if( mod->Build() < 0 )
+		return 1;
+
+	const char *names[] = { "callAdd", "callMulF", "callMethod", "callVirtual", "callDMethod", "callNoop" };
+	const char *descriptions[] =
+	{
+		"int add(int, int)",
+		"float mulf(float, double, int)",
+		"obj.get(int), thiscall",
+		"virtual + cdecl_objlast, 20M calls",
+		"double dget(double, float)",
+		"void noop()"
+	};
+
+	asIScriptContext *ctx = engine->CreateContext();
+	for( int n = 0; n < 6; n++ )
+	{
+		ctx->Prepare(mod->GetFunctionByName(names[n]));
+		double start = BenchNow();
+		ctx->Execute();
+		printf("%-36s %8.1f ms\n", descriptions[n], BenchNow() - start);
+	}
+
+	ctx->Release();
+	engine->Release();
+	return 0;
+}
@@ -0,0 +1,111 @@
+// Runs the 'void main()' function of each script given on the command
+// line and prints the best time of a number of runs. Besides the string,
+// array, dictionary and math add-ons the scripts can use:
+//
+//  double now()                          milliseconds, for timing parts of a script
+//  void print(const string &in)
+//  void check(bool, const string &in)    reports a failure, the exit code is non-zero
+//
+// Usage: scriptbench [-r runs] script.as...
+
+#include <angelscript.h>
+#include <scriptstdstring/scriptstdstring.h>
+#include <scriptarray/scriptarray.h>
+#include <scriptdictionary/scriptdictionary.h>
+#include <scriptmath/scriptmath.h>
+#include <scriptbuilder/scriptbuilder.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "bench_utils.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static void Print(const string &str)
+{
+	printf("%s", str.c_str());
+}
+
+static void Check(bool ok, const string &what)
+{
+	if( !ok )
+	{
+		printf("FAILED: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int runs = 5;
+	int first = 1;
+	if( argc > 2 && strcmp(argv[1], "-r") == 0 )
+	{
+		runs = atoi(argv[2]);
+		first = 3;
+	}
+
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asFUNCTION(BenchMessageCallback), 0, asCALL_CDECL);
+	RegisterStdString(engine);
+	RegisterScriptArray(engine, true);
+	RegisterStdStringUtils(engine);
+	RegisterScriptDictionary(engine);
+	RegisterScriptMath(engine);
+	engine->RegisterGlobalFunction("double now()", asFUNCTION(BenchNow), asCALL_CDECL);
+	engine->RegisterGlobalFunction("void print(const string &in)", asFUNCTION(Print), asCALL_CDECL);
+	engine->RegisterGlobalFunction("void check(bool, const string &in)", asFUNCTION(Check), asCALL_CDECL);
+
+	asIScriptContext *ctx = engine->CreateContext();
+
+	for( int n = first; n < argc; n++ )
+	{
+		CScriptBuilder builder;
+		builder.StartNewModule(engine, argv[n]);
+		if( builder.AddSectionFromFile(argv[n]) < 0 || builder.BuildModule() < 0 )
+		{
+			printf("%s: failed to build\n", argv[n]);
+			failures++;
+			continue;
+		}
+
+		asIScriptFunction *func = builder.GetModule()->GetFunctionByDecl("void main()");
+		if( func == 0 )
+		{
+			printf("%s: no 'void main()'\n", argv[n]);
+			failures++;
+			continue;
+		}
+
+		double best = 0;
+		for( int run = 0; run < runs; run++ )
+		{
+			ctx->Prepare(func);
+			double start = BenchNow();
+			int r = ctx->Execute();
+			double time = BenchNow() - start;
+
+			if( r != asEXECUTION_FINISHED )
+			{
+				if( r == asEXECUTION_EXCEPTION )
+					printf("%s: exception '%s' at line %d\n", argv[n], ctx->GetExceptionString(), ctx->GetExceptionLineNumber());
+				failures++;
+				break;
+			}
+
+			if( run == 0 || time < best )
+				best = time;
+		}
+
+		printf("%-30s %10.2f ms (best of %d)\n", argv[n], best, runs);
+		builder.GetModule()->Discard();
+	}
+
+	ctx->Release();
+	engine->Release();
+
+	return failures ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <asdbg_engine.h>
+#include <asdbg_profiler.h>
 
 namespace asdbg {
 
@@ -2,14 +2,17 @@
 #include "asdbg_engine.h"
 
 #include <pd_backend.h>
+#include <pd_readwrite.h>
 #include <pd_remote.h>
 
+#include <algorithm> // find
 #include <iostream>  // cout
 #include <sstream>   // stringstream
 #include <stdlib.h>  // atoi
 #include <assert.h>  // assert
 #include <stdarg.h>  // va_arg
 #include <string.h>  // memset
+#include <unordered_set>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -39,6 +42,8 @@ typedef struct AngelScriptDebugger {
     asdbg::Engine* engine;
     asIScriptContext* context;
     int runState;
+    int action;     // last run/step action from the debugger
+    asUINT frame;   // selected stack level
 
 } AngelScriptDebugger;
 
@@ -55,6 +60,7 @@ static void* createInstance(ServiceFunc* serviceFunc) {
     memset(g_debugger, 0, sizeof(AngelScriptDebugger));
 
     g_debugger->runState = PDDebugState_Running;
+    g_debugger->action = PDAction_Run;
 
     return g_debugger;
 }
@@ -68,36 +74,86 @@ static void destroyInstance(void* userData) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+static void doAction(AngelScriptDebugger* debugger, PDAction action) {
+    switch (action) {
+        case PDAction_Break:
+            debugger->runState = PDDebugState_StopBreakpoint;
+            break;
+
+        case PDAction_Run:
+        case PDAction_Step:
+        case PDAction_StepOut:
+        case PDAction_StepOver:
+            debugger->runState = PDDebugState_Running;
+            debugger->action = action;
+            break;
+
+        default:
+            break;
+    }
+}
 
-static PDDebugState update(void* userData, PDAction action, PDReader* reader, PDWriter* writer) {
-    //int event = 0;
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    (void)reader;
+static void getLocals(AngelScriptDebugger* debugger, PDReader* reader, PDWriter* writer) {
+    const char* path = nullptr;
+    uint32_t start = 0;
+    uint32_t count = ~0u;
 
-    AngelScriptDebugger* debugger = (AngelScriptDebugger*)userData;
+    // Without a path the top level variables are sent, otherwise the children of the given variable
 
-    /*processEvents(plugin, reader, writer);
+    PDRead_find_string(reader, &path, "path", 0);
 
-       doAction(plugin, action);
+    if (!path || !path[0]) {
+        debugger->engine->writeLocals(debugger->context, debugger->frame, writer);
+        return;
+    }
 
-       if (plugin->state == PDDebugState_running)
-        updateLLDBEvent(plugin, writer);*/
+    PDRead_find_u32(reader, &start, "start", 0);
+    PDRead_find_u32(reader, &count, "count", 0);
 
-    //doAction(debugger, action, writer);
+    debugger->engine->writeChildren(debugger->context, debugger->frame, path, start, count, writer);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static PDDebugState update(void* userData, PDAction action, PDReader* reader, PDWriter* writer) {
+    AngelScriptDebugger* debugger = (AngelScriptDebugger*)userData;
+
+    doAction(debugger, action);
 
     uint32_t event;
     while ((event = PDRead_get_event(reader)) != 0) {
+        // Script state can only be inspected while we are stopped
+        if (!debugger->context || !debugger->engine) {
+            log_out("Ignoring event %d while script is running\n", event);
+            continue;
+        }
+
         switch (event) {
             case PDEventType_GetCallstack:
-                log_out("GetCallstack!\n");
-                //debugger->engine
-                //getCallstack(reader, writer);
+                debugger->engine->writeCallstack(debugger->context, writer);
                 break;
 
             case PDEventType_GetLocals:
-                log_out("GetLocals!\n");
-                //getLocals(reader, writer);
+                getLocals(debugger, reader, writer);
+                break;
+
+            case PDEventType_GetWatch:
+                debugger->engine->writeWatches(debugger->context, debugger->frame, writer);
+                break;
+
+            case PDEventType_SelectFrame:
+            {
+                uint32_t frame = 0;
+                PDRead_find_u32(reader, &frame, "frame", 0);
+
+                if (frame < debugger->context->GetCallstackSize())
+                    debugger->frame = frame;
+
+                debugger->engine->writeLocals(debugger->context, debugger->frame, writer);
                 break;
+            }
         }
     }
 
@@ -117,6 +173,61 @@ PDBackendPlugin s_asdebuggerPlugin =
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+static std::string fileName(const char* path) {
+    if (!path)
+        return std::string();
+
+    std::string file(path);
+    size_t r = file.find_last_of("\\/");
+    if (r != std::string::npos)
+        return file.substr(r + 1);
+
+    return file;
+}
+
+static bool isMember(asIObjectType* type, const char* name) {
+    for (asUINT prop = 0; prop < type->GetPropertyCount(); ++prop) {
+        const char* propName = nullptr;
+        type->GetProperty(prop, &propName);
+        if (strcmp(propName, name) == 0)
+            return true;
+    }
+
+    return type->GetMethodByName(name) != nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static asQWORD lineKey(int section, int line) {
+    return ((asQWORD)(asUINT)section << 32) | (asUINT)line;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// All script functions in a module that can contain breakpoints (global functions and class methods)
+
+static void collectFunctions(asIScriptModule* module, std::vector<asIScriptFunction*>& functions) {
+    for (asUINT n = 0; n < module->GetFunctionCount(); ++n)
+        functions.push_back(module->GetFunctionByIndex(n));
+
+    for (asUINT t = 0; t < module->GetObjectTypeCount(); ++t) {
+        asIObjectType* type = module->GetObjectTypeByIndex(t);
+
+        for (asUINT n = 0; n < type->GetMethodCount(); ++n) {
+            asIScriptFunction* func = type->GetMethodByIndex(n, false);
+            if (func->GetFuncType() == asFUNC_SCRIPT)
+                functions.push_back(func);
+        }
+
+        for (asUINT n = 0; n < type->GetBehaviourCount(); ++n) {
+            asIScriptFunction* func = type->GetBehaviourByIndex(n, 0);
+            if (func->GetFuncType() == asFUNC_SCRIPT)
+                functions.push_back(func);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 namespace asdbg {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -126,10 +237,23 @@ void Engine::registerToStringFunc(const asIObjectType* type, ToStringFunc callba
         m_toStringCallbacks.insert(std::map<const asIObjectType*, ToStringFunc>::value_type(type, callback));
 }
 
+void Engine::registerContainerFuncs(const asIObjectType* type, ElementCountFunc countFunc, ElementFunc elementFunc) {
+    ContainerFuncs funcs;
+    funcs.count = countFunc;
+    funcs.element = elementFunc;
+
+    m_containerCallbacks[type] = funcs;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 Engine::Engine()
     : m_debugAction(DebugAction_Continue)
     , m_lastCommandAtStackLevel(0)
     , m_lastFunction(nullptr)
+    , m_checkedFunction(nullptr)
+    , m_checkedInfo(nullptr)
+    , m_evaluating(false)
     , m_connected(false) {
     if (!PDRemote_create(&s_asdebuggerPlugin, 0)) {
         output("Unable to setup debugger connection\n");
@@ -142,7 +266,10 @@ Engine::Engine()
 }
 
 Engine::~Engine() {
-
+    for (std::map<WatchKey, Watch>::iterator it = m_watchCache.begin(); it != m_watchCache.end(); ++it) {
+        if (it->second.func)
+            it->second.func->Release();
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -155,7 +282,12 @@ void Engine::tick() {
         return;
     }
 
-    PDRemote_update(1);
+    // Only sleep while we are stopped and waiting for the debugger. When the script is running the update
+    // should return directly if there is nothing on the socket instead of adding 1 ms latency per tick
+
+    const bool running = !g_debugger || g_debugger->runState == PDDebugState_Running;
+
+    PDRemote_update(running ? 0 : 1);
 
 #if 0
     if (g_debugger->runState == PDDebugState_stopException) {
@@ -189,7 +321,43 @@ void Engine::tick() {
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Engine::takeCommands(asIScriptContext* context) {
+    if (!g_debugger)
+        return;
+
+    g_debugger->engine = this;
+    g_debugger->context = context;
+    g_debugger->frame = 0;
+    g_debugger->runState = PDDebugState_StopBreakpoint;
+
+    // Wait until the debugger tells us to continue
+    while (g_debugger->runState != PDDebugState_Running && PDRemote_isConnected())
+        tick();
+
+    g_debugger->context = nullptr;
+
+    switch (g_debugger->action) {
+        case PDAction_Step:
+            m_debugAction = DebugAction_StepInto;
+            break;
+        case PDAction_StepOver:
+            m_debugAction = DebugAction_StepOver;
+            break;
+        case PDAction_StepOut:
+            m_debugAction = DebugAction_StepOut;
+            break;
+        default:
+            m_debugAction = DebugAction_Continue;
+            break;
+    }
+
+    m_lastCommandAtStackLevel = context->GetCallstackSize();
+    m_lastFunction = context->GetFunction();
 
+    // Only pay for the line callback while stepping, breakpoints are trapped by the patched bytecode
+    if (m_debugAction != DebugAction_Continue)
+        context->SetLineCallback(asMETHOD(Engine, lineCallback), this, asCALL_THISCALL);
+    else
+        context->ClearLineCallback();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -201,8 +369,146 @@ void Engine::output(const std::string& text) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Engine::addModule(asIScriptModule* module) {
+    // A module that is already known may have been rebuilt in place, so the old functions are gone
+    if (std::find(m_modules.begin(), m_modules.end(), module) != m_modules.end())
+        forgetFunctions(module);
+    else
+        m_modules.push_back(module);
+
+    std::vector<asIScriptFunction*> functions;
+    collectFunctions(module, functions);
+
+    for (size_t i = 0; i < functions.size(); ++i) {
+        FunctionInfo info;
+        info.module = module;
+        info.section = internSection(fileName(functions[i]->GetScriptSectionName()));
+        info.entryLine = -1;
+        info.hasBreakpoints = false;
+
+        m_functions[functions[i]] = info;
+    }
+
+    m_checkedFunction = nullptr;
+
+    for (size_t breakpoint = 0; breakpoint < m_breakpoints.size(); ++breakpoint)
+        installBreakpoint(breakpoint, functions);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::removeModule(asIScriptModule* module) {
+    std::vector<asIScriptModule*>::iterator it = std::find(m_modules.begin(), m_modules.end(), module);
+    if (it == m_modules.end())
+        return;
+
+    m_modules.erase(it);
+    forgetFunctions(module);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Drops the function info and the compiled watches of a module. The functions may already have been freed so they are
+// only used as keys
+
+void Engine::forgetFunctions(asIScriptModule* module) {
+    std::unordered_set<const asIScriptFunction*> functions;
+
+    for (std::unordered_map<const asIScriptFunction*, FunctionInfo>::iterator it = m_functions.begin(); it != m_functions.end();) {
+        if (it->second.module == module) {
+            functions.insert(it->first);
+            it = m_functions.erase(it);
+        }else {
+            ++it;
+        }
+    }
+
+    for (std::map<WatchKey, Watch>::iterator it = m_watchCache.begin(); it != m_watchCache.end();) {
+        if (functions.count(it->first.first)) {
+            if (it->second.func)
+                it->second.func->Release();
+            m_watchCache.erase(it++);
+        }else {
+            ++it;
+        }
+    }
+
+    m_checkedFunction = nullptr;
+    m_checkedInfo = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Engine::internSection(const std::string& file) {
+    std::unordered_map<std::string, int>::const_iterator it = m_sections.find(file);
+    if (it != m_sections.end())
+        return it->second;
+
+    int id = (int)m_sections.size();
+    m_sections.insert(std::unordered_map<std::string, int>::value_type(file, id));
+
+    return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::attachContext(asIScriptContext* context) {
+    context->SetBreakpointCallback(asMETHOD(Engine, breakpointCallback), this, asCALL_THISCALL);
+
+    // Watch expressions pass their value to this function. It's registered here rather than while the script is
+    // stopped so the application's configuration doesn't change under it in the middle of a run
+    asIScriptEngine* engine = context->GetEngine();
+
+    if (!engine->GetGlobalFunctionByDecl("void __asdbg_watch(?&in)")) {
+        int r = engine->RegisterGlobalFunction("void __asdbg_watch(?&in)", asFUNCTION(Engine::watchResult), asCALL_GENERIC);
+        if (r < 0) {
+            std::stringstream s;
+            s << "Unable to register the watch function (" << r << "), watch expressions won't be available" << std::endl;
+            output(s.str());
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Engine::lineCallback(asIScriptContext* context) {
+    // The line callback is only set while stepping (and must not stop inside watch expressions)
+    if (context->GetState() != asEXECUTION_ACTIVE || m_evaluating)
+        return;
+
+    switch (m_debugAction) {
+        case DebugAction_Continue:
+            context->ClearLineCallback();
+            return;
+
+        case DebugAction_StepOver:
+            if (context->GetCallstackSize() > m_lastCommandAtStackLevel)
+                return;
+            break;
+
+        case DebugAction_StepOut:
+            if (context->GetCallstackSize() >= m_lastCommandAtStackLevel)
+                return;
+            break;
 
+        case DebugAction_StepInto:
+            break;
+    }
+
+    // Breakpoints on this line are handled by the breakpoint callback that is called right after
+    if (checkBreakPoint(context))
+        return;
+
+    takeCommands(context);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::breakpointCallback(asIScriptContext* context) {
+    // The bytecode is shared by all contexts (and debuggers) using the module so make sure it's one of ours
+    if (m_evaluating || !checkBreakPoint(context))
+        return;
+
+    takeCommands(context);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -225,8 +531,13 @@ void Engine::addFileBreakpoint(const std::string& file, int line) {
     s << "Setting break point in file '" << actual << "' at line " << line << std::endl;
     output(s.str());
 
-    Breakpoint bp(actual, line, false);
-    m_breakpoints.push_back(bp);
+    m_breakpoints.push_back(Breakpoint(actual, internSection(actual), line, false));
+
+    std::vector<asIScriptFunction*> functions;
+    for (size_t i = 0; i < m_modules.size(); ++i)
+        collectFunctions(m_modules[i], functions);
+
+    installBreakpoint(m_breakpoints.size() - 1, functions);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -241,8 +552,13 @@ void Engine::addFuncBreakpoint(const std::string& func) {
     s << "Adding deferred break point for function '" << actual << "'" << std::endl;
     output(s.str());
 
-    Breakpoint bp(actual, 0, true);
-    m_breakpoints.push_back(bp);
+    m_breakpoints.push_back(Breakpoint(actual, -1, 0, true));
+
+    std::vector<asIScriptFunction*> functions;
+    for (size_t i = 0; i < m_modules.size(); ++i)
+        collectFunctions(m_modules[i], functions);
+
+    installBreakpoint(m_breakpoints.size() - 1, functions);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -374,81 +690,532 @@ void Engine::printValue(const std::string& expression, asIScriptContext* context
         return;
     }
 
+    output(evaluate(expression, context, 0) + "\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::writeCallstack(asIScriptContext* context, PDWriter* writer) {
+    PDWrite_event_begin(writer, PDEventType_SetCallstack);
+    PDWrite_array_begin(writer, "callstack");
+
+    for (asUINT level = 0; level < context->GetCallstackSize(); ++level) {
+        asIScriptFunction* func = context->GetFunction(level);
+        const char* file = nullptr;
+        int line = context->GetLineNumber(level, 0, &file);
+
+        PDWrite_array_entry_begin(writer);
+        PDWrite_string(writer, "filename", file ? file : "");
+        PDWrite_u32(writer, "line", (uint32_t)line);
+
+        if (func) {
+            PDWrite_string(writer, "module_name", func->GetModuleName() ? func->GetModuleName() : "");
+            PDWrite_string(writer, "function", func->GetDeclaration());
+        }
+
+        PDWrite_array_entry_end(writer);
+    }
+
+    PDWrite_array_end(writer);
+    PDWrite_event_end(writer);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::writeLocals(asIScriptContext* context, asUINT stackLevel, PDWriter* writer) {
     asIScriptEngine* engine = context->GetEngine();
+    asIScriptFunction* func = context->GetFunction(stackLevel);
 
-    int len = 0;
-    asETokenClass token = engine->ParseToken(expression.c_str(), 0, &len);
+    PDWrite_event_begin(writer, PDEventType_SetLocals);
+    PDWrite_array_begin(writer, "locals");
 
-    // GW-TODO: If the expression starts with :: we should only look for global variables
-    // GW-TODO: If the expression starts with identifier followed by ::, then use that as namespace
-    if (token == asTC_IDENTIFIER) {
-        std::string name(expression.c_str(), len);
+    if (func) {
+        for (asUINT variable = 0; variable < func->GetVarCount(); ++variable) {
+            if (!context->IsVarInScope(variable, stackLevel))
+                continue;
 
-        // Find the variable
-        void* ptr = nullptr;
-        int typeId = 0;
+            writeVariable(writer, context->GetVarName(variable, stackLevel), context->GetAddressOfVar(variable, stackLevel),
+                          context->GetVarTypeId(variable, stackLevel), engine);
+        }
 
-        asIScriptFunction* func = context->GetFunction();
-        if (!func)
-            return;
+        if (void* thisPointer = context->GetThisPointer(stackLevel))
+            writeVariable(writer, "this", &thisPointer, context->GetThisTypeId(stackLevel) | asTYPEID_OBJHANDLE, engine);
+    }
 
-        // We start from the end, in case the same name is reused in different scopes
-        for (asUINT variable = func->GetVarCount(); variable-- > 0;) {
-            if (context->IsVarInScope(variable) && name == context->GetVarName(variable)) {
-                ptr = context->GetAddressOfVar(variable);
-                typeId = context->GetVarTypeId(variable);
-                break;
-            }
+    PDWrite_array_end(writer);
+
+    PDWrite_array_begin(writer, "globals");
+
+    if (asIScriptModule* mod = func ? func->GetModule() : nullptr) {
+        for (asUINT n = 0; n < mod->GetGlobalVarCount(); n++) {
+            const char* name = nullptr;
+            int typeId = 0;
+            mod->GetGlobalVar(n, &name, 0, &typeId);
+            writeVariable(writer, name, mod->GetAddressOfGlobalVar(n), typeId, engine);
         }
+    }
+
+    PDWrite_array_end(writer);
+    PDWrite_event_end(writer);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::writeChildren(asIScriptContext* context, asUINT stackLevel, const char* path, asUINT start, asUINT count,
+                           PDWriter* writer) {
+    asIScriptEngine* engine = context->GetEngine();
+    void* value = nullptr;
+    int typeId = 0;
+
+    PDWrite_event_begin(writer, PDEventType_SetLocals);
+    PDWrite_string(writer, "path", path);
+    PDWrite_array_begin(writer, "locals");
+
+    if (findPath(path, context, stackLevel, &value, &typeId) && (typeId & asTYPEID_MASK_OBJECT)) {
+        if (typeId & asTYPEID_OBJHANDLE)
+            value = *(void**)value;
 
-        // Look for class members, if we're in a class method
-        if (!ptr && func->GetObjectType()) {
-            if (name == "this") {
-                ptr = context->GetThisPointer();
-                typeId = context->GetThisTypeId();
+        asIObjectType* type = engine->GetObjectTypeById(typeId);
+        asUINT total = childCount(value, typeId, engine);
+        asUINT end = count < total - start ? start + count : total;
+
+        if (value && start < total) {
+            if (typeId & asTYPEID_SCRIPTOBJECT) {
+                asIScriptObject* obj = (asIScriptObject*)value;
+
+                for (asUINT prop = start; prop < end; ++prop)
+                    writeVariable(writer, obj->GetPropertyName(prop), obj->GetAddressOfProperty(prop), obj->GetPropertyTypeId(prop), engine);
+            }else if (const ContainerFuncs* funcs = findContainerFuncs(type, engine)) {
+                char name[32];
+
+                for (asUINT index = start; index < end; ++index) {
+                    int elementTypeId = 0;
+                    void* element = funcs->element(value, index, &elementTypeId);
+
+                    sprintf(name, "[%u]", index);
+                    writeVariable(writer, name, element, elementTypeId, engine);
+                }
             }else {
-                asIObjectType* type = engine->GetObjectTypeById(context->GetThisTypeId());
-                for (asUINT prop = 0; prop < type->GetPropertyCount(); ++prop) {
+                for (asUINT prop = start; prop < end; ++prop) {
                     const char* propName = nullptr;
+                    int propTypeId = 0;
                     int offset = 0;
                     bool isReference = false;
 
-                    type->GetProperty(prop, &propName, &typeId, 0, &offset, &isReference);
-                    if (name == propName) {
-                        ptr = (void*)(((asBYTE*)context->GetThisPointer()) + offset);
-                        if (isReference)
-                            ptr = *(void**)ptr;
-                        break;
-                    }
+                    type->GetProperty(prop, &propName, &propTypeId, 0, &offset, &isReference);
+
+                    void* ptr = (void*)(((asBYTE*)value) + offset);
+                    if (isReference)
+                        ptr = *(void**)ptr;
+
+                    writeVariable(writer, propName, ptr, propTypeId, engine);
                 }
             }
         }
+    }
+
+    PDWrite_array_end(writer);
+    PDWrite_event_end(writer);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::writeVariable(PDWriter* writer, const char* name, void* value, int typeId, asIScriptEngine* engine) {
+    PDWrite_array_entry_begin(writer);
+    PDWrite_string(writer, "name", name ? name : "");
+
+    if (const char* decl = engine->GetTypeDeclaration(typeId))
+        PDWrite_string(writer, "type", decl);
+
+    if (value == nullptr) {
+        PDWrite_array_entry_end(writer);
+        return;
+    }
 
-        // Look for global variables
-        if (!ptr) {
-            if (asIScriptModule* mod = func->GetModule()) {
-                for (asUINT variable = 0; variable < mod->GetGlobalVarCount(); ++variable) {
-                    // GW-TODO: Handle namespace too
-                    const char* varName = nullptr, *nameSpace = nullptr;
-                    mod->GetGlobalVar(variable, &varName, &nameSpace, &typeId);
-                    if (name == varName) {
-                        ptr = mod->GetAddressOfGlobalVar(variable);
+    switch (typeId) {
+        case asTYPEID_VOID:
+            break;
+        case asTYPEID_BOOL:
+            PDWrite_u8(writer, "value", *(bool*)value ? 1 : 0);
+            break;
+        case asTYPEID_INT8:
+            PDWrite_s8(writer, "value", *(int8_t*)value);
+            break;
+        case asTYPEID_INT16:
+            PDWrite_s16(writer, "value", *(int16_t*)value);
+            break;
+        case asTYPEID_INT32:
+            PDWrite_s32(writer, "value", *(int32_t*)value);
+            break;
+        case asTYPEID_INT64:
+            PDWrite_s64(writer, "value", *(int64_t*)value);
+            break;
+        case asTYPEID_UINT8:
+            PDWrite_u8(writer, "value", *(uint8_t*)value);
+            break;
+        case asTYPEID_UINT16:
+            PDWrite_u16(writer, "value", *(uint16_t*)value);
+            break;
+        case asTYPEID_UINT32:
+            PDWrite_u32(writer, "value", *(uint32_t*)value);
+            break;
+        case asTYPEID_UINT64:
+            PDWrite_u64(writer, "value", *(uint64_t*)value);
+            break;
+        case asTYPEID_FLOAT:
+            PDWrite_float(writer, "value", *(float*)value);
+            break;
+        case asTYPEID_DOUBLE:
+            PDWrite_double(writer, "value", *(double*)value);
+            break;
+
+        default:
+        {
+            if ((typeId & asTYPEID_MASK_OBJECT) == 0) {
+                // The type is an enum
+                int enumValue = *(int*)value;
+                PDWrite_s32(writer, "value", enumValue);
+
+                for (int enumIndex = engine->GetEnumValueCount(typeId); enumIndex-- > 0;) {
+                    int enumVal;
+                    const char* enumName = engine->GetEnumValueByIndex(typeId, enumIndex, &enumVal);
+                    if (enumVal == enumValue) {
+                        PDWrite_string(writer, "enum", enumName);
                         break;
                     }
                 }
+
+                break;
+            }
+
+            // Dereference handles, so we can see what it points to
+            if (typeId & asTYPEID_OBJHANDLE)
+                value = *(void**)value;
+
+            PDWrite_u64(writer, "address", (uint64_t)(uintptr_t)value);
+
+            if (!value)
+                break;
+
+            // Registered to-string callbacks are used as the value, members are left for the UI to ask for
+            if (!(typeId & asTYPEID_SCRIPTOBJECT)) {
+                asIObjectType* type = engine->GetObjectTypeById(typeId);
+                std::map<const asIObjectType*, ToStringFunc>::iterator it = m_toStringCallbacks.find(type);
+
+                if (it == m_toStringCallbacks.end() && (type->GetFlags() & asOBJ_TEMPLATE))
+                    it = m_toStringCallbacks.find(engine->GetObjectTypeByName(type->GetName()));
+
+                if (it != m_toStringCallbacks.end())
+                    PDWrite_string(writer, "value", it->second(value, false, this).c_str());
             }
+
+            PDWrite_u32(writer, "children", childCount(value, typeId & ~asTYPEID_OBJHANDLE, engine));
+            break;
         }
+    }
 
-        if (ptr) {
-            // GW-TODO: If there is a . after the identifier, check for members
+    PDWrite_array_entry_end(writer);
+}
 
-            std::stringstream s;
-            s << toString(ptr, typeId, true, engine) << std::endl;
-            output(s.str());
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const Engine::ContainerFuncs* Engine::findContainerFuncs(asIObjectType* type, asIScriptEngine* engine) const {
+    std::map<const asIObjectType*, ContainerFuncs>::const_iterator it = m_containerCallbacks.find(type);
+
+    // Template instances can use the callbacks for the generic template type
+    if (it == m_containerCallbacks.end() && (type->GetFlags() & asOBJ_TEMPLATE))
+        it = m_containerCallbacks.find(engine->GetObjectTypeByName(type->GetName()));
+
+    return it != m_containerCallbacks.end() ? &it->second : nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Number of children of an object (value must already be dereferenced if it's a handle)
+
+asUINT Engine::childCount(void* value, int typeId, asIScriptEngine* engine) const {
+    if (!value || !(typeId & asTYPEID_MASK_OBJECT))
+        return 0;
+
+    if (typeId & asTYPEID_SCRIPTOBJECT)
+        return ((asIScriptObject*)value)->GetPropertyCount();
+
+    asIObjectType* type = engine->GetObjectTypeById(typeId);
+    if (!type)
+        return 0;
+
+    if (const ContainerFuncs* funcs = findContainerFuncs(type, engine))
+        return funcs->count(value);
+
+    return type->GetPropertyCount();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::addWatch(const std::string& expression) {
+    m_watches.push_back(expression);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::writeWatches(asIScriptContext* context, asUINT stackLevel, PDWriter* writer) {
+    PDWrite_event_begin(writer, PDEventType_SetWatch);
+    PDWrite_array_begin(writer, "watches");
+
+    for (size_t i = 0; i < m_watches.size(); ++i) {
+        std::string error;
+
+        if (evaluateWatch(m_watches[i], context, stackLevel, writer, &error))
+            continue;
+
+        PDWrite_array_entry_begin(writer);
+        PDWrite_string(writer, "name", m_watches[i].c_str());
+        PDWrite_string(writer, "error", error.c_str());
+        PDWrite_array_entry_end(writer);
+    }
+
+    PDWrite_array_end(writer);
+    PDWrite_event_end(writer);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string Engine::evaluate(const std::string& expression, asIScriptContext* context, asUINT stackLevel) {
+    std::string result;
+    evaluateWatch(expression, context, stackLevel, nullptr, &result);
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The compiled expression passes its value to this function. It's written directly to the writer (or converted
+// to a string) as temporaries are destroyed when the expression returns
+
+struct WatchOutput {
+    asdbg::Engine* engine;
+    const char* name;
+    PDWriter* writer;
+    std::string* result;
+};
+
+static WatchOutput s_watchOutput;
+
+void Engine::watchResult(asIScriptGeneric* gen) {
+    void* value = gen->GetArgAddress(0);
+    int typeId = gen->GetArgTypeId(0);
+    Engine* engine = s_watchOutput.engine;
+
+    if (s_watchOutput.writer)
+        engine->writeVariable(s_watchOutput.writer, s_watchOutput.name, value, typeId, gen->GetEngine());
+    else
+        *s_watchOutput.result = engine->toString(value, typeId, true, gen->GetEngine());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string nextToken(asIScriptEngine* engine, const char* p, size_t left) {
+    while (left > 0) {
+        int len = 0;
+        asETokenClass token = engine->ParseToken(p, left, &len);
+        if (len <= 0)
+            break;
+
+        if (token != asTC_WHITESPACE && token != asTC_COMMENT)
+            return std::string(p, len);
+
+        p += len;
+        left -= len;
+    }
+
+    return std::string();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Engine::Watch* Engine::compileWatch(const std::string& expression, asIScriptContext* context, asUINT stackLevel,
+                                    const std::vector<bool>& scope) {
+    asIScriptEngine* engine = context->GetEngine();
+    asIScriptFunction* func = context->GetFunction(stackLevel);
+    Watch& watch = m_watchCache[WatchKey(func, expression)];
+
+    if (watch.func)
+        watch.func->Release();
+
+    watch = Watch();
+    watch.scope = scope;
+
+    // The watch function is registered by attachContext
+    asIScriptModule* mod = func->GetModule();
+    if (!mod || !engine->GetGlobalFunctionByDecl("void __asdbg_watch(?&in)"))
+        return &watch;
+
+    asIObjectType* thisType = nullptr;
+    if (func->GetObjectType())
+        thisType = engine->GetObjectTypeById(context->GetThisTypeId(stackLevel));
+
+    // Locals are passed by name as arguments and the members of this are accessed through __this
+
+    std::string code;
+    std::string prev;
+    const char* p = expression.c_str();
+    size_t left = expression.size();
+
+    while (left > 0) {
+        int len = 0;
+        asETokenClass token = engine->ParseToken(p, left, &len);
+        if (len <= 0)
+            break;
+
+        std::string text(p, len);
+        p += len;
+        left -= len;
+
+        if (token == asTC_WHITESPACE || token == asTC_COMMENT) {
+            code += text;
+            continue;
         }
-    }else {
-        output("Invalid expression. Expected identifier\n");
+
+        if (text == "this" && thisType && prev != ".") {
+            code += "__this";
+            watch.passThis = true;
+        }else if (token == asTC_IDENTIFIER && prev != "." && prev != "::" && nextToken(engine, p, left) != "::") {
+            int local = -1;
+
+            for (asUINT variable = func->GetVarCount(); variable-- > 0;) {
+                if (scope[variable] && text == context->GetVarName(variable, stackLevel)) {
+                    local = (int)variable;
+                    break;
+                }
+            }
+
+            if (local >= 0) {
+                bool found = false;
+                for (size_t i = 0; i < watch.variables.size(); ++i)
+                    found |= watch.variables[i] == local;
+
+                if (!found) {
+                    watch.variables.push_back(local);
+                    watch.typeIds.push_back(context->GetVarTypeId(local, stackLevel));
+                }
+
+                code += text;
+            }else if (thisType && isMember(thisType, text.c_str())) {
+                code += "__this." + text;
+                watch.passThis = true;
+            }else {
+                code += text;
+            }
+        }else {
+            code += text;
+        }
+
+        prev = text;
+    }
+
+    std::string params;
+
+    for (size_t i = 0; i < watch.variables.size(); ++i) {
+        int typeId = watch.typeIds[i];
+
+        if (i > 0)
+            params += ", ";
+
+        if (typeId & asTYPEID_OBJHANDLE)
+            params += std::string(engine->GetTypeDeclaration(typeId, true)) + " ";
+        else
+            params += std::string("const ") + engine->GetTypeDeclaration(typeId, true) + " &in ";
+
+        params += context->GetVarName(watch.variables[i], stackLevel);
+    }
+
+    if (watch.passThis) {
+        if (!params.empty())
+            params += ", ";
+
+        params += std::string(engine->GetTypeDeclaration(thisType->GetTypeId(), true)) + "@ __this";
+    }
+
+    std::string source = "void __asdbg_watch_expr(" + params + ") { __asdbg_watch(" + code + "); }";
+
+    asIScriptFunction* compiled = nullptr;
+    if (mod->CompileFunction("watch", source.c_str(), 0, 0, &compiled) >= 0)
+        watch.func = compiled;
+
+    return &watch;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Engine::evaluateWatch(const std::string& expression, asIScriptContext* context, asUINT stackLevel, PDWriter* writer,
+                           std::string* result) {
+    asIScriptFunction* func = context->GetFunction(stackLevel);
+    if (!func || func->GetFuncType() != asFUNC_SCRIPT) {
+        *result = "<no script function>";
+        return false;
+    }
+
+    std::vector<bool> scope(func->GetVarCount());
+    for (asUINT variable = 0; variable < scope.size(); ++variable)
+        scope[variable] = context->IsVarInScope(variable, stackLevel);
+
+    std::map<WatchKey, Watch>::iterator it = m_watchCache.find(WatchKey(func, expression));
+    Watch* watch = it != m_watchCache.end() && it->second.scope == scope ? &it->second : compileWatch(expression, context, stackLevel, scope);
+
+    if (!watch->func) {
+        *result = "<invalid expression>";
+        return false;
+    }
+
+    // The arguments has to be fetched before the state is pushed
+
+    std::vector<void*> args(watch->variables.size());
+    for (size_t i = 0; i < args.size(); ++i)
+        args[i] = context->GetAddressOfVar(watch->variables[i], stackLevel);
+
+    void* thisPointer = watch->passThis ? context->GetThisPointer(stackLevel) : nullptr;
+
+    if (context->PushState() < 0) {
+        *result = "<unable to evaluate>";
+        return false;
+    }
+
+    WatchOutput output = { this, expression.c_str(), writer, result };
+    s_watchOutput = output;
+    m_evaluating = true;
+
+    int r = context->Prepare(watch->func);
+
+    if (r < 0) {
+        std::stringstream s;
+        s << "<unable to prepare expression (" << r << ")>";
+        *result = s.str();
+
+        m_evaluating = false;
+        context->PopState();
+
+        return false;
     }
+
+    for (asUINT i = 0; i < args.size(); ++i) {
+        if (watch->typeIds[i] & asTYPEID_OBJHANDLE)
+            context->SetArgObject(i, *(void**)args[i]);
+        else
+            context->SetArgAddress(i, args[i]);
+    }
+
+    if (watch->passThis)
+        context->SetArgObject((asUINT)args.size(), thisPointer);
+
+    bool ok = true;
+
+    if (context->Execute() != asEXECUTION_FINISHED) {
+        const char* exception = context->GetExceptionString();
+        *result = std::string("<exception: ") + (exception ? exception : "unknown") + ">";
+        ok = false;
+    }
+
+    m_evaluating = false;
+    context->PopState();
+
+    return ok;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -460,9 +1227,218 @@ bool Engine::interpretCommand(const std::string& command, asIScriptContext* cont
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Engine::checkBreakPoint(asIScriptContext* context) {
+    if (context == nullptr)
+        return false;
+
+    asIScriptFunction* func = context->GetFunction();
+
+    if (func != m_checkedFunction) {
+        std::unordered_map<const asIScriptFunction*, FunctionInfo>::const_iterator it = m_functions.find(func);
+        m_checkedFunction = func;
+        m_checkedInfo = it != m_functions.end() ? &it->second : nullptr;
+    }
+
+    if (!m_checkedInfo || !m_checkedInfo->hasBreakpoints)
+        return false;
+
+    int line = context->GetLineNumber(0, 0, 0);
+
+    if (line == m_checkedInfo->entryLine)
+        return true;
+
+    return m_lineBreakpoints.find(lineKey(m_checkedInfo->section, line)) != m_lineBreakpoints.end();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Engine::findVariable(const std::string& name, asIScriptContext* context, asUINT stackLevel, void** value, int* typeId) {
+    asIScriptEngine* engine = context->GetEngine();
+    asIScriptFunction* func = context->GetFunction(stackLevel);
+    if (!func)
+        return false;
+
+    // We start from the end, in case the same name is reused in different scopes
+    for (asUINT variable = func->GetVarCount(); variable-- > 0;) {
+        if (context->IsVarInScope(variable, stackLevel) && name == context->GetVarName(variable, stackLevel)) {
+            *value = context->GetAddressOfVar(variable, stackLevel);
+            *typeId = context->GetVarTypeId(variable, stackLevel);
+            return true;
+        }
+    }
+
+    // Look for class members, if we're in a class method
+    if (func->GetObjectType()) {
+        if (name == "this") {
+            *value = context->GetThisPointer(stackLevel);
+            *typeId = context->GetThisTypeId(stackLevel);
+            return true;
+        }
+
+        asIObjectType* type = engine->GetObjectTypeById(context->GetThisTypeId(stackLevel));
+        for (asUINT prop = 0; prop < type->GetPropertyCount(); ++prop) {
+            const char* propName = nullptr;
+            int offset = 0;
+            bool isReference = false;
+
+            type->GetProperty(prop, &propName, typeId, 0, &offset, &isReference);
+            if (name == propName) {
+                *value = (void*)(((asBYTE*)context->GetThisPointer(stackLevel)) + offset);
+                if (isReference)
+                    *value = *(void**)*value;
+                return true;
+            }
+        }
+    }
+
+    // Look for global variables
+    if (asIScriptModule* mod = func->GetModule()) {
+        for (asUINT variable = 0; variable < mod->GetGlobalVarCount(); ++variable) {
+            // GW-TODO: Handle namespace too
+            const char* varName = nullptr, *nameSpace = nullptr;
+            mod->GetGlobalVar(variable, &varName, &nameSpace, typeId);
+            if (name == varName) {
+                *value = mod->GetAddressOfGlobalVar(variable);
+                return true;
+            }
+        }
+    }
+
     return false;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Resolves paths like "player.inventory[3].name" where the first part is found with findVariable
+
+bool Engine::findPath(const char* path, asIScriptContext* context, asUINT stackLevel, void** value, int* typeId) {
+    asIScriptEngine* engine = context->GetEngine();
+    const char* p = path;
+
+    size_t len = strcspn(p, ".[");
+    if (!findVariable(std::string(p, len), context, stackLevel, value, typeId))
+        return false;
+
+    p += len;
+
+    while (*p) {
+        if (!(*typeId & asTYPEID_MASK_OBJECT))
+            return false;
+
+        void* object = *value;
+        if (*typeId & asTYPEID_OBJHANDLE)
+            object = *(void**)object;
+
+        if (!object)
+            return false;
+
+        int objectTypeId = *typeId & ~asTYPEID_OBJHANDLE;
+        asIObjectType* type = engine->GetObjectTypeById(objectTypeId);
+
+        if (*p == '[') {
+            const ContainerFuncs* funcs = findContainerFuncs(type, engine);
+            char* end = nullptr;
+            unsigned long index = strtoul(p + 1, &end, 10);
+
+            if (!funcs || *end != ']' || index >= funcs->count(object))
+                return false;
+
+            *value = funcs->element(object, (asUINT)index, typeId);
+            p = end + 1;
+            continue;
+        }
+
+        // Member access
+        p++;
+        len = strcspn(p, ".[");
+        std::string name(p, len);
+        p += len;
+
+        bool found = false;
+
+        if (objectTypeId & asTYPEID_SCRIPTOBJECT) {
+            asIScriptObject* obj = (asIScriptObject*)object;
+
+            for (asUINT prop = 0; prop < obj->GetPropertyCount() && !found; ++prop) {
+                if (name == obj->GetPropertyName(prop)) {
+                    *value = obj->GetAddressOfProperty(prop);
+                    *typeId = obj->GetPropertyTypeId(prop);
+                    found = true;
+                }
+            }
+        }else {
+            for (asUINT prop = 0; prop < type->GetPropertyCount() && !found; ++prop) {
+                const char* propName = nullptr;
+                int propTypeId = 0;
+                int offset = 0;
+                bool isReference = false;
+
+                type->GetProperty(prop, &propName, &propTypeId, 0, &offset, &isReference);
+                if (name == propName) {
+                    *value = (void*)(((asBYTE*)object) + offset);
+                    if (isReference)
+                        *value = *(void**)*value;
+                    *typeId = propTypeId;
+                    found = true;
+                }
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Engine::installBreakpoint(size_t index, const std::vector<asIScriptFunction*>& functions) {
+    Breakpoint& breakpoint = m_breakpoints[index];
+
+    for (size_t i = 0; i < functions.size(); ++i) {
+        asIScriptFunction* func = functions[i];
+        std::unordered_map<const asIScriptFunction*, FunctionInfo>::iterator it = m_functions.find(func);
+        int line;
+
+        // Functions of a module that was rebuilt without being added again
+        if (it == m_functions.end())
+            continue;
+
+        FunctionInfo& info = it->second;
+
+        if (breakpoint.function) {
+            if (breakpoint.name != func->GetName())
+                continue;
+
+            if ((line = func->SetBreakpoint(0, true)) < 0)
+                continue;
+
+            info.entryLine = line;
+            info.hasBreakpoints = true;
+            continue;
+        }
+
+        if (breakpoint.section != info.section)
+            continue;
+
+        if ((line = func->SetBreakpoint(breakpoint.lineNumber, true)) < 0)
+            continue;
+
+        info.hasBreakpoints = true;
+        m_lineBreakpoints[lineKey(info.section, line)] = index;
+
+        // Move the breakpoint to the line where the code actually is
+        if (breakpoint.needsAdjusting && line != breakpoint.lineNumber) {
+            std::stringstream s;
+            s << "Moving break point in file '" << breakpoint.name << "' to line " << line << std::endl;
+            output(s.str());
+
+            breakpoint.lineNumber = line;
+        }
+
+        breakpoint.needsAdjusting = false;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string Engine::toString(void* value, asUINT typeId, bool expandMembers, asIScriptEngine* engine) {
@@ -5,6 +5,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+
+struct PDReader;
+struct PDWriter;
 
 namespace asdbg {
 
@@ -14,6 +18,12 @@ public:
     typedef std::string (*ToStringFunc)(void* object, bool expandMembers, Engine* engine);
     void registerToStringFunc(const asIObjectType* type, ToStringFunc callback);
 
+    // Register callbacks that gives access to the elements of application container types (arrays etc) so they
+    // can be expanded in the debugger one range at a time
+    typedef asUINT (*ElementCountFunc)(void* object);
+    typedef void* (*ElementFunc)(void* object, asUINT index, int* typeId);
+    void registerContainerFuncs(const asIObjectType* type, ElementCountFunc countFunc, ElementFunc elementFunc);
+
 public:
     Engine();
     ~Engine();
@@ -25,8 +35,18 @@ public:
     void takeCommands(asIScriptContext* context);
     void output(const std::string& text);
 
-    // Line callback invoked by context
+    // Breakpoints are patched into the bytecode of the functions in the added modules so the context only calls
+    // back when one is hit. The line callback is only installed while stepping. A module has to be removed before it's
+    // discarded and added again after it has been rebuilt so the new functions get their breakpoints
+    void addModule(asIScriptModule* module);
+    void removeModule(asIScriptModule* module);
+
+    // Sets the breakpoint callback and registers the function used by watch expressions (once per engine)
+    void attachContext(asIScriptContext* context);
+
+    // Callbacks invoked by context
     void lineCallback(asIScriptContext* context);
+    void breakpointCallback(asIScriptContext* context);
 
     // Commands
     void addFileBreakpoint(const std::string& file, int line);
@@ -41,9 +61,23 @@ public:
     void printCallstack(asIScriptContext* context);
     void printValue(const std::string& expression, asIScriptContext* context);
 
+    // Events sent to ProDBG. Values are written with their native types and objects only report their number of
+    // children. The children are written when the UI asks for them with a path (like "a.b[10]") and range
+    void writeCallstack(asIScriptContext* context, PDWriter* writer);
+    void writeLocals(asIScriptContext* context, asUINT stackLevel, PDWriter* writer);
+    void writeChildren(asIScriptContext* context, asUINT stackLevel, const char* path, asUINT start, asUINT count, PDWriter* writer);
+
+    // Watch expressions are compiled once per (function, expression) into a function in the module of the stopped
+    // function that gets the referenced locals (and this) as arguments. It's executed in a nested context state
+    void addWatch(const std::string& expression);
+    void writeWatches(asIScriptContext* context, asUINT stackLevel, PDWriter* writer);
+    std::string evaluate(const std::string& expression, asIScriptContext* context, asUINT stackLevel);
+
     // Helpers
     bool interpretCommand(const std::string& command, asIScriptContext* context);
     bool checkBreakPoint(asIScriptContext* context);
+    bool findVariable(const std::string& name, asIScriptContext* context, asUINT stackLevel, void** value, int* typeId);
+    bool findPath(const char* path, asIScriptContext* context, asUINT stackLevel, void** value, int* typeId);
 
     std::string toString(void* value, asUINT typeId, bool expandMembers, asIScriptEngine* engine);
 
@@ -56,27 +90,83 @@ protected:
     };
 
     struct Breakpoint {
-        Breakpoint(const std::string& file, int line, bool func)
+        Breakpoint(const std::string& file, int section, int line, bool func)
             : name(file)
+            , section(section)
             , lineNumber(line)
             , function(func)
             , needsAdjusting(true) {
         }
 
         std::string name;
+        int section;    /// interned file name (-1 for function breakpoints)
         int lineNumber;
         bool function;
         bool needsAdjusting;
     };
 
+    // Debug info for each script function in the added modules
+    struct FunctionInfo {
+        asIScriptModule* module;
+        int section;            /// interned file name of the script section
+        int entryLine;          /// line of a function breakpoint or -1
+        bool hasBreakpoints;    /// set if any breakpoint has been installed in the function
+    };
+
+    struct ContainerFuncs {
+        ElementCountFunc count;
+        ElementFunc element;
+    };
+
+    struct Watch {
+        Watch()
+            : func(nullptr)
+            , passThis(false) {
+        }
+
+        asIScriptFunction* func;        /// compiled expression (null if it didn't compile)
+        std::vector<int> variables;     /// locals passed as arguments
+        std::vector<int> typeIds;       /// type of each passed local
+        std::vector<bool> scope;        /// variables in scope when compiled (names can resolve differently otherwise)
+        bool passThis;
+    };
+
+    typedef std::pair<const asIScriptFunction*, std::string> WatchKey;
+
+    Watch* compileWatch(const std::string& expression, asIScriptContext* context, asUINT stackLevel, const std::vector<bool>& scope);
+    bool evaluateWatch(const std::string& expression, asIScriptContext* context, asUINT stackLevel, PDWriter* writer, std::string* result);
+    static void watchResult(asIScriptGeneric* gen);
+
+    const ContainerFuncs* findContainerFuncs(asIObjectType* type, asIScriptEngine* engine) const;
+    asUINT childCount(void* value, int typeId, asIScriptEngine* engine) const;
+    void writeVariable(PDWriter* writer, const char* name, void* value, int typeId, asIScriptEngine* engine);
+
+    int internSection(const std::string& file);
+    void forgetFunctions(asIScriptModule* module);
+    void installBreakpoint(size_t index, const std::vector<asIScriptFunction*>& functions);
+
 protected:
     DebugAction m_debugAction;
     asUINT m_lastCommandAtStackLevel;
     asIScriptFunction* m_lastFunction;
     std::vector<Breakpoint> m_breakpoints;
+    std::vector<asIScriptModule*> m_modules;
+
+    // Breakpoint lookup. Line breakpoints are keyed on (section, line) and the function info is cached for the
+    // last function checked so the common case (no breakpoints in the function) is a pointer compare
+    std::unordered_map<std::string, int> m_sections;
+    std::unordered_map<asQWORD, size_t> m_lineBreakpoints;
+    std::unordered_map<const asIScriptFunction*, FunctionInfo> m_functions;
+    const asIScriptFunction* m_checkedFunction;
+    const FunctionInfo* m_checkedInfo;
 
     // Registered callbacks for converting objects to strings
     std::map<const asIObjectType*, ToStringFunc> m_toStringCallbacks;
+    std::map<const asIObjectType*, ContainerFuncs> m_containerCallbacks;
+
+    std::vector<std::string> m_watches;
+    std::map<WatchKey, Watch> m_watchCache;
+    bool m_evaluating;
 
     bool m_connected;
 };
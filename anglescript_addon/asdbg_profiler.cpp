@@ -0,0 +1,279 @@
+#include "asdbg_profiler.h"
+
+#include <pd_backend.h>
+#include <pd_readwrite.h>
+
+#include <chrono>
+#include <sstream>   // stringstream
+
+namespace asdbg {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string functionName(const asIScriptFunction* func) {
+    std::string name;
+
+    if (const asIObjectType* type = func->GetObjectType()) {
+        name = type->GetName();
+        name += "::";
+    }
+
+    return name + func->GetName();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Profiler::Profiler()
+    : m_readIndex(0)
+    , m_writeIndex(0)
+    , m_dropped(0)
+    , m_context(nullptr)
+    , m_requested(nullptr)
+    , m_stale(nullptr)
+    , m_running(false)
+    , m_interval(1000)
+    , m_totalSamples(0) {
+}
+
+Profiler::~Profiler() {
+    stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Profiler::start(unsigned intervalUs) {
+    if (m_running)
+        return;
+
+    m_interval = intervalUs ? intervalUs : 1;
+    m_running = true;
+    m_thread = std::thread(&Profiler::timerThread, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Profiler::stop() {
+    if (!m_running)
+        return;
+
+    m_running = false;
+    m_thread.join();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Profiler::timerThread() {
+    while (m_running) {
+        std::this_thread::sleep_for(std::chrono::microseconds(m_interval));
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        // A pending request for another context belongs to an outer context that is waiting for a nested call
+        if (m_context && (!m_requested || m_requested == m_context) && m_context->GetState() == asEXECUTION_ACTIVE) {
+            m_requested = m_context;
+            m_context->Suspend();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Profiler::takeRequest(asIScriptContext* context) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if (m_requested != context)
+        return false;
+
+    m_requested = nullptr;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Profiler::execute(asIScriptContext* context) {
+    asIScriptContext* previous;
+    bool stale;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        previous = m_context;
+        m_context = context;
+        stale = m_stale == context;
+
+        if (stale)
+            m_stale = nullptr;
+    }
+
+    int r;
+
+    while ((r = context->Execute()) == asEXECUTION_SUSPENDED) {
+        if (takeRequest(context))
+            recordSample(context);
+        else if (!stale)
+            break;
+
+        // The first suspend of a resumed context may come from a request that arrived after it last returned
+        stale = false;
+    }
+
+    // Once unpublished the timer won't touch the context again. A request that wasn't handled has left the suspend
+    // flag set in the context. Prepare clears it, but resuming a suspended context would stop at once
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_context = previous;
+
+    if (m_requested == context) {
+        m_requested = nullptr;
+
+        if (r == asEXECUTION_SUSPENDED)
+            m_stale = context;
+    }
+
+    return r;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Profiler::recordSample(asIScriptContext* context) {
+    uint32_t write = m_writeIndex.load(std::memory_order_relaxed);
+
+    if (write - m_readIndex.load(std::memory_order_acquire) >= BufferSize) {
+        m_dropped++;
+        return;
+    }
+
+    Sample& sample = m_samples[write % BufferSize];
+    asUINT size = context->GetCallstackSize();
+    asUINT depth = 0;
+
+    for (asUINT level = 0; level < size && depth < MaxDepth; ++level) {
+        asIScriptFunction* func = context->GetFunction(level);
+
+        // Nested states has a marker entry without a function
+        if (!func)
+            continue;
+
+        sample.frames[depth].function = func;
+        sample.frames[depth].line = context->GetLineNumber(level);
+        depth++;
+    }
+
+    sample.depth = depth;
+
+    m_writeIndex.store(write + 1, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Profiler::aggregate() {
+    uint32_t read = m_readIndex.load(std::memory_order_relaxed);
+    uint32_t write = m_writeIndex.load(std::memory_order_acquire);
+
+    for (; read != write; ++read) {
+        const Sample& sample = m_samples[read % BufferSize];
+
+        if (sample.depth == 0)
+            continue;
+
+        m_totalSamples++;
+
+        m_functions[sample.frames[0].function].self++;
+        m_lines[LineKey(sample.frames[0].function, sample.frames[0].line)].self++;
+
+        // Recursive functions should only count once in the total
+
+        std::string folded;
+
+        for (asUINT i = sample.depth; i-- > 0;) {
+            const Frame& frame = sample.frames[i];
+            bool seenFunction = false;
+            bool seenLine = false;
+
+            for (asUINT j = i + 1; j < sample.depth; ++j) {
+                seenFunction |= sample.frames[j].function == frame.function;
+                seenLine |= sample.frames[j].function == frame.function && sample.frames[j].line == frame.line;
+            }
+
+            if (!seenFunction)
+                m_functions[frame.function].total++;
+
+            if (!seenLine)
+                m_lines[LineKey(frame.function, frame.line)].total++;
+
+            if (!folded.empty())
+                folded += ";";
+
+            folded += functionName(frame.function);
+        }
+
+        m_folded[folded]++;
+    }
+
+    m_readIndex.store(read, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Profiler::reset() {
+    aggregate();
+
+    m_functions.clear();
+    m_lines.clear();
+    m_folded.clear();
+    m_totalSamples = 0;
+    m_dropped = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string Profiler::foldedStacks() const {
+    std::stringstream s;
+
+    for (std::map<std::string, uint64_t>::const_iterator it = m_folded.begin(); it != m_folded.end(); ++it)
+        s << it->first << " " << it->second << std::endl;
+
+    return s.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Times are in micro seconds (number of samples times the interval)
+
+void Profiler::writeEvent(PDWriter* writer) const {
+    PDWrite_event_begin(writer, ProfilerEventType_SetProfile);
+    PDWrite_u32(writer, "interval", m_interval);
+    PDWrite_u64(writer, "samples", m_totalSamples);
+    PDWrite_u64(writer, "dropped", m_dropped);
+
+    PDWrite_array_begin(writer, "functions");
+
+    for (std::map<const asIScriptFunction*, Counts>::const_iterator it = m_functions.begin(); it != m_functions.end(); ++it) {
+        const char* section = it->first->GetScriptSectionName();
+
+        PDWrite_array_entry_begin(writer);
+        PDWrite_string(writer, "name", functionName(it->first).c_str());
+        PDWrite_string(writer, "filename", section ? section : "");
+        PDWrite_u64(writer, "self", it->second.self * m_interval);
+        PDWrite_u64(writer, "total", it->second.total * m_interval);
+        PDWrite_array_entry_end(writer);
+    }
+
+    PDWrite_array_end(writer);
+
+    PDWrite_array_begin(writer, "lines");
+
+    for (std::map<LineKey, Counts>::const_iterator it = m_lines.begin(); it != m_lines.end(); ++it) {
+        const char* section = it->first.first->GetScriptSectionName();
+
+        PDWrite_array_entry_begin(writer);
+        PDWrite_string(writer, "name", functionName(it->first.first).c_str());
+        PDWrite_string(writer, "filename", section ? section : "");
+        PDWrite_u32(writer, "line", (uint32_t)it->first.second);
+        PDWrite_u64(writer, "self", it->second.self * m_interval);
+        PDWrite_u64(writer, "total", it->second.total * m_interval);
+        PDWrite_array_entry_end(writer);
+    }
+
+    PDWrite_array_end(writer);
+    PDWrite_event_end(writer);
+}
+
+}
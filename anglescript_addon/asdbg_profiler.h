@@ -0,0 +1,108 @@
+#pragma once
+
+#include <angelscript.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <stdint.h>
+
+struct PDWriter;
+
+namespace asdbg {
+
+// Custom ProDBG event with the aggregated profile (PDEventType_Custom + 1)
+enum {
+    ProfilerEventType_SetProfile = 0x1001,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sampling profiler for script contexts
+//
+// A timer thread calls asIScriptContext::Suspend on the context that is currently running inside Profiler::execute.
+// The suspend is handled in execute by recording the callstack into a ring buffer and resuming the context directly,
+// so there is no cost between samples (no line callback). Samples are taken at the next line/loop suspend point.
+// The ring buffer is single producer (the script thread) and single consumer (aggregate) and doesn't lock.
+//
+// The timer only suspends the context while it is published by execute (under m_lock), so the context only needs to
+// stay alive during the call. A request that lands after Execute has returned is remembered and the next resume of
+// that context through execute skips the suspend it causes. Suspend calls made by the application at the same time as
+// a sample request are treated as the sample.
+
+class Profiler {
+public:
+    Profiler();
+    ~Profiler();
+
+    void start(unsigned intervalUs = 1000);
+    void stop();
+
+    // Use instead of asIScriptContext::Execute for contexts that should be profiled
+    int execute(asIScriptContext* context);
+
+    // Moves samples from the ring buffer into the aggregated results. Can be called from another thread but needs to
+    // be called at least every BufferSize samples (about once a second at 1 kHz) or samples will be dropped
+    void aggregate();
+    void reset();
+
+    // Results (call aggregate first). Folded stacks has one "outer;inner count" line per unique callstack
+    std::string foldedStacks() const;
+    void writeEvent(PDWriter* writer) const;
+
+    uint64_t sampleCount() const { return m_totalSamples; }
+    uint64_t droppedCount() const { return m_dropped; }
+
+    enum {
+        MaxDepth = 32,
+        BufferSize = 1024,
+    };
+
+protected:
+    struct Frame {
+        asIScriptFunction* function;
+        int line;
+    };
+
+    struct Sample {
+        asUINT depth;
+        Frame frames[MaxDepth];     /// frames[0] is the innermost function
+    };
+
+    struct Counts {
+        Counts()
+            : self(0)
+            , total(0) {
+        }
+
+        uint64_t self;
+        uint64_t total;
+    };
+
+    typedef std::pair<const asIScriptFunction*, int> LineKey;
+
+    void recordSample(asIScriptContext* context);
+    bool takeRequest(asIScriptContext* context);
+    void timerThread();
+
+    Sample m_samples[BufferSize];
+    std::atomic<uint32_t> m_readIndex;
+    std::atomic<uint32_t> m_writeIndex;
+    std::atomic<uint64_t> m_dropped;
+
+    std::mutex m_lock;                          /// guards m_context, m_requested and the Suspend call
+    asIScriptContext* m_context;                /// context running inside execute (if any)
+    asIScriptContext* m_requested;              /// context with an unhandled sample request (if any)
+    asIScriptContext* m_stale;                  /// context left with a request after execute returned (only compared)
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+    unsigned m_interval;
+
+    std::map<const asIScriptFunction*, Counts> m_functions;
+    std::map<LineKey, Counts> m_lines;
+    std::map<std::string, uint64_t> m_folded;
+    uint64_t m_totalSamples;
+};
+
+}
@@ -0,0 +1,115 @@
+#ifndef PD_CAPSTONE_DISASM_
+#define PD_CAPSTONE_DISASM_
+
+#include "pd_capstone.h"
+#include "pd_readwrite.h"
+#include "pd_backend.h"
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_MSC_VER) && !defined(__cplusplus)
+#define PD_CAPSTONE_INLINE static __inline
+#else
+#define PD_CAPSTONE_INLINE static inline
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helper for backends that disassembles large ranges through the Capstone service.
+//
+// PDCapstoneFuncs::disasm allocates a new cs_insn array for each call. This helper instead keeps one cs_insn
+// (and cs_detail) around and uses disasm_iter so no memory is allocated per instruction. Detail mode is only
+// switched on if the caller asks for operands.
+//
+// Example:
+//
+// PDCapstoneDisasm disasm;
+// PDCapstoneDisasm_init(&disasm, capstoneFuncs, handle, false);
+// PDCapstoneDisasm_writeEvent(&disasm, writer, code, codeSize, address, instructionCount);
+
+typedef struct PDCapstoneDisasm {
+	PDCapstoneFuncs* funcs;
+	csh handle;
+	cs_insn insn;
+	cs_detail detail;
+} PDCapstoneDisasm;
+
+// Called for each instruction by PDCapstoneDisasm_iterate. insn->detail is only valid if init was called with
+// needsOperands. Return false to stop
+
+typedef bool (*PDCapstoneInsnFunc)(const cs_insn* insn, void* userData);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PD_CAPSTONE_INLINE void PDCapstoneDisasm_init(PDCapstoneDisasm* disasm, PDCapstoneFuncs* funcs, csh handle, bool needsOperands) {
+	disasm->funcs = funcs;
+	disasm->handle = handle;
+	disasm->insn.detail = needsOperands ? &disasm->detail : 0;
+
+	funcs->option(handle, CS_OPT_DETAIL, needsOperands ? CS_OPT_ON : CS_OPT_OFF);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembles up to count instructions (or until the code runs out/invalid instruction). Returns number of
+// instructions disassembled
+
+PD_CAPSTONE_INLINE int PDCapstoneDisasm_iterate(PDCapstoneDisasm* disasm, const uint8_t* code, size_t size,
+												uint64_t address, int count, PDCapstoneInsnFunc func, void* userData) {
+	int i;
+
+	for (i = 0; i < count; ++i) {
+		if (!disasm->funcs->disasm_iter(disasm->handle, &code, &size, &address, &disasm->insn))
+			break;
+
+		if (!func(&disasm->insn, userData))
+			return i + 1;
+	}
+
+	return i;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PD_CAPSTONE_INLINE bool PDCapstoneDisasm_writeEntry(const cs_insn* insn, void* userData) {
+	PDWriter* writer = (PDWriter*)userData;
+	char line[CS_MNEMONIC_SIZE + sizeof(insn->op_str) + 2];
+
+	if (insn->op_str[0])
+		sprintf(line, "%s %s", insn->mnemonic, insn->op_str);
+	else
+		sprintf(line, "%s", insn->mnemonic);
+
+	PDWrite_array_entry_begin(writer);
+	PDWrite_u32(writer, "address", (uint32_t)insn->address);
+	PDWrite_string(writer, "line", line);
+	PDWrite_array_entry_end(writer);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Writes a full PDEventType_SetDisassembly event. Returns number of instructions written
+
+PD_CAPSTONE_INLINE int PDCapstoneDisasm_writeEvent(PDCapstoneDisasm* disasm, PDWriter* writer, const uint8_t* code,
+												   size_t size, uint64_t address, int count) {
+	int written;
+
+	PDWrite_event_begin(writer, PDEventType_SetDisassembly);
+	PDWrite_array_begin(writer, "disassembly");
+
+	written = PDCapstoneDisasm_iterate(disasm, code, size, address, count, PDCapstoneDisasm_writeEntry, writer);
+
+	PDWrite_array_end(writer);
+	PDWrite_event_end(writer);
+
+	return written;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
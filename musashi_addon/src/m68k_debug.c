@@ -4,6 +4,7 @@
 #include "m68kcpu.h"
 #include "m68k_log.h"
 #include "m68k_elf_loader.h"
+#include "m68k_savestate.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -146,16 +147,21 @@ unsigned int m68k_read_memory_32(unsigned int address)
 
 void m68k_write_memory_8(unsigned int address, unsigned int value)
 {
+	M68K_SAVESTATE_MARK_DIRTY(address);
 	WRITE_BYTE(g_68kmem, address, value);
 }
 
 void m68k_write_memory_16(unsigned int address, unsigned int value)
 {
+	M68K_SAVESTATE_MARK_DIRTY(address);
+	M68K_SAVESTATE_MARK_DIRTY(address + 1);
 	WRITE_WORD(g_68kmem, address, value);
 }
 
 void m68k_write_memory_32(unsigned int address, unsigned int value)
 {
+	M68K_SAVESTATE_MARK_DIRTY(address);
+	M68K_SAVESTATE_MARK_DIRTY(address + 3);
 	WRITE_LONG(g_68kmem, address, value);
 }
 
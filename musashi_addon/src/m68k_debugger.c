@@ -1,5 +1,6 @@
 #include "m68k_elf_loader.h"
 #include "m68k_debugger.h"
+#include "m68k_scheduler.h"
 #include <pd_backend.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +8,10 @@
 #include "m68k.h"
 #include "m68kcpu.h"
 
+// Number of cycles to run for each update when running (roughly 100 instructions)
+
+#define RUNNING_CYCLES_PER_UPDATE 1024
+
 void m68k_disasm_function(int length);
 extern void m68k_execute_single_instruction();
 
@@ -21,6 +26,7 @@ int m68k_debugger_init()
 
 	m68k_init();
 	m68k_set_cpu_type(M68K_CPU_TYPE_68000);
+	m68k_scheduler_reset();
 
 	m68ki_jump(0);
 
@@ -82,10 +88,9 @@ bool m68k_debugger_update()
 	{
 		case PDDebugState_Running :
 		{
-			// execute 100 instructions if we are running
+			// run until the next device event (or end of this update) without checking devices per instruction
 
-			for (int i = 0; i < 100; ++i)
-				m68k_execute_single_instruction();
+			m68k_scheduler_run(RUNNING_CYCLES_PER_UPDATE);
 
 			return true;
 		}
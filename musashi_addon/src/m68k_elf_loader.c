@@ -6,6 +6,7 @@
 #include "m68k_allocator.h"
 #include "m68k_log.h"
 #include "m68k_elfstructs.h"
+#include "m68k_savestate.h"
 #include <stdint.h>
 
 #define SHT_RELA 4
@@ -90,8 +91,20 @@ typedef struct M68KCodeData
 	uint32_t totalSize;
 } M68KCodeData;
 
+// All labels (exported and local) of the loaded files sorted on address. Rebuilt when a file has been loaded
+
+typedef struct M68KLabelIndex
+{
+	M68KLabelAddress* labels;
+	uint32_t count;
+	uint32_t capacity;
+	bool dirty;
+
+} M68KLabelIndex;
+
 static M68KCodeData g_prog;
 static M68KProgramInfo g_progInfo;
+static M68KLabelIndex g_labelIndex;
 unsigned char* g_68kmem;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -469,6 +482,7 @@ static void allocateSections(
 
 				memcpy(target, fileBuffer + elfSection->sh_offset, elfSection->sh_size);
 				memset(target + elfSection->sh_size, 0, size - elfSection->sh_size);
+				m68k_savestate_mark_range(getOffset(target, codeData->memStart), size);
 
 				code_offset = getOffset(section->target, codeData->memStart);
 
@@ -499,6 +513,7 @@ static void allocateSections(
 						(uintptr_t)section->relSection, section->relSectionCount, section->name);
 
 				memset(target, 0, size);
+				m68k_savestate_mark_range(section->offset, size);
 				codeData->bss += size;
 			}
 
@@ -811,6 +826,7 @@ int m68k_elf_load(const char* filename)
 	}
 
 	g_progInfo.fileCount++;
+	g_labelIndex.dirty = true;
 
 	return 0;
 }
@@ -829,6 +845,8 @@ int m68k_code_init(void* memory, int codeSize, int dataSize, int bssSize)
 	g_prog.totalSize = codeSize + dataSize + bssSize;
   	g_68kmem = memory;
 
+	m68k_savestate_init(g_prog.totalSize);
+
 	M68KLinearAllocator_create(malloc(5 * 1024 * 1024), 5 * 1024 * 1024);
 
 	return 0;
@@ -883,69 +901,186 @@ int m68k_find_symbol(const char* function)
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// TODO: Use local names as well (not just exported)
 
-const char* getFunctionName(const M68KFile* file, uint32_t pc, uintptr_t memStart)
+typedef struct M68KSortLabel
 {
-	uint32_t i, hash_count = file->exportNames.count;
+	M68KLabelAddress label;
+	uint32_t order;		// exported labels comes first so they are preferred when several labels share an address
 
-	for (i = 0; i < hash_count; ++i)
-	{
-		uint32_t target_pc = (uint32_t)((uintptr_t)file->exportNames.targets[i] - memStart);
+} M68KSortLabel;
 
-		if (target_pc == pc)
-			return file->exportNames.names[i];
-	}
+static int compareLabels(const void* a, const void* b)
+{
+	const M68KSortLabel* la = (const M68KSortLabel*)a;
+	const M68KSortLabel* lb = (const M68KSortLabel*)b;
 
-	return "";
+	if (la->label.address != lb->label.address)
+		return la->label.address < lb->label.address ? -1 : 1;
+
+	return la->order < lb->order ? -1 : (la->order > lb->order ? 1 : 0);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void m68k_find_labels(M68KLabelAddress* labels, uint32_t* count, uint32_t pcStart, uint32_t pcEnd)
+static M68K_INLINE bool isLocalLabel(const M68KFile* file, const Elf32_Sym* symbol)
 {
-	uint32_t i;
-	uint32_t current_count = 0;
-	uint32_t max_count = *count;
+	const uint32_t type = symbol->st_info & 0xf;
+
+	// skip section and file symbols
+
+	if ((symbol->st_info >> 4) != 0 || type > 2 || !symbol->st_name || !file->symNames[symbol->st_name])
+		return false;
+
+	return symbol->st_shndx > 0 && symbol->st_shndx < file->sectionCount && file->sections[symbol->st_shndx].target;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void buildLabelIndex()
+{
+	uint32_t i, k, count = 0, order = 0;
 	uint32_t file_count = g_progInfo.fileCount;
 	uintptr_t mem_start = (uintptr_t)g_prog.memStart;
+	M68KSortLabel* sortLabels;
 
-	if (!labels)
+	for (i = 0; i < file_count; ++i)
 	{
-		m68k_log(M68K_LOG_ERROR, "Unable to fill in labels if labels are null\n");
-		return;
+		const M68KFile* file = g_progInfo.files[i];
+
+		count += file->exportNames.count;
+
+		for (k = 0; k < file->symbolCount; ++k)
+		{
+			if (isLocalLabel(file, &file->symbolTable[k]))
+				count++;
+		}
 	}
 
-	// Scan all files for labels within the pcRange
+	if (count > g_labelIndex.capacity)
+	{
+		free(g_labelIndex.labels);
+		g_labelIndex.labels = malloc(sizeof(M68KLabelAddress) * count);
+		g_labelIndex.capacity = count;
+	}
+
+	sortLabels = malloc(sizeof(M68KSortLabel) * (count ? count : 1));
 
 	for (i = 0; i < file_count; ++i)
 	{
-		uint32_t k, hash_count;
+		const M68KFile* file = g_progInfo.files[i];
 
-		M68KFile* file = g_progInfo.files[i];
+		for (k = 0; k < file->exportNames.count; ++k, ++order)
+		{
+			sortLabels[order].label.name = file->exportNames.names[k];
+			sortLabels[order].label.address = (uint32_t)((uintptr_t)file->exportNames.targets[k] - mem_start);
+			sortLabels[order].order = order;
+		}
+	}
 
-		hash_count = file->exportNames.count;
+	for (i = 0; i < file_count; ++i)
+	{
+		const M68KFile* file = g_progInfo.files[i];
 
-		for (k = 0; k < hash_count; ++k)
+		for (k = 0; k < file->symbolCount; ++k)
 		{
-			uint32_t pc = (uint32_t)((uintptr_t)file->exportNames.targets[k] - mem_start);
+			const Elf32_Sym* symbol = &file->symbolTable[k];
 
-			if (!(pc >= pcStart && pc <= pcEnd))
+			if (!isLocalLabel(file, symbol))
 				continue;
 
-			if (current_count >= max_count)
-			{
-				m68k_log(M68K_LOG_INFO, "Unable to add labels as buffer is too small\n");
-				continue;
-			}
+			sortLabels[order].label.name = &file->symNames[symbol->st_name];
+			sortLabels[order].label.address = (uint32_t)((uintptr_t)(file->sections[symbol->st_shndx].target + symbol->st_value) - mem_start);
+			sortLabels[order].order = order;
+			order++;
+		}
+	}
+
+	qsort(sortLabels, count, sizeof(M68KSortLabel), compareLabels);
+
+	for (i = 0; i < count; ++i)
+		g_labelIndex.labels[i] = sortLabels[i].label;
+
+	free(sortLabels);
 
-			labels[current_count].address = pc;
-			labels[current_count].name = file->exportNames.names[k];
-			current_count++;
+	g_labelIndex.count = count;
+	g_labelIndex.dirty = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns index of the first label with address >= pc
+
+static uint32_t lowerBoundLabel(uint32_t pc)
+{
+	uint32_t first = 0, count = g_labelIndex.count;
+	const M68KLabelAddress* labels = g_labelIndex.labels;
+
+	while (count > 0)
+	{
+		uint32_t step = count / 2;
+
+		if (labels[first + step].address < pc)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
 		}
 	}
 
-	*count = current_count;
+	return first;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* getFunctionName(uint32_t pc)
+{
+	uint32_t index;
+
+	if (g_labelIndex.dirty)
+		buildLabelIndex();
+
+	index = lowerBoundLabel(pc);
+
+	if (index < g_labelIndex.count && g_labelIndex.labels[index].address == pc)
+		return g_labelIndex.labels[index].name;
+
+	return "";
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_find_labels(M68KLabelAddress* labels, uint32_t* count, uint32_t pcStart, uint32_t pcEnd)
+{
+	uint32_t start, end, label_count;
+	uint32_t max_count = *count;
+
+	if (!labels)
+	{
+		m68k_log(M68K_LOG_ERROR, "Unable to fill in labels if labels are null\n");
+		return;
+	}
+
+	if (g_labelIndex.dirty)
+		buildLabelIndex();
+
+	// Labels within the pcRange (inclusive) are stored after each other in the index
+
+	start = lowerBoundLabel(pcStart);
+	end = pcEnd == 0xffffffff ? g_labelIndex.count : lowerBoundLabel(pcEnd + 1);
+	label_count = end > start ? end - start : 0;
+
+	if (label_count > max_count)
+	{
+		m68k_log(M68K_LOG_INFO, "Unable to add labels as buffer is too small\n");
+		label_count = max_count;
+	}
+
+	if (label_count)
+		memcpy(labels, g_labelIndex.labels + start, label_count * sizeof(M68KLabelAddress));
+
+	*count = label_count;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -994,7 +1129,6 @@ bool m68k_resolve_file_line(const char** filename, uint32_t* line, const char**
 {
 	uint32_t i;
 	uint32_t file_count = g_progInfo.fileCount;
-	uintptr_t mem_start = (uintptr_t)g_prog.memStart;
 
 	// Scan all files for labels within the pcRange
 
@@ -1015,7 +1149,7 @@ bool m68k_resolve_file_line(const char** filename, uint32_t* line, const char**
 
 			*filename = file->sourceFile;
 			*line = getLine(section, pc);
-			*function = getFunctionName(file, pc, mem_start);
+			*function = getFunctionName(pc);
 			return true;
 		}
 	}
@@ -1073,6 +1207,42 @@ uint8_t* m68k_get_memory(uint32_t address)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+uint32_t m68k_get_memory_size()
+{
+	return g_prog.totalSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_get_loader_state(M68KLoaderState* state)
+{
+	state->codeOffset = getOffset(g_prog.code, g_prog.memStart);
+	state->dataOffset = getOffset(g_prog.data, g_prog.memStart);
+	state->bssOffset = getOffset(g_prog.bss, g_prog.memStart);
+	state->fileCount = g_progInfo.fileCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_set_loader_state(const M68KLoaderState* state)
+{
+	g_prog.code = g_prog.memStart + state->codeOffset;
+	g_prog.data = g_prog.memStart + state->dataOffset;
+	g_prog.bss = g_prog.memStart + state->bssOffset;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const char* m68k_get_loaded_file(uint32_t index)
+{
+	if (index >= g_progInfo.fileCount)
+		return 0;
+
+	return g_progInfo.files[index]->path;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 uint32_t m68k_get_ptr_offset(const void* ptr, const char* ident)
 {
 	uint8_t* p = (uint8_t*)ptr;
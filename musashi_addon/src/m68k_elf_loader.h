@@ -13,6 +13,18 @@ typedef struct M68KLabelAddress
 
 } M68KLabelAddress;
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation state of the loader (offsets from the start of 68k memory). Used when saving/restoring machine state
+
+typedef struct M68KLoaderState
+{
+	uint32_t codeOffset;
+	uint32_t dataOffset;
+	uint32_t bssOffset;
+	uint32_t fileCount;
+
+} M68KLoaderState;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // load elf file (68K format only supported)
 // Notice that if a file already has been loaded it will replace the existing one
@@ -37,6 +49,19 @@ void m68k_find_labels(M68KLabelAddress* labels, uint32_t* count, uint32_t pcStar
 
 uint8_t* m68k_get_memory(uint32_t address);
 
+// Size of the 68k memory (code + data + bss)
+
+uint32_t m68k_get_memory_size();
+
+// Get/set the loader allocation state. Setting it doesn't reload any files so the same files needs to be loaded
+
+void m68k_get_loader_state(M68KLoaderState* state);
+void m68k_set_loader_state(const M68KLoaderState* state);
+
+// Path of a loaded file (0 if index is out of range)
+
+const char* m68k_get_loaded_file(uint32_t index);
+
 // Resolve file/line/function name from given pc
 
 bool m68k_resolve_file_line(const char** filename, uint32_t* line, const char** function, uint32_t pc);
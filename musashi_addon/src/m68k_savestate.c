@@ -0,0 +1,600 @@
+#include "m68k_savestate.h"
+#include "m68k_elf_loader.h"
+#include "m68k_log.h"
+#include "m68k_types.h"
+#include "m68k.h"
+#include "m68kcpu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5
+#define LZ_MF_LIMIT 12
+
+typedef struct M68KPageRecord
+{
+	uint32_t index;
+	uint32_t packedSize;		// 0 = page is all zeros, M68K_SAVESTATE_PAGE_SIZE = stored uncompressed
+
+} M68KPageRecord;
+
+uint8_t* g_68kdirty;
+uint32_t g_68kdirtyCount;
+
+static uint32_t s_chainId;
+static uint32_t s_sequence;
+static bool s_hasSnapshot;
+
+extern unsigned char* g_68kmem;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_savestate_init(uint32_t memorySize)
+{
+	free(g_68kdirty);
+
+	// everything is dirty until the first full snapshot has been written
+
+	g_68kdirtyCount = (memorySize + M68K_SAVESTATE_PAGE_SIZE - 1) >> M68K_SAVESTATE_PAGE_SHIFT;
+	g_68kdirty = malloc(g_68kdirtyCount);
+	memset(g_68kdirty, 1, g_68kdirtyCount);
+
+	s_hasSnapshot = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_savestate_mark_range(uint32_t address, uint32_t size)
+{
+	uint32_t i, start, end;
+
+	if (size == 0)
+		return;
+
+	start = address >> M68K_SAVESTATE_PAGE_SHIFT;
+	end = (address + size - 1) >> M68K_SAVESTATE_PAGE_SHIFT;
+
+	for (i = start; i <= end && i < g_68kdirtyCount; ++i)
+		g_68kdirty[i] = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static M68K_INLINE uint32_t read32(const uint8_t* ptr)
+{
+	uint32_t v;
+	memcpy(&v, ptr, sizeof(v));
+	return v;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static M68K_INLINE uint32_t lzHash(uint32_t v)
+{
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t* lzWriteLength(uint8_t* op, uint32_t length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+
+	*op++ = (uint8_t)length;
+
+	return op;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compresses data (max 64k) using the LZ4 block format. Returns 0 if the data doesn't fit in dstSize bytes
+
+static uint32_t lzCompress(const uint8_t* src, uint32_t srcSize, uint8_t* dst, uint32_t dstSize)
+{
+	uint16_t table[1 << LZ_HASH_BITS];
+	const uint8_t* ip = src;
+	const uint8_t* anchor = src;
+	const uint8_t* end = src + srcSize;
+	const uint8_t* matchLimit = end - LZ_LAST_LITERALS;
+	const uint8_t* mfLimit = end - LZ_MF_LIMIT;
+	uint8_t* op = dst;
+	uint8_t* opEnd = dst + dstSize;
+	uint32_t literals;
+
+	memset(table, 0, sizeof(table));
+
+	if (srcSize > LZ_MF_LIMIT)
+	{
+		while (ip < mfLimit)
+		{
+			uint32_t sequence = read32(ip);
+			uint32_t hash = lzHash(sequence);
+			const uint8_t* ref = src + table[hash];
+			const uint8_t* matchEnd;
+			uint32_t matchLength, offset;
+			uint8_t* token;
+
+			table[hash] = (uint16_t)(ip - src);
+
+			if (ref >= ip || read32(ref) != sequence)
+			{
+				ip++;
+				continue;
+			}
+
+			offset = (uint32_t)(ip - ref);
+			matchEnd = ip + LZ_MIN_MATCH;
+			ref += LZ_MIN_MATCH;
+
+			while (matchEnd < matchLimit && *matchEnd == *ref)
+			{
+				matchEnd++;
+				ref++;
+			}
+
+			literals = (uint32_t)(ip - anchor);
+			matchLength = (uint32_t)(matchEnd - ip) - LZ_MIN_MATCH;
+
+			// worst case size of this sequence
+
+			if (op + 1 + (literals / 255 + 1) + literals + 2 + (matchLength / 255 + 1) > opEnd)
+				return 0;
+
+			token = op++;
+			*token = (uint8_t)((literals >= 15 ? 15 : literals) << 4);
+
+			if (literals >= 15)
+				op = lzWriteLength(op, literals - 15);
+
+			memcpy(op, anchor, literals);
+			op += literals;
+
+			*op++ = (uint8_t)(offset & 0xff);
+			*op++ = (uint8_t)(offset >> 8);
+
+			*token |= (uint8_t)(matchLength >= 15 ? 15 : matchLength);
+
+			if (matchLength >= 15)
+				op = lzWriteLength(op, matchLength - 15);
+
+			ip = anchor = matchEnd;
+		}
+	}
+
+	// last literals
+
+	literals = (uint32_t)(end - anchor);
+
+	if (op + 1 + (literals / 255 + 1) + literals > opEnd)
+		return 0;
+
+	*op++ = (uint8_t)((literals >= 15 ? 15 : literals) << 4);
+
+	if (literals >= 15)
+		op = lzWriteLength(op, literals - 15);
+
+	memcpy(op, anchor, literals);
+	op += literals;
+
+	return (uint32_t)(op - dst);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool lzDecompress(const uint8_t* src, uint32_t srcSize, uint8_t* dst, uint32_t dstSize)
+{
+	const uint8_t* ip = src;
+	const uint8_t* ipEnd = src + srcSize;
+	uint8_t* op = dst;
+	uint8_t* opEnd = dst + dstSize;
+
+	while (ip < ipEnd)
+	{
+		uint32_t token = *ip++;
+		uint32_t length = token >> 4;
+		uint32_t offset;
+		const uint8_t* match;
+
+		if (length == 15)
+		{
+			uint32_t v;
+
+			do
+			{
+				if (ip >= ipEnd)
+					return false;
+
+				v = *ip++;
+				length += v;
+			}
+			while (v == 255);
+		}
+
+		if (length > (uint32_t)(ipEnd - ip) || length > (uint32_t)(opEnd - op))
+			return false;
+
+		memcpy(op, ip, length);
+		op += length;
+		ip += length;
+
+		// last sequence only has literals
+
+		if (ip >= ipEnd)
+			break;
+
+		if (ipEnd - ip < 2)
+			return false;
+
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		if (offset == 0 || offset > (uint32_t)(op - dst))
+			return false;
+
+		length = token & 15;
+
+		if (length == 15)
+		{
+			uint32_t v;
+
+			do
+			{
+				if (ip >= ipEnd)
+					return false;
+
+				v = *ip++;
+				length += v;
+			}
+			while (v == 255);
+		}
+
+		length += LZ_MIN_MATCH;
+
+		if (length > (uint32_t)(opEnd - op))
+			return false;
+
+		match = op - offset;
+
+		if (offset >= length)
+		{
+			memcpy(op, match, length);
+			op += length;
+		}
+		else
+		{
+			// overlapping match (repeating pattern)
+
+			while (length--)
+				*op++ = *match++;
+		}
+	}
+
+	return op == opEnd;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool isZeroPage(const uint8_t* page, uint32_t size)
+{
+	uint32_t i;
+
+	for (i = 0; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t))
+	{
+		if (read32(page + i))
+			return false;
+	}
+
+	for (; i < size; ++i)
+	{
+		if (page[i])
+			return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool writeData(FILE* f, const void* data, size_t size)
+{
+	return fwrite(data, 1, size, f) == size;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool readData(FILE* f, void* data, size_t size)
+{
+	return fread(data, 1, size, f) == size;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool writeMetadata(FILE* f, const M68KSaveStateHeader* header)
+{
+	M68KLoaderState loaderState;
+	int32_t cycles = m68ki_remaining_cycles;
+	uint32_t i;
+
+	m68k_get_loader_state(&loaderState);
+
+	if (!writeData(f, &m68ki_cpu, header->contextSize) ||
+		!writeData(f, &cycles, sizeof(cycles)) ||
+		!writeData(f, &loaderState, sizeof(loaderState)))
+		return false;
+
+	for (i = 0; i < header->fileCount; ++i)
+	{
+		const char* path = m68k_get_loaded_file(i);
+		uint16_t length = (uint16_t)strlen(path);
+
+		if (!writeData(f, &length, sizeof(length)) || !writeData(f, path, length))
+			return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool readMetadata(FILE* f, const M68KSaveStateHeader* header)
+{
+	M68KLoaderState loaderState;
+	m68ki_cpu_core context;
+	int32_t cycles;
+	uint32_t i;
+
+	if (!readData(f, &context, sizeof(context)) ||
+		!readData(f, &cycles, sizeof(cycles)) ||
+		!readData(f, &loaderState, sizeof(loaderState)))
+		return false;
+
+	for (i = 0; i < header->fileCount; ++i)
+	{
+		char path[4096];
+		const char* loadedPath = m68k_get_loaded_file(i);
+		uint16_t length;
+
+		if (!readData(f, &length, sizeof(length)) || length >= sizeof(path) || !readData(f, path, length))
+			return false;
+
+		path[length] = 0;
+
+		// Symbols/debug info lives with the loaded files and isn't part of the save state
+
+		if (!loadedPath || strcmp(loadedPath, path))
+			m68k_log(M68K_LOG_INFO, "Save state was made with %s loaded (got %s) symbols may not match\n", path, loadedPath ? loadedPath : "nothing");
+	}
+
+	// The cycle tables and callbacks are host pointers so keep the current ones
+
+	context.cyc_instruction = m68ki_cpu.cyc_instruction;
+	context.cyc_exception = m68ki_cpu.cyc_exception;
+	context.int_ack_callback = m68ki_cpu.int_ack_callback;
+	context.bkpt_ack_callback = m68ki_cpu.bkpt_ack_callback;
+	context.reset_instr_callback = m68ki_cpu.reset_instr_callback;
+	context.pc_changed_callback = m68ki_cpu.pc_changed_callback;
+	context.set_fc_callback = m68ki_cpu.set_fc_callback;
+	context.instr_hook_callback = m68ki_cpu.instr_hook_callback;
+
+	m68k_set_context(&context);
+	m68ki_remaining_cycles = cycles;
+	m68k_set_loader_state(&loaderState);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int m68k_savestate_save(const char* filename, bool incremental)
+{
+	M68KSaveStateHeader header;
+	M68KLoaderState loaderState;
+	uint8_t packed[M68K_SAVESTATE_PAGE_SIZE];
+	uint32_t i, memorySize = m68k_get_memory_size();
+	FILE* f;
+
+	if (incremental && !s_hasSnapshot)
+	{
+		m68k_log(M68K_LOG_ERROR, "Unable to save incremental snapshot %s without a previous snapshot\n", filename);
+		return -1;
+	}
+
+	if (!(f = fopen(filename, "wb")))
+	{
+		m68k_log(M68K_LOG_ERROR, "Unable to open %s for writing\n", filename);
+		return -1;
+	}
+
+	m68k_get_loader_state(&loaderState);
+
+	if (!incremental)
+	{
+		s_chainId = (uint32_t)time(0) ^ (uint32_t)clock();
+		s_sequence = 0;
+	}
+	else
+	{
+		s_sequence++;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.magic = M68K_SAVESTATE_MAGIC;
+	header.version = M68K_SAVESTATE_VERSION;
+	header.flags = incremental ? M68K_SAVESTATE_INCREMENTAL : 0;
+	header.chainId = s_chainId;
+	header.sequence = s_sequence;
+	header.memorySize = memorySize;
+	header.pageSize = M68K_SAVESTATE_PAGE_SIZE;
+	header.contextSize = m68k_context_size();
+	header.fileCount = loaderState.fileCount;
+
+	for (i = 0; i < g_68kdirtyCount; ++i)
+	{
+		if (!incremental || g_68kdirty[i])
+			header.pageCount++;
+	}
+
+	if (!writeData(f, &header, sizeof(header)) || !writeMetadata(f, &header))
+		goto error;
+
+	for (i = 0; i < g_68kdirtyCount; ++i)
+	{
+		M68KPageRecord record;
+		const uint8_t* page = g_68kmem + (i << M68K_SAVESTATE_PAGE_SHIFT);
+		uint32_t pageSize = memorySize - (i << M68K_SAVESTATE_PAGE_SHIFT);
+		const void* data = page;
+
+		if (incremental && !g_68kdirty[i])
+			continue;
+
+		if (pageSize > M68K_SAVESTATE_PAGE_SIZE)
+			pageSize = M68K_SAVESTATE_PAGE_SIZE;
+
+		record.index = i;
+
+		if (isZeroPage(page, pageSize))
+		{
+			record.packedSize = 0;
+		}
+		else if ((record.packedSize = lzCompress(page, pageSize, packed, pageSize - 1)) != 0)
+		{
+			data = packed;
+		}
+		else
+		{
+			record.packedSize = pageSize;
+		}
+
+		if (!writeData(f, &record, sizeof(record)) || !writeData(f, data, record.packedSize))
+			goto error;
+	}
+
+	fclose(f);
+
+	memset(g_68kdirty, 0, g_68kdirtyCount);
+	s_hasSnapshot = true;
+
+	return 0;
+
+error:
+
+	m68k_log(M68K_LOG_ERROR, "Unable to write save state to %s\n", filename);
+	fclose(f);
+
+	return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int m68k_savestate_load(const char* filename)
+{
+	M68KSaveStateHeader header;
+	uint8_t packed[M68K_SAVESTATE_PAGE_SIZE];
+	uint32_t i, memorySize = m68k_get_memory_size();
+	FILE* f;
+
+	if (!(f = fopen(filename, "rb")))
+	{
+		m68k_log(M68K_LOG_ERROR, "Unable to open %s for reading\n", filename);
+		return -1;
+	}
+
+	if (!readData(f, &header, sizeof(header)) || header.magic != M68K_SAVESTATE_MAGIC)
+	{
+		m68k_log(M68K_LOG_ERROR, "%s is not a save state\n", filename);
+		goto error;
+	}
+
+	if (header.version != M68K_SAVESTATE_VERSION || header.contextSize != m68k_context_size() ||
+		header.pageSize != M68K_SAVESTATE_PAGE_SIZE || header.memorySize != memorySize)
+	{
+		m68k_log(M68K_LOG_ERROR, "%s has version %d (context size %d, memory size %d) which doesn't match the current build/setup\n",
+			filename, header.version, header.contextSize, header.memorySize);
+		goto error;
+	}
+
+	if (header.flags & M68K_SAVESTATE_INCREMENTAL)
+	{
+		if (!s_hasSnapshot || header.chainId != s_chainId || header.sequence != s_sequence + 1)
+		{
+			m68k_log(M68K_LOG_ERROR, "%s (snapshot %d) isn't based on the currently loaded state\n", filename, header.sequence);
+			goto error;
+		}
+
+		// Pages written since the snapshot would keep their new contents unless the increment happens to contain them
+
+		for (i = 0; i < g_68kdirtyCount; ++i)
+		{
+			if (g_68kdirty[i])
+			{
+				m68k_log(M68K_LOG_ERROR, "%s (snapshot %d) can't be applied as memory has changed since the previous snapshot, reload it first\n",
+					filename, header.sequence);
+				goto error;
+			}
+		}
+	}
+
+	if (!readMetadata(f, &header))
+		goto error;
+
+	for (i = 0; i < header.pageCount; ++i)
+	{
+		M68KPageRecord record;
+		uint8_t* page;
+		uint32_t pageSize;
+
+		if (!readData(f, &record, sizeof(record)) || record.index >= g_68kdirtyCount)
+			goto error;
+
+		page = g_68kmem + (record.index << M68K_SAVESTATE_PAGE_SHIFT);
+		pageSize = memorySize - (record.index << M68K_SAVESTATE_PAGE_SHIFT);
+
+		if (pageSize > M68K_SAVESTATE_PAGE_SIZE)
+			pageSize = M68K_SAVESTATE_PAGE_SIZE;
+
+		if (record.packedSize == 0)
+		{
+			memset(page, 0, pageSize);
+		}
+		else if (record.packedSize == pageSize)
+		{
+			if (!readData(f, page, pageSize))
+				goto error;
+		}
+		else
+		{
+			if (record.packedSize > pageSize || !readData(f, packed, record.packedSize) ||
+				!lzDecompress(packed, record.packedSize, page, pageSize))
+				goto error;
+		}
+	}
+
+	fclose(f);
+
+	memset(g_68kdirty, 0, g_68kdirtyCount);
+	s_chainId = header.chainId;
+	s_sequence = header.sequence;
+	s_hasSnapshot = true;
+
+	return 0;
+
+error:
+
+	m68k_log(M68K_LOG_ERROR, "Unable to load save state from %s\n", filename);
+	fclose(f);
+
+	// memory may be partially updated so we can't build on top of it anymore
+
+	s_hasSnapshot = false;
+	memset(g_68kdirty, 1, g_68kdirtyCount);
+
+	return -1;
+}
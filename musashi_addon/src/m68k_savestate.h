@@ -0,0 +1,72 @@
+#ifndef _M68K_SAVESTATE_H_
+#define _M68K_SAVESTATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Save states of the full machine (cpu context, 68k memory and loader state)
+//
+// A full snapshot contains all memory pages. An incremental snapshot only contains the pages that has been written
+// since the previous snapshot (saved or loaded) and must be loaded on top of the snapshot it was based on, so to
+// restore snapshot N of a chain: load the full snapshot and then each incremental one up to N in order. An incremental
+// snapshot is rejected if memory has been written since the previous one was saved or loaded.
+//
+// Pages are compressed with an LZ4 (block format) style compressor and all-zero pages are stored as a header only.
+// The format is in host endian and the cpu context is stored raw so save states are not meant to be moved between
+// different builds/platforms (the version and context size in the header is validated on load)
+
+#define M68K_SAVESTATE_MAGIC 0x5336384d	// 'M68S'
+#define M68K_SAVESTATE_VERSION 1
+#define M68K_SAVESTATE_PAGE_SHIFT 12
+#define M68K_SAVESTATE_PAGE_SIZE (1 << M68K_SAVESTATE_PAGE_SHIFT)
+
+enum
+{
+	M68K_SAVESTATE_INCREMENTAL = 1 << 0,
+};
+
+typedef struct M68KSaveStateHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t flags;
+	uint32_t chainId;			// Id generated when the full snapshot was written (shared by all incremental ones)
+	uint32_t sequence;			// 0 for the full snapshot and then increased by one for each incremental one
+	uint32_t memorySize;
+	uint32_t pageSize;
+	uint32_t pageCount;			// Number of page records that follows the header and metadata
+	uint32_t contextSize;
+	uint32_t fileCount;			// Number of loaded file paths stored in the metadata
+
+} M68KSaveStateHeader;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_savestate_init(uint32_t memorySize);
+
+// Save full or incremental snapshot. Returns 0 on success otherwise -1
+
+int m68k_savestate_save(const char* filename, bool incremental);
+
+// Load a full snapshot or apply an incremental one. Returns 0 on success otherwise -1
+
+int m68k_savestate_load(const char* filename);
+
+// Mark memory as modified (done by all memory writes from the cpu and when the loader copies data)
+
+void m68k_savestate_mark_range(uint32_t address, uint32_t size);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern uint8_t* g_68kdirty;
+extern uint32_t g_68kdirtyCount;
+
+#define M68K_SAVESTATE_MARK_DIRTY(address) \
+	do { \
+		uint32_t page_ = (uint32_t)(address) >> M68K_SAVESTATE_PAGE_SHIFT; \
+		if (page_ < g_68kdirtyCount) \
+			g_68kdirty[page_] = 1; \
+	} while (0)
+
+#endif
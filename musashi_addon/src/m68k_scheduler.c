@@ -0,0 +1,230 @@
+#include "m68k_scheduler.h"
+#include "m68k_log.h"
+#include "m68k.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct M68KEvent
+{
+	uint64_t cycle;
+	M68KEventFunc func;
+	void* userData;
+	int id;
+
+} M68KEvent;
+
+typedef struct M68KScheduler
+{
+	M68KEvent events[M68K_SCHEDULER_MAX_EVENTS];	// min-heap on cycle
+	uint32_t count;
+	uint64_t cycles;		// cycles executed up to the start of the current timeslice
+	uint64_t sliceEnd;		// cycle where the current timeslice ends (only valid when executing)
+	bool executing;
+	int nextId;
+
+} M68KScheduler;
+
+static M68KScheduler s_scheduler;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool isEarlier(const M68KEvent* a, const M68KEvent* b)
+{
+	// Events at the same cycle fires in the order they were added
+
+	if (a->cycle != b->cycle)
+		return a->cycle < b->cycle;
+
+	return a->id < b->id;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void siftUp(M68KEvent* events, uint32_t index)
+{
+	M68KEvent event = events[index];
+
+	while (index > 0)
+	{
+		uint32_t parent = (index - 1) / 2;
+
+		if (!isEarlier(&event, &events[parent]))
+			break;
+
+		events[index] = events[parent];
+		index = parent;
+	}
+
+	events[index] = event;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void siftDown(M68KEvent* events, uint32_t count, uint32_t index)
+{
+	M68KEvent event = events[index];
+
+	for (;;)
+	{
+		uint32_t child = index * 2 + 1;
+
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && isEarlier(&events[child + 1], &events[child]))
+			child++;
+
+		if (!isEarlier(&events[child], &event))
+			break;
+
+		events[index] = events[child];
+		index = child;
+	}
+
+	events[index] = event;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void removeAt(M68KScheduler* scheduler, uint32_t index)
+{
+	M68KEvent* events = scheduler->events;
+
+	scheduler->count--;
+
+	if (index == scheduler->count)
+		return;
+
+	events[index] = events[scheduler->count];
+
+	if (index > 0 && isEarlier(&events[index], &events[(index - 1) / 2]))
+		siftUp(events, index);
+	else
+		siftDown(events, scheduler->count, index);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_scheduler_reset()
+{
+	s_scheduler.count = 0;
+	s_scheduler.cycles = 0;
+	s_scheduler.executing = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t m68k_scheduler_cycles()
+{
+	M68KScheduler* scheduler = &s_scheduler;
+
+	if (scheduler->executing)
+		return scheduler->cycles + m68k_cycles_run();
+
+	return scheduler->cycles;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int m68k_scheduler_add(uint64_t cycle, M68KEventFunc func, void* userData)
+{
+	M68KScheduler* scheduler = &s_scheduler;
+	M68KEvent* event;
+	int id;
+
+	if (scheduler->count >= M68K_SCHEDULER_MAX_EVENTS)
+	{
+		m68k_log(M68K_LOG_ERROR, "Unable to add event as the queue is full (%d events)\n", M68K_SCHEDULER_MAX_EVENTS);
+		return -1;
+	}
+
+	event = &scheduler->events[scheduler->count];
+	event->cycle = cycle;
+	event->func = func;
+	event->userData = userData;
+	event->id = id = scheduler->nextId++;
+
+	siftUp(scheduler->events, scheduler->count++);
+
+	// If a device adds an event (say from a memory mapped register write) that should fire before the current
+	// timeslice ends we cut the slice short so it fires on time
+
+	if (scheduler->executing && cycle < scheduler->sliceEnd)
+	{
+		uint64_t now = scheduler->cycles + m68k_cycles_run();
+		int remaining = m68k_cycles_remaining();
+		int cut = remaining;
+
+		if (cycle > now)
+			cut = remaining - (int)(cycle - now);
+
+		if (cut > 0)
+		{
+			m68k_modify_timeslice(-cut);
+			scheduler->sliceEnd -= cut;
+		}
+	}
+
+	return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool m68k_scheduler_remove(int id)
+{
+	M68KScheduler* scheduler = &s_scheduler;
+	uint32_t i, count = scheduler->count;
+
+	for (i = 0; i < count; ++i)
+	{
+		if (scheduler->events[i].id == id)
+		{
+			removeAt(scheduler, i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void fireEvents(M68KScheduler* scheduler)
+{
+	while (scheduler->count > 0 && scheduler->events[0].cycle <= scheduler->cycles)
+	{
+		M68KEvent event = scheduler->events[0];
+		removeAt(scheduler, 0);
+		event.func(event.userData, scheduler->cycles);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int m68k_scheduler_run(int cycles)
+{
+	M68KScheduler* scheduler = &s_scheduler;
+	uint64_t start = scheduler->cycles;
+	uint64_t end = start + cycles;
+
+	while (scheduler->cycles < end)
+	{
+		uint64_t next = end;
+
+		fireEvents(scheduler);
+
+		if (scheduler->count > 0 && scheduler->events[0].cycle < next)
+			next = scheduler->events[0].cycle;
+
+		scheduler->sliceEnd = next;
+		scheduler->executing = true;
+
+		scheduler->cycles += m68k_execute((int)(next - scheduler->cycles));
+
+		scheduler->executing = false;
+	}
+
+	fireEvents(scheduler);
+
+	return (int)(scheduler->cycles - start);
+}
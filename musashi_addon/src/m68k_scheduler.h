@@ -0,0 +1,39 @@
+#ifndef _M68K_SCHEDULER_H_
+#define _M68K_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cycle timed events for emulated devices (timers, vblank, serial, ...)
+//
+// Events are kept in a min-heap ordered on the cycle they should fire at. m68k_scheduler_run only lets the cpu
+// execute up to the next deadline so devices doesn't need to be checked for each instruction. The callback is called
+// at the first instruction boundary at or after its cycle and can raise interrupts with m68k_set_irq and/or add
+// itself again for periodic events.
+
+#define M68K_SCHEDULER_MAX_EVENTS 256
+
+typedef void (*M68KEventFunc)(void* userData, uint64_t cycle);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void m68k_scheduler_reset();
+
+// Add an event at an absolute cycle. Returns an id that can be used to remove it or -1 if the queue is full
+
+int m68k_scheduler_add(uint64_t cycle, M68KEventFunc func, void* userData);
+
+// Remove a pending event. Returns false if the event has already fired (or doesn't exist)
+
+bool m68k_scheduler_remove(int id);
+
+// Total number of cycles executed since reset (includes the cycles of the current timeslice)
+
+uint64_t m68k_scheduler_cycles();
+
+// Execute the cpu for (at least) the given number of cycles while firing events. Returns number of cycles executed
+
+int m68k_scheduler_run(int cycles);
+
+#endif